@@ -7,6 +7,7 @@
 
 #import "AppDelegate.h"
 #import "BFTask.h"
+#import "BPMAnalysisScheduler.h"
 #import "CoreDataStore.h"
 #import "FileExtensionHelper.h"
 #import "LFMAuthManager.h"
@@ -16,6 +17,8 @@
 #import "ScrobbleTracker.h"
 #import "Track.h"
 #import "TrackPlaybackController.h"
+#import "TrackService.h"
+#import "WaveformCacheManager.h"
 
 @interface AppDelegate ()
 
@@ -49,6 +52,9 @@
   if (session) {
     [self startTrackingScrobblesForSession:session];
   }
+
+  [[BPMAnalysisScheduler sharedScheduler] start];
+  [TrackService collectUnusedArtwork];
 }
 
 - (void)startTrackingScrobblesForSession:(LastFMSession *)session {
@@ -57,7 +63,8 @@
 }
 
 - (void)applicationWillTerminate:(NSNotification *)aNotification {
-  // Insert code here to tear down your application
+  [[BPMAnalysisScheduler sharedScheduler] stop];
+  [WaveformCacheManager synchronize];
 }
 
 - (BOOL)applicationSupportsSecureRestorableState:(NSApplication *)app {
@@ -127,6 +134,10 @@
                 }];
 }
 
+- (IBAction)rescanLibraryAction:(id)sender {
+  [TrackService rescanLibrary];
+}
+
 - (IBAction)showInFinderAction:(id)sender {
   Track *currentTrack = [[TrackPlaybackController sharedManager] currentTrack];
   if (currentTrack) {
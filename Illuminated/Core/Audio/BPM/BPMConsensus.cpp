@@ -0,0 +1,65 @@
+//
+//  BPMConsensus.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMConsensus.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bpm {
+
+namespace {
+
+/// Windows with no confidence at all still get a small say, otherwise a silent track has no consensus.
+double weight(const Result &window) {
+  return std::max(window.confidence, 0.05);
+}
+
+} // namespace
+
+Consensus consensus(std::span<const Result> windows, double tolerance) {
+  Consensus best;
+
+  size_t valid = 0;
+  for (const Result &window : windows) {
+    if (window.bpm > 0.0) valid++;
+  }
+  if (valid == 0) {
+    return best;
+  }
+
+  double bestWeight = 0.0;
+  for (const Result &center : windows) {
+    if (center.bpm <= 0.0) continue;
+
+    double clusterWeight = 0.0;
+    double weightedBPM = 0.0;
+    double confidence = 0.0;
+    size_t agreeing = 0;
+
+    for (const Result &window : windows) {
+      if (window.bpm <= 0.0 || std::fabs(window.bpm - center.bpm) > tolerance) continue;
+
+      clusterWeight += weight(window);
+      weightedBPM += weight(window) * window.bpm;
+      confidence += window.confidence;
+      agreeing++;
+    }
+
+    // Strictly greater, so ties keep the earliest window and the outcome never depends on timing
+    if (clusterWeight > bestWeight) {
+      bestWeight = clusterWeight;
+      best.bpm = weightedBPM / clusterWeight;
+      best.confidence = ((double)agreeing / valid) * (confidence / agreeing);
+      best.agreeing = agreeing;
+    }
+  }
+
+  return best;
+}
+
+} // namespace bpm
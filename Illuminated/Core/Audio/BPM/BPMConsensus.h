@@ -0,0 +1,29 @@
+//
+//  BPMConsensus.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include "BPMEngine.h"
+
+#include <cstddef>
+#include <span>
+
+namespace bpm {
+
+struct Consensus {
+  double bpm = 0.0;
+  /// 0...1, the share of windows that agree scaled by how confident those windows were.
+  double confidence = 0.0;
+  /// Windows whose estimate landed in the winning cluster.
+  size_t agreeing = 0;
+};
+
+/// Groups per-window estimates lying within `tolerance` BPM of each other and returns the cluster with the
+/// most confidence behind it. Windows that produced no estimate (bpm <= 0) are ignored.
+Consensus consensus(std::span<const Result> windows, double tolerance = 2.0);
+
+} // namespace bpm
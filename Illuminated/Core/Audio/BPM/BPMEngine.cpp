@@ -0,0 +1,251 @@
+//
+//  BPMEngine.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMEngine.h"
+#include "BPMKernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace bpm {
+
+namespace {
+
+/// SplitMix64, small and identical on every platform, unlike drand48() or the <random> distributions.
+class Random {
+public:
+  explicit Random(uint64_t seed) : _state(seed) {
+  }
+
+  uint64_t next() {
+    uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  /// Uniform in [0, 1)
+  double uniform() {
+    return (next() >> 11) * 0x1.0p-53;
+  }
+
+private:
+  uint64_t _state;
+};
+
+unsigned int workerCount(unsigned int requested, size_t jobs) {
+  unsigned int threads = requested > 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+  return (unsigned int)std::min<size_t>(threads, std::max<size_t>(jobs, 1));
+}
+
+/// Runs `body(i)` for every i in [0, count) on `threads` workers pulling indices from a shared counter.
+template <typename Body> void parallelFor(size_t count, unsigned int threads, const Body &body) {
+  std::atomic<size_t> next{0};
+  auto worker = [&] {
+    for (size_t i = next++; i < count; i = next++) {
+      body(i);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (unsigned int t = 1; t < threads; t++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+}
+
+/// `steps + 1` evenly spaced values from `from` to `to` inclusive.
+std::vector<double> linspace(double from, double to, unsigned int steps) {
+  std::vector<double> values(steps + 1);
+  double step = (to - from) / steps;
+  for (unsigned int i = 0; i <= steps; i++) {
+    values[i] = from + i * step;
+  }
+  return values;
+}
+
+} // namespace
+
+Analyzer::Analyzer(double sampleRate, Options options) : _sampleRate(sampleRate), _options(options) {
+}
+
+void EnvelopeFollower::reserve(size_t frames) {
+  _nrg.reserve(frames / kEnvelopeInterval);
+}
+
+void EnvelopeFollower::process(std::span<const float> samples) {
+  double v = _v;
+  size_t n = _n;
+
+  for (float z : samples) {
+    z = std::fabs(z);
+    if (z > v) {
+      v += (z - v) / 8.0;
+    } else {
+      v -= (v - z) / 512.0;
+    }
+
+    n++;
+    if (n == kEnvelopeInterval) {
+      _nrg.push_back(v);
+      n = 0;
+    }
+  }
+
+  _v = v;
+  _n = n;
+}
+
+std::vector<float> Analyzer::envelope(std::span<const float> samples) {
+  EnvelopeFollower follower;
+  follower.reserve(samples.size());
+  follower.process(samples);
+  return follower.takeEnvelope();
+}
+
+Result Analyzer::analyze(std::span<const float> samples) const {
+  std::vector<float> nrg = envelope(samples);
+  return analyzeEnvelope(nrg);
+}
+
+Result Analyzer::analyzeEnvelope(std::span<const float> nrg) const {
+  Result result;
+  if (nrg.empty() || _sampleRate <= 0 || _options.minBPM <= 0 || _options.maxBPM <= _options.minBPM) {
+    return result;
+  }
+
+  double slowest = intervalForBPM(_options.minBPM);
+  double fastest = intervalForBPM(_options.maxBPM);
+
+  Sweep sweep = _options.search == SearchMode::Hierarchical ? searchHierarchical(nrg, fastest, slowest)
+                                                            : searchExhaustive(nrg, fastest, slowest);
+  if (std::isnan(sweep.interval)) {
+    return result;
+  }
+
+  result.bpm = bpmForInterval(sweep.interval);
+  result.confidence = sweep.mean > 0.0 ? std::clamp((sweep.mean - sweep.height) / sweep.mean, 0.0, 1.0) : 0.0;
+  result.lookups = sweep.midpoints * kLookupsPerMidpoint;
+  return result;
+}
+
+Analyzer::Sweep Analyzer::searchExhaustive(std::span<const float> nrg, double fastest, double slowest) const {
+  Sweep sweep;
+  if (_options.steps == 0 || _options.samples == 0) {
+    return sweep;
+  }
+
+  std::vector<double> intervals = linspace(fastest, slowest, _options.steps);
+  std::vector<double> heights = measure(nrg, intervals, _options.samples, 0);
+
+  // Merge in interval order so the lowest trough wins ties the same way on every run
+  double sum = 0.0;
+  for (size_t i = 0; i < heights.size(); i++) {
+    sum += heights[i];
+    if (heights[i] < sweep.height) {
+      sweep.interval = intervals[i];
+      sweep.height = heights[i];
+    }
+  }
+
+  sweep.height /= _options.samples;
+  sweep.mean = sum / heights.size() / _options.samples;
+  sweep.midpoints = intervals.size() * _options.samples;
+  return sweep;
+}
+
+Analyzer::Sweep Analyzer::searchHierarchical(std::span<const float> nrg, double fastest, double slowest) const {
+  Sweep sweep;
+  if (_options.coarseSteps == 0 || _options.coarseSamples == 0 || _options.troughs == 0 || _options.refineSteps == 0 ||
+      _options.refineSamples == 0) {
+    return sweep;
+  }
+
+  std::vector<double> coarse = linspace(fastest, slowest, _options.coarseSteps);
+  std::vector<double> coarseHeights = measure(nrg, coarse, _options.coarseSamples, 0);
+
+  double sum = 0.0;
+  std::vector<size_t> minima;
+  for (size_t i = 0; i < coarseHeights.size(); i++) {
+    sum += coarseHeights[i];
+
+    bool belowLeft = i == 0 || coarseHeights[i] <= coarseHeights[i - 1];
+    bool belowRight = i + 1 == coarseHeights.size() || coarseHeights[i] <= coarseHeights[i + 1];
+    if (belowLeft && belowRight) {
+      minima.push_back(i);
+    }
+  }
+
+  std::stable_sort(minima.begin(), minima.end(), [&](size_t a, size_t b) {
+    return coarseHeights[a] < coarseHeights[b];
+  });
+  minima.resize(std::min<size_t>(minima.size(), _options.troughs));
+
+  sweep.mean = sum / coarseHeights.size() / _options.coarseSamples;
+  sweep.midpoints = coarse.size() * _options.coarseSamples;
+
+  double radius = (slowest - fastest) / _options.coarseSteps;
+  for (size_t k = 0; k < minima.size(); k++) {
+    double center = coarse[minima[k]];
+    std::vector<double> fine =
+        linspace(std::max(fastest, center - radius), std::min(slowest, center + radius), _options.refineSteps);
+    std::vector<double> heights = measure(nrg, fine, _options.refineSamples, k + 1);
+
+    for (size_t i = 0; i < heights.size(); i++) {
+      double height = heights[i] / _options.refineSamples;
+      if (height < sweep.height) {
+        sweep.interval = fine[i];
+        sweep.height = height;
+      }
+    }
+    sweep.midpoints += fine.size() * _options.refineSamples;
+  }
+
+  return sweep;
+}
+
+std::vector<double> Analyzer::measure(std::span<const float> nrg,
+                                      std::span<const double> intervals,
+                                      unsigned int samples,
+                                      uint64_t stream) const {
+  std::vector<double> heights(intervals.size());
+
+  // Each interval draws from its own stream derived from the seed, so the split across workers
+  // never changes which midpoints an interval sees.
+  auto body = [&](size_t i) {
+    std::vector<double> mids(samples);
+    Random random(_options.seed ^ (0x9E3779B97F4A7C15ull * (i + 1)) ^ (0xD1B54A32D192ED03ull * stream));
+    for (double &mid : mids) {
+      mid = random.uniform() * nrg.size();
+    }
+    heights[i] = autodifferenceSum(nrg, intervals[i], mids);
+  };
+
+  parallelFor(intervals.size(), workerCount(_options.threads, intervals.size()), body);
+  return heights;
+}
+
+double Analyzer::intervalForBPM(double bpm) const {
+  double beatsPerSecond = bpm / 60.0;
+  double samplesPerBeat = _sampleRate / beatsPerSecond;
+  return samplesPerBeat / kEnvelopeInterval;
+}
+
+double Analyzer::bpmForInterval(double interval) const {
+  double samplesPerBeat = interval * kEnvelopeInterval;
+  double beatsPerSecond = _sampleRate / samplesPerBeat;
+  return beatsPerSecond * 60.0;
+}
+
+} // namespace bpm
@@ -0,0 +1,130 @@
+//
+//  BPMEngine.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+/// Portable tempo estimation ported from bpm-tools (https://www.pogo.org.uk/~mark/bpm-tools/).
+/// Plain C++ with no Foundation dependency, so it builds and runs outside the app.
+namespace bpm {
+
+/// Number of PCM samples folded into a single energy envelope value.
+constexpr size_t kEnvelopeInterval = 128;
+
+enum class Engine {
+  /// Random-sampling autodifference over the energy envelope, see `Analyzer`.
+  Autodifference,
+  /// FFT onsets and comb-filtered autocorrelation, see `SpectralFlux`.
+  SpectralFlux,
+};
+
+enum class SearchMode {
+  /// Evenly spaced sweep over the whole BPM range, the original bpm-tools behaviour.
+  Exhaustive,
+  /// Cheap coarse sweep, then a dense sweep only around its lowest troughs.
+  Hierarchical,
+};
+
+struct Options {
+  double minBPM = 84.0;
+  double maxBPM = 146.0;
+  SearchMode search = SearchMode::Exhaustive;
+
+  /// Exhaustive sweep: interval steps across the range and random midpoints per step.
+  unsigned int steps = 1024;
+  unsigned int samples = 1024;
+
+  /// Hierarchical search: the coarse sweep, how many of its troughs to keep, and the refinement
+  /// sweep spanning one coarse step either side of each kept trough.
+  unsigned int coarseSteps = 128;
+  unsigned int coarseSamples = 128;
+  unsigned int troughs = 3;
+  unsigned int refineSteps = 16;
+  unsigned int refineSamples = 1024;
+
+  /// Seeds the random midpoints. The same seed always yields the same BPM, whatever the thread count.
+  uint64_t seed = 1;
+  /// Worker threads for the interval sweep, 0 uses every core.
+  unsigned int threads = 0;
+};
+
+struct Result {
+  double bpm = 0.0;
+  /// 0...1, how deep the winning trough sits below the average of the sweep.
+  double confidence = 0.0;
+  /// Envelope lookups spent on the search, for throughput measurements.
+  size_t lookups = 0;
+};
+
+/// Builds the `kEnvelopeInterval`-decimated energy envelope incrementally, so decoded audio can be
+/// fed buffer by buffer and dropped straight away. Memory stays proportional to the envelope, not the PCM.
+class EnvelopeFollower {
+public:
+  /// Pre-sizes the envelope for roughly `frames` PCM samples.
+  void reserve(size_t frames);
+
+  void process(std::span<const float> samples);
+
+  std::span<const float> envelope() const {
+    return _nrg;
+  }
+
+  std::vector<float> takeEnvelope() {
+    return std::move(_nrg);
+  }
+
+private:
+  std::vector<float> _nrg;
+  double _v = 0.0;
+  size_t _n = 0;
+};
+
+class Analyzer {
+public:
+  explicit Analyzer(double sampleRate, Options options = {});
+
+  /// Estimates the tempo of mono PCM samples at the analyzer's sample rate.
+  Result analyze(std::span<const float> samples) const;
+
+  /// Estimates the tempo from an energy envelope produced by `envelope()`.
+  Result analyzeEnvelope(std::span<const float> nrg) const;
+
+  static std::vector<float> envelope(std::span<const float> samples);
+
+private:
+  struct Sweep {
+    double interval = NAN;
+    /// Lowest and average autodifference, per midpoint so sweeps with different budgets compare.
+    double height = INFINITY;
+    double mean = 0.0;
+    size_t midpoints = 0;
+  };
+
+  Sweep searchExhaustive(std::span<const float> nrg, double fastest, double slowest) const;
+  Sweep searchHierarchical(std::span<const float> nrg, double fastest, double slowest) const;
+
+  /// Sums `samples` autodifferences for each interval, spread over the worker pool.
+  /// `stream` keeps the midpoints of separate passes over the same intervals independent.
+  std::vector<double> measure(std::span<const float> nrg,
+                              std::span<const double> intervals,
+                              unsigned int samples,
+                              uint64_t stream) const;
+
+  double intervalForBPM(double bpm) const;
+  double bpmForInterval(double interval) const;
+
+  double _sampleRate;
+  Options _options;
+};
+
+} // namespace bpm
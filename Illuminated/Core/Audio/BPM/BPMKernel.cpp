@@ -0,0 +1,279 @@
+//
+//  BPMKernel.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMKernel.h"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BPM_KERNEL_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define BPM_KERNEL_NEON 1
+#endif
+
+/// A fused multiply-add rounds once instead of twice, which would make the scalar path
+/// drift from the SIMD lanes. Keep every multiply and add separate.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+
+namespace bpm {
+
+namespace {
+
+constexpr double kBeats[] = {-32, -16, -8, -4, -2, -1, 1, 2, 4, 8, 16, 32};
+constexpr double kNobeats[] = {-0.5, -0.25, 0.25, 0.5};
+
+double weightTotal() {
+  double total = 0.0;
+  for (double beat : kBeats) {
+    total += 1.0 / std::fabs(beat);
+  }
+  for (double nobeat : kNobeats) {
+    total += std::fabs(nobeat);
+  }
+  return total;
+}
+
+inline double sample(std::span<const float> nrg, double offset) {
+  double n = std::floor(offset);
+  if (n >= 0.0 && n < (double)nrg.size()) {
+    return nrg[(size_t)n];
+  }
+  return 0.0;
+}
+
+inline double autodifference(std::span<const float> nrg, double interval, double mid, double total) {
+  double v = sample(nrg, mid);
+  double diff = 0.0;
+
+  for (double beat : kBeats) {
+    double y = sample(nrg, mid + beat * interval);
+    double w = 1.0 / std::fabs(beat);
+    diff += w * std::fabs(y - v);
+  }
+
+  for (double nobeat : kNobeats) {
+    double y = sample(nrg, mid + nobeat * interval);
+    double w = std::fabs(nobeat);
+    diff -= w * std::fabs(y - v);
+  }
+
+  return diff / total;
+}
+
+/// Continues the running sum `t` from midpoint `from`, so SIMD tails keep the scalar summation order.
+double sumScalar(std::span<const float> nrg, double interval, std::span<const double> mids, size_t from, double t) {
+  double total = weightTotal();
+  for (size_t i = from; i < mids.size(); i++) {
+    t += autodifference(nrg, interval, mids[i], total);
+  }
+  return t;
+}
+
+#if BPM_KERNEL_X86
+
+__attribute__((target("avx2"))) inline __m256d lookupAVX2(const float *base, __m256d size, __m256d offset) {
+  __m256d n = _mm256_floor_pd(offset);
+  __m256d valid = _mm256_and_pd(_mm256_cmp_pd(n, _mm256_setzero_pd(), _CMP_GE_OQ), _mm256_cmp_pd(n, size, _CMP_LT_OQ));
+
+  // Out of range lanes read index 0 and get masked back to zero afterwards
+  __m128i index = _mm256_cvttpd_epi32(_mm256_and_pd(n, valid));
+  __m128 y = _mm_i32gather_ps(base, index, sizeof(float));
+  return _mm256_and_pd(_mm256_cvtps_pd(y), valid);
+}
+
+__attribute__((target("avx2"))) double
+sumAVX2(std::span<const float> nrg, double interval, std::span<const double> mids) {
+  const __m256d size = _mm256_set1_pd((double)nrg.size());
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d total = _mm256_set1_pd(weightTotal());
+
+  double t = 0.0;
+  size_t i = 0;
+  for (; i + 4 <= mids.size(); i += 4) {
+    __m256d mid = _mm256_loadu_pd(mids.data() + i);
+    __m256d v = lookupAVX2(nrg.data(), size, mid);
+    __m256d diff = _mm256_setzero_pd();
+
+    for (double beat : kBeats) {
+      __m256d y = lookupAVX2(nrg.data(), size, _mm256_add_pd(mid, _mm256_set1_pd(beat * interval)));
+      __m256d w = _mm256_set1_pd(1.0 / std::fabs(beat));
+      diff = _mm256_add_pd(diff, _mm256_mul_pd(w, _mm256_andnot_pd(sign, _mm256_sub_pd(y, v))));
+    }
+
+    for (double nobeat : kNobeats) {
+      __m256d y = lookupAVX2(nrg.data(), size, _mm256_add_pd(mid, _mm256_set1_pd(nobeat * interval)));
+      __m256d w = _mm256_set1_pd(std::fabs(nobeat));
+      diff = _mm256_sub_pd(diff, _mm256_mul_pd(w, _mm256_andnot_pd(sign, _mm256_sub_pd(y, v))));
+    }
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_div_pd(diff, total));
+    t += lanes[0];
+    t += lanes[1];
+    t += lanes[2];
+    t += lanes[3];
+  }
+
+  return sumScalar(nrg, interval, mids, i, t);
+}
+
+__attribute__((target("sse4.1"))) inline __m128d lookupSSE41(std::span<const float> nrg, __m128d size, __m128d offset) {
+  __m128d n = _mm_floor_pd(offset);
+  __m128d valid = _mm_and_pd(_mm_cmpge_pd(n, _mm_setzero_pd()), _mm_cmplt_pd(n, size));
+
+  alignas(16) int32_t index[4];
+  _mm_store_si128((__m128i *)index, _mm_cvttpd_epi32(_mm_and_pd(n, valid)));
+  __m128d y = _mm_set_pd(nrg[(size_t)index[1]], nrg[(size_t)index[0]]);
+  return _mm_and_pd(y, valid);
+}
+
+__attribute__((target("sse4.1"))) double
+sumSSE41(std::span<const float> nrg, double interval, std::span<const double> mids) {
+  const __m128d size = _mm_set1_pd((double)nrg.size());
+  const __m128d sign = _mm_set1_pd(-0.0);
+  const __m128d total = _mm_set1_pd(weightTotal());
+
+  double t = 0.0;
+  size_t i = 0;
+  for (; i + 2 <= mids.size(); i += 2) {
+    __m128d mid = _mm_loadu_pd(mids.data() + i);
+    __m128d v = lookupSSE41(nrg, size, mid);
+    __m128d diff = _mm_setzero_pd();
+
+    for (double beat : kBeats) {
+      __m128d y = lookupSSE41(nrg, size, _mm_add_pd(mid, _mm_set1_pd(beat * interval)));
+      __m128d w = _mm_set1_pd(1.0 / std::fabs(beat));
+      diff = _mm_add_pd(diff, _mm_mul_pd(w, _mm_andnot_pd(sign, _mm_sub_pd(y, v))));
+    }
+
+    for (double nobeat : kNobeats) {
+      __m128d y = lookupSSE41(nrg, size, _mm_add_pd(mid, _mm_set1_pd(nobeat * interval)));
+      __m128d w = _mm_set1_pd(std::fabs(nobeat));
+      diff = _mm_sub_pd(diff, _mm_mul_pd(w, _mm_andnot_pd(sign, _mm_sub_pd(y, v))));
+    }
+
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_div_pd(diff, total));
+    t += lanes[0];
+    t += lanes[1];
+  }
+
+  return sumScalar(nrg, interval, mids, i, t);
+}
+
+#elif BPM_KERNEL_NEON
+
+inline float64x2_t lookupNEON(std::span<const float> nrg, float64x2_t size, float64x2_t offset) {
+  float64x2_t n = vrndmq_f64(offset);
+  uint64x2_t valid = vandq_u64(vcgeq_f64(n, vdupq_n_f64(0.0)), vcltq_f64(n, size));
+
+  // Out of range lanes read index 0 and get masked back to zero afterwards
+  int64x2_t index = vcvtq_s64_f64(vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(n), valid)));
+  float64x2_t y = vdupq_n_f64(nrg[(size_t)vgetq_lane_s64(index, 0)]);
+  y = vsetq_lane_f64(nrg[(size_t)vgetq_lane_s64(index, 1)], y, 1);
+  return vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(y), valid));
+}
+
+double sumNEON(std::span<const float> nrg, double interval, std::span<const double> mids) {
+  const float64x2_t size = vdupq_n_f64((double)nrg.size());
+  const float64x2_t total = vdupq_n_f64(weightTotal());
+
+  double t = 0.0;
+  size_t i = 0;
+  for (; i + 2 <= mids.size(); i += 2) {
+    float64x2_t mid = vld1q_f64(mids.data() + i);
+    float64x2_t v = lookupNEON(nrg, size, mid);
+    float64x2_t diff = vdupq_n_f64(0.0);
+
+    for (double beat : kBeats) {
+      float64x2_t y = lookupNEON(nrg, size, vaddq_f64(mid, vdupq_n_f64(beat * interval)));
+      float64x2_t w = vdupq_n_f64(1.0 / std::fabs(beat));
+      diff = vaddq_f64(diff, vmulq_f64(w, vabsq_f64(vsubq_f64(y, v))));
+    }
+
+    for (double nobeat : kNobeats) {
+      float64x2_t y = lookupNEON(nrg, size, vaddq_f64(mid, vdupq_n_f64(nobeat * interval)));
+      float64x2_t w = vdupq_n_f64(std::fabs(nobeat));
+      diff = vsubq_f64(diff, vmulq_f64(w, vabsq_f64(vsubq_f64(y, v))));
+    }
+
+    float64x2_t r = vdivq_f64(diff, total);
+    t += vgetq_lane_f64(r, 0);
+    t += vgetq_lane_f64(r, 1);
+  }
+
+  return sumScalar(nrg, interval, mids, i, t);
+}
+
+#endif
+
+enum class Kernel { Scalar, SSE41, AVX2, NEON };
+
+Kernel detectKernel() {
+#if BPM_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Kernel::AVX2;
+  if (__builtin_cpu_supports("sse4.1")) return Kernel::SSE41;
+  return Kernel::Scalar;
+#elif BPM_KERNEL_NEON
+  return Kernel::NEON;
+#else
+  return Kernel::Scalar;
+#endif
+}
+
+Kernel activeKernel() {
+  static const Kernel kernel = detectKernel();
+  return kernel;
+}
+
+} // namespace
+
+double autodifferenceSumScalar(std::span<const float> nrg, double interval, std::span<const double> mids) {
+  return sumScalar(nrg, interval, mids, 0, 0.0);
+}
+
+double autodifferenceSum(std::span<const float> nrg, double interval, std::span<const double> mids) {
+  // Gathers take 32-bit indices, and masked lanes still read index 0, which an empty envelope does not have
+  if (nrg.empty() || nrg.size() > (size_t)INT32_MAX) {
+    return sumScalar(nrg, interval, mids, 0, 0.0);
+  }
+
+  switch (activeKernel()) {
+#if BPM_KERNEL_X86
+  case Kernel::AVX2:
+    return sumAVX2(nrg, interval, mids);
+  case Kernel::SSE41:
+    return sumSSE41(nrg, interval, mids);
+#elif BPM_KERNEL_NEON
+  case Kernel::NEON:
+    return sumNEON(nrg, interval, mids);
+#endif
+  default:
+    return sumScalar(nrg, interval, mids, 0, 0.0);
+  }
+}
+
+const char *autodifferenceKernelName() {
+  switch (activeKernel()) {
+  case Kernel::AVX2:
+    return "avx2";
+  case Kernel::SSE41:
+    return "sse4.1";
+  case Kernel::NEON:
+    return "neon";
+  default:
+    return "scalar";
+  }
+}
+
+} // namespace bpm
@@ -0,0 +1,29 @@
+//
+//  BPMKernel.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace bpm {
+
+/// Envelope lookups performed per autodifference midpoint: the midpoint itself, 12 beats and 4 off-beats.
+constexpr size_t kLookupsPerMidpoint = 17;
+
+/// Sums the autodifference of every midpoint in `mids` at a single beat interval.
+/// Midpoints are evaluated several at a time with SIMD gathers over the envelope (AVX2 / SSE4.1 / NEON,
+/// picked at runtime) and accumulated in order, so the result is bit-identical to `autodifferenceSumScalar`.
+double autodifferenceSum(std::span<const float> nrg, double interval, std::span<const double> mids);
+
+/// Reference implementation, one midpoint at a time.
+double autodifferenceSumScalar(std::span<const float> nrg, double interval, std::span<const double> mids);
+
+/// Name of the kernel `autodifferenceSum` dispatches to on this machine.
+const char *autodifferenceKernelName();
+
+} // namespace bpm
@@ -0,0 +1,143 @@
+//
+//  FFT.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "FFT.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace bpm {
+
+namespace {
+
+typedef float Vector4 __attribute__((vector_size(16)));
+
+inline Vector4 load(const float *p) {
+  Vector4 v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline void store(float *p, Vector4 v) {
+  std::memcpy(p, &v, sizeof(v));
+}
+
+} // namespace
+
+FFT::FFT(size_t size)
+    : _size(size), _bitReversed(size), _cos(size), _sin(size), _splitCos(size + 1), _splitSin(size + 1) {
+  size_t bits = 0;
+  while (((size_t)1 << bits) < size) {
+    bits++;
+  }
+
+  for (size_t i = 0; i < size; i++) {
+    size_t reversed = 0;
+    for (size_t b = 0; b < bits; b++) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    _bitReversed[i] = reversed;
+  }
+
+  for (size_t m = 1; m < size; m <<= 1) {
+    for (size_t k = 0; k < m; k++) {
+      double angle = -M_PI * (double)k / (double)m;
+      _cos[m + k] = (float)std::cos(angle);
+      _sin[m + k] = (float)std::sin(angle);
+    }
+  }
+
+  for (size_t k = 0; k <= size; k++) {
+    double angle = -M_PI * (double)k / (double)size;
+    _splitCos[k] = (float)std::cos(angle);
+    _splitSin[k] = (float)std::sin(angle);
+  }
+}
+
+void FFT::forward(float *real, float *imag) const {
+  for (size_t i = 0; i < _size; i++) {
+    size_t j = _bitReversed[i];
+    if (i < j) {
+      std::swap(real[i], real[j]);
+      std::swap(imag[i], imag[j]);
+    }
+  }
+
+  for (size_t m = 1; m < _size; m <<= 1) {
+    const float *wr = _cos.data() + m;
+    const float *wi = _sin.data() + m;
+
+    for (size_t start = 0; start < _size; start += 2 * m) {
+      float *ar = real + start;
+      float *ai = imag + start;
+      float *br = ar + m;
+      float *bi = ai + m;
+
+      size_t k = 0;
+      for (; k + 4 <= m; k += 4) {
+        Vector4 cr = load(wr + k), ci = load(wi + k);
+        Vector4 xr = load(br + k), xi = load(bi + k);
+        Vector4 tr = xr * cr - xi * ci;
+        Vector4 ti = xr * ci + xi * cr;
+        Vector4 ur = load(ar + k), ui = load(ai + k);
+        store(ar + k, ur + tr);
+        store(ai + k, ui + ti);
+        store(br + k, ur - tr);
+        store(bi + k, ui - ti);
+      }
+
+      for (; k < m; k++) {
+        float tr = br[k] * wr[k] - bi[k] * wi[k];
+        float ti = br[k] * wi[k] + bi[k] * wr[k];
+        float ur = ar[k], ui = ai[k];
+        ar[k] = ur + tr;
+        ai[k] = ui + ti;
+        br[k] = ur - tr;
+        bi[k] = ui - ti;
+      }
+    }
+  }
+}
+
+void FFT::forwardReal(const float *input, float *real, float *imag) const {
+  // Even samples become the real part and odd samples the imaginary part of a half-length signal
+  for (size_t i = 0; i < _size; i++) {
+    real[i] = input[2 * i];
+    imag[i] = input[2 * i + 1];
+  }
+
+  forward(real, imag);
+
+  // Split Z into the even/odd spectra and recombine: X[k] = E[k] + W^k * O[k], handling k and size - k together
+  // since both read Z[k] and Z[size - k].
+  auto combine = [&](float ar, float ai, float br, float bi, size_t k, float &xr, float &xi) {
+    float er = 0.5f * (ar + br);
+    float ei = 0.5f * (ai - bi);
+    float orr = 0.5f * (ai + bi);
+    float oi = 0.5f * (br - ar);
+    xr = er + _splitCos[k] * orr - _splitSin[k] * oi;
+    xi = ei + _splitCos[k] * oi + _splitSin[k] * orr;
+  };
+
+  for (size_t k = 0; k <= _size / 2; k++) {
+    size_t j = _size - k;
+    float ar = real[k], ai = imag[k];
+    float br = real[j % _size], bi = imag[j % _size];
+
+    float xr, xi, yr, yi;
+    combine(ar, ai, br, bi, k, xr, xi);
+    combine(br, bi, ar, ai, j, yr, yi);
+
+    real[k] = xr;
+    imag[k] = xi;
+    real[j] = yr;
+    imag[j] = yi;
+  }
+}
+
+} // namespace bpm
@@ -0,0 +1,43 @@
+//
+//  FFT.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace bpm {
+
+/// In-place radix-2 complex FFT over split real/imaginary arrays. Twiddles are laid out per stage so the
+/// butterflies walk contiguous memory and run four lanes at a time through compiler vector extensions.
+class FFT {
+public:
+  /// `size` must be a power of two.
+  explicit FFT(size_t size);
+
+  size_t size() const {
+    return _size;
+  }
+
+  void forward(float *real, float *imag) const;
+
+  /// Transforms `2 * size()` real samples by packing them into one half-length complex FFT.
+  /// `real` and `imag` must hold `size() + 1` values and receive bins 0 through Nyquist.
+  void forwardReal(const float *input, float *real, float *imag) const;
+
+private:
+  size_t _size;
+  std::vector<size_t> _bitReversed;
+  /// Stage with half-size m keeps its m twiddles at [m, 2m).
+  std::vector<float> _cos;
+  std::vector<float> _sin;
+  /// e^(-i*pi*k/size) for k in [0, size], used to split the packed real transform.
+  std::vector<float> _splitCos;
+  std::vector<float> _splitSin;
+};
+
+} // namespace bpm
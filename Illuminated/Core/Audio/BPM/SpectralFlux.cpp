@@ -0,0 +1,147 @@
+//
+//  SpectralFlux.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "SpectralFlux.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bpm {
+
+namespace {
+
+/// Log compression keeps quiet hi-hats from vanishing next to the kick.
+constexpr float kCompression = 100.0f;
+
+/// Beat period multiples summed by the comb filter, weighted 1/k.
+constexpr int kCombHarmonics = 4;
+
+/// Fractional lag resolution of the comb search, in hops.
+constexpr double kLagStep = 0.05;
+
+/// Linearly interpolated autocorrelation at a fractional lag.
+double correlationAt(const std::vector<double> &acf, double lag) {
+  size_t i = (size_t)lag;
+  if (i + 1 >= acf.size()) return 0.0;
+
+  double t = lag - i;
+  return acf[i] * (1.0 - t) + acf[i + 1] * t;
+}
+
+} // namespace
+
+SpectralFlux::SpectralFlux(double sampleRate, Options options)
+    : _sampleRate(sampleRate), _options(options), _fft(kFrameSize / 2), _window(kFrameSize),
+      _frame(kFrameSize), _real(kFrameSize / 2 + 1), _imag(kFrameSize / 2 + 1), _previous(kFrameSize / 2 + 1, 0.0f) {
+  for (size_t i = 0; i < kFrameSize; i++) {
+    _window[i] = (float)(0.5 - 0.5 * std::cos(2.0 * M_PI * i / kFrameSize));
+  }
+  _pending.reserve(kFrameSize * 2);
+}
+
+void SpectralFlux::process(std::span<const float> samples) {
+  while (!samples.empty()) {
+    size_t take = std::min(samples.size(), kFrameSize - std::min(_pending.size(), kFrameSize));
+    _pending.insert(_pending.end(), samples.begin(), samples.begin() + take);
+    samples = samples.subspan(take);
+
+    if (_pending.size() == kFrameSize) {
+      analyzeFrame();
+      _pending.erase(_pending.begin(), _pending.begin() + kHopSize);
+    }
+  }
+}
+
+void SpectralFlux::analyzeFrame() {
+  for (size_t i = 0; i < kFrameSize; i++) {
+    _frame[i] = _pending[i] * _window[i];
+  }
+
+  // The frame is real, so a half-length complex transform yields every bin up to Nyquist
+  _fft.forwardReal(_frame.data(), _real.data(), _imag.data());
+
+  float flux = 0.0f;
+  for (size_t k = 0; k < _previous.size(); k++) {
+    float magnitude = std::log1p(kCompression * std::sqrt(_real[k] * _real[k] + _imag[k] * _imag[k]));
+    flux += std::max(0.0f, magnitude - _previous[k]);
+    _previous[k] = magnitude;
+  }
+
+  // The very first frame has nothing to diff against
+  _onsets.push_back(_onsets.empty() && flux > 0.0f ? 0.0f : flux);
+}
+
+Result SpectralFlux::estimate() const {
+  Result result;
+  if (_sampleRate <= 0 || _options.minBPM <= 0 || _options.maxBPM <= _options.minBPM) {
+    return result;
+  }
+
+  double onsetRate = _sampleRate / kHopSize;
+  double minLag = 60.0 * onsetRate / _options.maxBPM;
+  double maxLag = 60.0 * onsetRate / _options.minBPM;
+
+  size_t maxCorrelationLag = (size_t)std::ceil(maxLag * kCombHarmonics) + 2;
+  if (_onsets.size() < maxCorrelationLag * 2) {
+    return result;
+  }
+
+  // Remove the local average so sustained loudness does not read as onsets
+  size_t radius = (size_t)(onsetRate / 4);
+  std::vector<double> novelty(_onsets.size());
+  double running = 0.0;
+  size_t from = 0, to = 0;
+  for (size_t i = 0; i < _onsets.size(); i++) {
+    while (to < std::min(_onsets.size(), i + radius + 1)) running += _onsets[to++];
+    while (from + radius < i) running -= _onsets[from++];
+    novelty[i] = std::max(0.0, _onsets[i] - running / (to - from));
+  }
+
+  std::vector<double> acf(maxCorrelationLag + 1, 0.0);
+  for (size_t lag = 0; lag <= maxCorrelationLag; lag++) {
+    double sum = 0.0;
+    for (size_t i = lag; i < novelty.size(); i++) {
+      sum += novelty[i] * novelty[i - lag];
+    }
+    acf[lag] = sum / (novelty.size() - lag);
+  }
+  if (acf[0] <= 0.0) {
+    return result;
+  }
+
+  double bestLag = NAN;
+  double bestScore = -INFINITY;
+  double sum = 0.0;
+  size_t count = 0;
+
+  for (double lag = minLag; lag <= maxLag; lag += kLagStep) {
+    // The half-beat tap separates the true period from a dotted one, which also lines up with every other beat
+    double score = correlationAt(acf, lag / 2) / 2;
+    for (int k = 1; k <= kCombHarmonics; k++) {
+      score += correlationAt(acf, lag * k) / k;
+    }
+
+    sum += score;
+    count++;
+    if (score > bestScore) {
+      bestScore = score;
+      bestLag = lag;
+    }
+  }
+
+  if (count == 0 || std::isnan(bestLag)) {
+    return result;
+  }
+
+  double mean = sum / count;
+  result.bpm = 60.0 * onsetRate / bestLag;
+  result.confidence = bestScore > 0.0 ? std::clamp((bestScore - mean) / bestScore, 0.0, 1.0) : 0.0;
+  result.lookups = count * (kCombHarmonics + 1);
+  return result;
+}
+
+} // namespace bpm
@@ -0,0 +1,54 @@
+//
+//  SpectralFlux.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include "BPMEngine.h"
+#include "FFT.h"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace bpm {
+
+/// Tempo estimation from spectral-flux onsets: a windowed FFT per hop, the positive log-magnitude change
+/// between hops as the onset strength, then a comb filter over its autocorrelation to pick the beat period.
+/// Consumes PCM incrementally like `EnvelopeFollower`, so it shares the same decoding loop.
+class SpectralFlux {
+public:
+  static constexpr size_t kFrameSize = 1024;
+  static constexpr size_t kHopSize = 256;
+
+  explicit SpectralFlux(double sampleRate, Options options = {});
+
+  void process(std::span<const float> samples);
+
+  /// Onset strength, one value per hop.
+  std::span<const float> onsets() const {
+    return _onsets;
+  }
+
+  Result estimate() const;
+
+private:
+  void analyzeFrame();
+
+  double _sampleRate;
+  Options _options;
+  FFT _fft;
+
+  std::vector<float> _window;
+  std::vector<float> _pending;
+  std::vector<float> _frame;
+  std::vector<float> _real;
+  std::vector<float> _imag;
+  std::vector<float> _previous;
+  std::vector<float> _onsets;
+};
+
+} // namespace bpm
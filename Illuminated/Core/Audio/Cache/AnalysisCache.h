@@ -0,0 +1,30 @@
+//
+//  AnalysisCache.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString *AnalysisCacheKey NS_STRING_ENUM;
+extern AnalysisCacheKey const AnalysisCacheKeyBPM;
+extern AnalysisCacheKey const AnalysisCacheKeyBPMConfidence;
+
+/// Expensive analysis results keyed by audio content instead of by track, so moving, re-importing or deleting and
+/// re-adding a file keeps them. One small plist per fingerprint in Application Support.
+@interface AnalysisCache : NSObject
+
+/// Content fingerprint of the audio file, nil if it cannot be read. Reads at most a few hundred kilobytes.
++ (nullable NSString *)fingerprintForFileAtURL:(NSURL *)url;
+
++ (nullable NSDictionary<AnalysisCacheKey, id> *)resultsForFingerprint:(NSString *)fingerprint;
+
+/// Merges `results` into whatever is already stored for the fingerprint.
++ (void)storeResults:(NSDictionary<AnalysisCacheKey, id> *)results forFingerprint:(NSString *)fingerprint;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+//
+//  AnalysisCache.mm
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "AnalysisCache.h"
+
+#include "ContentFingerprint.h"
+
+AnalysisCacheKey const AnalysisCacheKeyBPM = @"bpm";
+AnalysisCacheKey const AnalysisCacheKeyBPMConfidence = @"bpmConfidence";
+
+NSString *const kAnalysisDirectoryPath = @"Illuminated/Analysis";
+
+@implementation AnalysisCache
+
++ (NSString *)analysisDirectory {
+  static NSString *analysisDir = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
+    NSString *appSupport = [paths firstObject];
+    analysisDir = [appSupport stringByAppendingPathComponent:kAnalysisDirectoryPath];
+
+    [[NSFileManager defaultManager] createDirectoryAtPath:analysisDir
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
+  });
+  return analysisDir;
+}
+
+/// Serializes the read-merge-write of a single entry.
++ (dispatch_queue_t)queue {
+  static dispatch_queue_t queue = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    queue = dispatch_queue_create("com.illuminated.analysis-cache", DISPATCH_QUEUE_SERIAL);
+  });
+  return queue;
+}
+
++ (NSString *)pathForFingerprint:(NSString *)fingerprint {
+  NSString *filename = [NSString stringWithFormat:@"%@.plist", fingerprint];
+  return [[self analysisDirectory] stringByAppendingPathComponent:filename];
+}
+
++ (NSString *)fingerprintForFileAtURL:(NSURL *)url {
+  if (!url.isFileURL) return nil;
+
+  std::string fingerprint = fingerprint::fingerprintFile(url.fileSystemRepresentation);
+  if (fingerprint.empty()) return nil;
+
+  return [NSString stringWithUTF8String:fingerprint.c_str()];
+}
+
++ (NSDictionary<AnalysisCacheKey, id> *)resultsForFingerprint:(NSString *)fingerprint {
+  if (!fingerprint) return nil;
+
+  __block NSDictionary *results = nil;
+  NSString *path = [self pathForFingerprint:fingerprint];
+  dispatch_sync([self queue], ^{ results = [NSDictionary dictionaryWithContentsOfFile:path]; });
+  return results;
+}
+
++ (void)storeResults:(NSDictionary<AnalysisCacheKey, id> *)results forFingerprint:(NSString *)fingerprint {
+  if (!fingerprint || results.count == 0) return;
+
+  dispatch_sync([self queue], ^{
+    NSString *path = [self pathForFingerprint:fingerprint];
+    NSMutableDictionary *merged = [[NSDictionary dictionaryWithContentsOfFile:path] mutableCopy];
+    if (!merged) {
+      merged = [NSMutableDictionary dictionary];
+    }
+    [merged addEntriesFromDictionary:results];
+
+    if (![merged writeToFile:path atomically:YES]) {
+      NSLog(@"AnalysisCache: Failed to write results for %@", fingerprint);
+    }
+  });
+}
+
+@end
@@ -0,0 +1,245 @@
+//
+//  ContentFingerprint.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "ContentFingerprint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fingerprint {
+
+namespace {
+
+bool readAt(int fd, uint64_t offset, void *buffer, size_t length) {
+  uint8_t *bytes = (uint8_t *)buffer;
+  while (length > 0) {
+    ssize_t count = pread(fd, bytes, length, (off_t)offset);
+    if (count <= 0) return false;
+    bytes += count;
+    offset += (uint64_t)count;
+    length -= (size_t)count;
+  }
+  return true;
+}
+
+uint32_t bigEndian32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+uint64_t bigEndian64(const uint8_t *p) {
+  return ((uint64_t)bigEndian32(p) << 32) | bigEndian32(p + 4);
+}
+
+uint32_t littleEndian32(const uint8_t *p) {
+  return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+}
+
+/// ID3v2 tags can be stacked, skip all of them.
+uint64_t skipID3v2(int fd, uint64_t offset, uint64_t end) {
+  uint8_t header[10];
+  while (offset + sizeof(header) <= end && readAt(fd, offset, header, sizeof(header)) &&
+         std::memcmp(header, "ID3", 3) == 0) {
+    uint64_t size = ((uint64_t)(header[6] & 0x7F) << 21) | ((uint64_t)(header[7] & 0x7F) << 14) |
+                    ((uint64_t)(header[8] & 0x7F) << 7) | (uint64_t)(header[9] & 0x7F);
+    bool footer = header[5] & 0x10;
+    offset += sizeof(header) + size + (footer ? 10 : 0);
+  }
+  return std::min(offset, end);
+}
+
+/// Trailing ID3v1 and APEv2 tags, in either order.
+uint64_t trimTrailingTags(int fd, uint64_t start, uint64_t end) {
+  for (bool trimmed = true; trimmed;) {
+    trimmed = false;
+
+    uint8_t id3v1[3];
+    if (end >= start + 128 && readAt(fd, end - 128, id3v1, sizeof(id3v1)) && std::memcmp(id3v1, "TAG", 3) == 0) {
+      end -= 128;
+      trimmed = true;
+    }
+
+    uint8_t ape[32];
+    if (end >= start + sizeof(ape) && readAt(fd, end - sizeof(ape), ape, sizeof(ape)) &&
+        std::memcmp(ape, "APETAGEX", 8) == 0) {
+      // The size covers the items and the footer, the optional header comes on top
+      uint64_t size = littleEndian32(ape + 12) + ((littleEndian32(ape + 20) & 0x80000000u) ? sizeof(ape) : 0);
+      end = end >= start + size ? end - size : start;
+      trimmed = true;
+    }
+  }
+  return end;
+}
+
+Region flacRegion(int fd, uint64_t offset, uint64_t end) {
+  offset += 4;
+  uint8_t header[4];
+  while (offset + sizeof(header) <= end && readAt(fd, offset, header, sizeof(header))) {
+    uint64_t length = ((uint64_t)header[1] << 16) | ((uint64_t)header[2] << 8) | header[3];
+    offset += sizeof(header) + length;
+    if (header[0] & 0x80) break;
+  }
+  offset = std::min(offset, end);
+  return {offset, end - offset};
+}
+
+Region mp4Region(int fd, uint64_t end) {
+  uint64_t offset = 0;
+  uint8_t header[16];
+  while (offset + 8 <= end && readAt(fd, offset, header, 8)) {
+    uint64_t size = bigEndian32(header);
+    uint64_t headerSize = 8;
+    if (size == 1) {
+      if (offset + 16 > end || !readAt(fd, offset, header, 16)) break;
+      size = bigEndian64(header + 8);
+      headerSize = 16;
+    } else if (size == 0) {
+      size = end - offset;
+    }
+    if (size < headerSize) break;
+
+    if (std::memcmp(header + 4, "mdat", 4) == 0) {
+      uint64_t payload = offset + headerSize;
+      return {payload, std::min(offset + size, end) - payload};
+    }
+    offset += size;
+  }
+  return {0, end};
+}
+
+/// RIFF chunks are little endian and padded to even sizes, AIFF chunks big endian.
+Region chunkRegion(int fd, uint64_t end, const char *wanted, bool littleEndian) {
+  uint64_t offset = 12;
+  uint8_t header[8];
+  while (offset + sizeof(header) <= end && readAt(fd, offset, header, sizeof(header))) {
+    uint64_t size = littleEndian ? littleEndian32(header + 4) : bigEndian32(header + 4);
+    uint64_t payload = offset + sizeof(header);
+    if (std::memcmp(header, wanted, 4) == 0) {
+      return {payload, std::min(payload + size, end) - payload};
+    }
+    offset = payload + size + (size & 1);
+  }
+  return {0, end};
+}
+
+/// Two independent 64-bit lanes over little-endian words. Not cryptographic, only meant to tell files apart.
+class Hasher {
+public:
+  void update(const uint8_t *bytes, size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      mixWord(word);
+    }
+
+    // `bytes` may be null for an empty payload, which memcpy must never see
+    uint64_t tail = 0;
+    if (i < length) {
+      std::memcpy(&tail, bytes + i, length - i);
+    }
+    mixWord(tail ^ ((uint64_t)(length - i) << 56));
+  }
+
+  void update(uint64_t value) {
+    mixWord(value);
+  }
+
+  std::string hex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string result(32, '0');
+    uint64_t lanes[] = {finalize(_a), finalize(_b ^ _a)};
+    for (int lane = 0; lane < 2; lane++) {
+      for (int nibble = 0; nibble < 16; nibble++) {
+        result[lane * 16 + nibble] = digits[(lanes[lane] >> (60 - nibble * 4)) & 0xF];
+      }
+    }
+    return result;
+  }
+
+private:
+  static uint64_t finalize(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  void mixWord(uint64_t word) {
+    _a = finalize(_a ^ word) + 0x9E3779B97F4A7C15ull;
+    uint64_t b = _b + word * 0xC2B2AE3D27D4EB4Full;
+    _b = ((b << 31) | (b >> 33)) * 0x9E3779B185EBCA87ull;
+  }
+
+  uint64_t _a = 0x243F6A8885A308D3ull;
+  uint64_t _b = 0x13198A2E03707344ull;
+};
+
+} // namespace
+
+Region audioRegion(int fd, uint64_t fileSize) {
+  uint64_t start = skipID3v2(fd, 0, fileSize);
+
+  uint8_t magic[12] = {};
+  if (fileSize - start < sizeof(magic) || !readAt(fd, start, magic, sizeof(magic))) {
+    return {start, fileSize - start};
+  }
+
+  if (std::memcmp(magic, "fLaC", 4) == 0) {
+    return flacRegion(fd, start, fileSize);
+  }
+  if (start == 0 && std::memcmp(magic + 4, "ftyp", 4) == 0) {
+    return mp4Region(fd, fileSize);
+  }
+  if (start == 0 && std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "WAVE", 4) == 0) {
+    return chunkRegion(fd, fileSize, "data", true);
+  }
+  if (start == 0 && std::memcmp(magic, "FORM", 4) == 0 &&
+      (std::memcmp(magic + 8, "AIFF", 4) == 0 || std::memcmp(magic + 8, "AIFC", 4) == 0)) {
+    return chunkRegion(fd, fileSize, "SSND", false);
+  }
+
+  uint64_t end = trimTrailingTags(fd, start, fileSize);
+  return {start, end - start};
+}
+
+std::string fingerprintFile(const char *path, size_t sampleBytes) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return std::string();
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return std::string();
+  }
+
+  Region region = audioRegion(fd, (uint64_t)info.st_size);
+
+  Hasher hasher;
+  hasher.update(region.length);
+
+  // Short payloads are hashed whole, longer ones by their two ends
+  uint64_t head = std::min<uint64_t>(region.length, sampleBytes);
+  uint64_t tail = std::min<uint64_t>(region.length - head, sampleBytes);
+  std::vector<uint8_t> buffer((size_t)std::max(head, tail));
+
+  bool ok = readAt(fd, region.offset, buffer.data(), (size_t)head);
+  if (ok) {
+    hasher.update(buffer.data(), (size_t)head);
+  }
+  if (ok && tail > 0) {
+    ok = readAt(fd, region.offset + region.length - tail, buffer.data(), (size_t)tail);
+    hasher.update(buffer.data(), (size_t)tail);
+  }
+
+  close(fd);
+  return ok ? hasher.hex() : std::string();
+}
+
+} // namespace fingerprint
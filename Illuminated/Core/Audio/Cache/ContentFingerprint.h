@@ -0,0 +1,34 @@
+//
+//  ContentFingerprint.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Fast identity for audio files that survives moves, renames and tag edits: only the encoded audio is hashed,
+/// never the metadata around it. Plain C++ with no Foundation dependency.
+namespace fingerprint {
+
+/// Bytes hashed from each end of the audio payload.
+constexpr size_t kSampleBytes = 64 * 1024;
+
+struct Region {
+  uint64_t offset = 0;
+  uint64_t length = 0;
+};
+
+/// Locates the encoded audio inside an open file: MP3 without ID3v2/ID3v1/APEv2 tags, FLAC after its metadata
+/// blocks, the MP4 `mdat` box, the WAV `data` and AIFF `SSND` chunks. Anything else is hashed whole.
+Region audioRegion(int fd, uint64_t fileSize);
+
+/// Hashes the payload length plus its first and last `sampleBytes`. Returns 32 hex characters, or an empty
+/// string if the file cannot be read.
+std::string fingerprintFile(const char *path, size_t sampleBytes = kSampleBytes);
+
+} // namespace fingerprint
@@ -12,11 +12,49 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class BFTask<__covariant ResultType>;
+@class BFExecutor;
+
+typedef NS_ENUM(NSInteger, BPMAnalyzerEngine) {
+  /// Random-sampling autodifference over the energy envelope. Cheapest per window.
+  BPMAnalyzerEngineAutodifference,
+  /// FFT spectral-flux onsets with a comb filter over their autocorrelation. Slower, but steadier on busy mixes.
+  BPMAnalyzerEngineSpectralFlux,
+};
+
+/// Below this confidence a consensus BPM is worth re-analyzing with more windows.
+extern const double BPMAnalysisLowConfidence;
+
+@interface BPMAnalysisResult : NSObject
+
+@property(nonatomic, readonly) double bpm;
+@property(nonatomic, readonly) double confidence;
+@property(nonatomic, copy, readonly) NSArray<NSNumber *> *windowBPMs;
+
+- (instancetype)initWithBPM:(double)bpm confidence:(double)confidence windowBPMs:(NSArray<NSNumber *> *)windowBPMs;
+
+@end
 
 @interface BPMAnalyzer : NSObject
 
+/// Analyzes the middle 30 seconds of the track.
 + (BFTask<NSNumber *> *)analyzeBPMForAssetTrack:(AVAssetTrack *)track;
 
+/// Analyzes up to `windowCount` short windows spread across the track, middle first, and returns their consensus.
+/// Stops as soon as enough windows agree, so steady tracks only pay for a few of them.
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track windowCount:(NSUInteger)windowCount;
+
+/// Same as above with an explicit engine, the method above uses `BPMAnalyzerEngineAutodifference`.
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track
+                                                  windowCount:(NSUInteger)windowCount
+                                                       engine:(BPMAnalyzerEngine)engine;
+
+/// Background variant: every window runs on `executor` and sweeps on a single thread, so the executor alone bounds
+/// how much CPU the analysis takes.
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track
+                                                  windowCount:(NSUInteger)windowCount
+                                                       engine:(BPMAnalyzerEngine)engine
+                                                     executor:(BFExecutor *)executor;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -10,18 +10,109 @@
 #import "BFExecutor.h"
 #import "BFTask.h"
 
-#include <assert.h>
-#include <math.h>
-#include <stdbool.h>
-#include <stdio.h>
-#include <stdlib.h>
+#include "BPMConsensus.h"
+#include "BPMEngine.h"
+#include "SpectralFlux.h"
+
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
-#define LOWER_BPM 84.0
-#define UPPER_BPM 146.0
-#define BLOCK 4096
-#define INTERVAL 128
-#define ARRAY_SIZE(x) (sizeof(x) / sizeof(*(x)))
+const double BPMAnalysisLowConfidence = 0.35;
+
+static const double kAnalysisSampleRate = 44100.0;
+
+static const Float64 kWindowSeconds = 12.0;
+static const NSUInteger kWindowsPerRound = 2;
+static const NSUInteger kAgreeingWindowsToStop = 3;
+
+/// Sweep threads for foreground analysis, 0 uses every core.
+static const unsigned int kAllCores = 0;
+
+/// `Sink` is anything with `process(std::span<const float>)`, i.e. `bpm::EnvelopeFollower` or `bpm::SpectralFlux`.
+template <typename Sink> static void AppendSampleBuffer(CMSampleBufferRef buffer, Sink &sink) {
+  CMBlockBufferRef blockBuffer = CMSampleBufferGetDataBuffer(buffer);
+  if (!blockBuffer) return;
+
+  // Block buffers are not guaranteed to be contiguous, so walk every segment
+  size_t length = CMBlockBufferGetDataLength(blockBuffer);
+  size_t offset = 0;
+  while (offset < length) {
+    size_t segmentLength = 0;
+    char *dataPointer = NULL;
+    if (CMBlockBufferGetDataPointer(blockBuffer, offset, &segmentLength, NULL, &dataPointer) != kCMBlockBufferNoErr ||
+        segmentLength == 0) {
+      break;
+    }
+
+    sink.process(std::span<const float>((const float *)dataPointer, segmentLength / sizeof(float)));
+    offset += segmentLength;
+  }
+}
+
+/// Decodes `timeRange` as mono float PCM at `kAnalysisSampleRate` and streams every buffer into `sink`.
+template <typename Sink> static BOOL ReadTrack(AVAssetTrack *track, CMTimeRange timeRange, Sink &sink) {
+  NSError *error = nil;
+  AVAssetReader *reader = [AVAssetReader assetReaderWithAsset:track.asset error:&error];
+  if (error) {
+    NSLog(@"Error creating asset reader: %@", error);
+    return NO;
+  }
+
+  NSDictionary *settings = @{
+    AVFormatIDKey : @(kAudioFormatLinearPCM),
+    AVLinearPCMBitDepthKey : @32,
+    AVLinearPCMIsFloatKey : @YES,
+    AVLinearPCMIsBigEndianKey : @NO,
+    AVLinearPCMIsNonInterleaved : @NO,
+    AVNumberOfChannelsKey : @1,
+    AVSampleRateKey : @(kAnalysisSampleRate)
+  };
+
+  AVAssetReaderTrackOutput *output = [AVAssetReaderTrackOutput assetReaderTrackOutputWithTrack:track
+                                                                                outputSettings:settings];
+  if (![reader canAddOutput:output]) {
+    return NO;
+  }
+  [reader addOutput:output];
+
+  reader.timeRange = timeRange;
+
+  if (![reader startReading]) {
+    return NO;
+  }
+
+  // Decoded buffers are folded into the sink as they arrive and released right away
+  while (reader.status == AVAssetReaderStatusReading) {
+    CMSampleBufferRef buffer = [output copyNextSampleBuffer];
+    if (buffer) {
+      AppendSampleBuffer(buffer, sink);
+      CFRelease(buffer);
+    } else {
+      break;
+    }
+  }
+
+  return reader.status == AVAssetReaderStatusCompleted;
+}
+
+#pragma mark - BPMAnalysisResult
+
+@implementation BPMAnalysisResult
+
+- (instancetype)initWithBPM:(double)bpm confidence:(double)confidence windowBPMs:(NSArray<NSNumber *> *)windowBPMs {
+  self = [super init];
+  if (self) {
+    _bpm = bpm;
+    _confidence = confidence;
+    _windowBPMs = [windowBPMs copy];
+  }
+  return self;
+}
+
+@end
+
+#pragma mark - BPMAnalyzer
 
 @implementation BPMAnalyzer
 
@@ -30,198 +121,190 @@
     if (!track) {
       return @(0);
     }
-    
-    NSError *error = nil;
-    AVAssetReader *reader = [AVAssetReader assetReaderWithAsset:track.asset error:&error];
-    if (error) {
-      NSLog(@"Error creating asset reader: %@", error);
-      return @(0);
-    }
-    
-    NSDictionary *settings = @{
-      AVFormatIDKey : @(kAudioFormatLinearPCM),
-      AVLinearPCMBitDepthKey : @32,
-      AVLinearPCMIsFloatKey : @YES,
-      AVLinearPCMIsBigEndianKey : @NO,
-      AVLinearPCMIsNonInterleaved : @NO,
-      AVNumberOfChannelsKey : @1,
-      AVSampleRateKey : @44100.0
-    };
-    
-    AVAssetReaderTrackOutput *output = [AVAssetReaderTrackOutput assetReaderTrackOutputWithTrack:track
-                                                                                  outputSettings:settings];
-    if (![reader canAddOutput:output]) {
-      return @(0);
-    }
-    [reader addOutput:output];
-    
+
     // Analyze middle 30 seconds
     CMTime duration = track.asset.duration;
     Float64 seconds = CMTimeGetSeconds(duration);
     CMTime startTime = kCMTimeZero;
     CMTime readDuration = duration;
-    
+
     if (seconds > 40.0) {
       Float64 startSeconds = (seconds / 2.0) - 15.0;
       startTime = CMTimeMakeWithSeconds(startSeconds, duration.timescale);
       readDuration = CMTimeMakeWithSeconds(30.0, duration.timescale);
     }
-    
-    reader.timeRange = CMTimeRangeMake(startTime, readDuration);
-    
-    if (![reader startReading]) {
-      return @(0);
-    }
-    
-    NSMutableData *floatData = [NSMutableData data];
-    
-    while (reader.status == AVAssetReaderStatusReading) {
-      CMSampleBufferRef buffer = [output copyNextSampleBuffer];
-      if (buffer) {
-        CMBlockBufferRef blockBuffer = CMSampleBufferGetDataBuffer(buffer);
-        size_t length = CMBlockBufferGetDataLength(blockBuffer);
-        char *dataPointer = NULL;
-        if (CMBlockBufferGetDataPointer(blockBuffer, 0, NULL, NULL, &dataPointer) == kCMBlockBufferNoErr) {
-          [floatData appendBytes:dataPointer length:length];
-        }
-        CFRelease(buffer);
-      } else {
-        break;
-      }
-    }
-    
-    if (reader.status == AVAssetReaderStatusCompleted) {
-      float *samples = (float *)floatData.bytes;
-      NSUInteger frameCount = floatData.length / sizeof(float);
-      return [BPMAnalyzer analyzeBPMFromBuffer:samples frames:frameCount sampleRate:44100.0];
-    }
-    
-    return @(0);
+
+    bpm::Result result = [self analyzeTrack:track
+                                  timeRange:CMTimeRangeMake(startTime, readDuration)
+                                     engine:BPMAnalyzerEngineAutodifference
+                                    threads:kAllCores];
+    return @(result.bpm);
   }];
 }
 
-+ (BFTask<NSNumber *> *)analyzeBPMFromBuffer:(float *)buffer frames:(NSUInteger)frames sampleRate:(float)sampleRate {
-  std::vector<float> data(buffer, buffer + frames);
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track windowCount:(NSUInteger)windowCount {
+  return [self analyzeWindowsForAssetTrack:track windowCount:windowCount engine:BPMAnalyzerEngineAutodifference];
+}
 
-  return [BFTask taskFromExecutor:[BFExecutor defaultExecutor] withBlock:^id {
-    if (frames == 0 || sampleRate <= 0) {
-      return @(0.0);
-    }
-    
-    double bpm = [self internalAnalyzeBPM:data sampleRate:sampleRate];
-    return @(bpm);
-  }];
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track
+                                                  windowCount:(NSUInteger)windowCount
+                                                       engine:(BPMAnalyzerEngine)engine {
+  return [self analyzeWindowsForAssetTrack:track
+                               windowCount:windowCount
+                                    engine:engine
+                                  executor:[BFExecutor defaultExecutor]
+                                   threads:kAllCores];
 }
 
-#pragma mark - Internal C-Ported Logic
-// https://www.pogo.org.uk/~mark/bpm-tools/
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track
+                                                  windowCount:(NSUInteger)windowCount
+                                                       engine:(BPMAnalyzerEngine)engine
+                                                     executor:(BFExecutor *)executor {
+  return [self analyzeWindowsForAssetTrack:track windowCount:windowCount engine:engine executor:executor threads:1];
+}
 
-+ (double)internalAnalyzeBPM:(const std::vector<float> &)data sampleRate:(double)rate {
-  std::vector<float> nrg;
-  nrg.reserve(data.size() / INTERVAL);
++ (BFTask<BPMAnalysisResult *> *)analyzeWindowsForAssetTrack:(AVAssetTrack *)track
+                                                  windowCount:(NSUInteger)windowCount
+                                                       engine:(BPMAnalyzerEngine)engine
+                                                     executor:(BFExecutor *)executor
+                                                      threads:(unsigned int)threads {
+  if (!track || windowCount == 0) {
+    return [BFTask taskWithResult:[[BPMAnalysisResult alloc] initWithBPM:0 confidence:0 windowBPMs:@[]]];
+  }
 
-  double v = 0.0;
-  size_t n = 0;
-  size_t len = 0;
+  NSArray<NSValue *> *ranges = [self windowRangesForTrack:track windowCount:windowCount];
+  return [self analyzeTrack:track
+               windowRanges:ranges
+                  fromIndex:0
+                     engine:engine
+                   executor:executor
+                    threads:threads
+                    windows:[NSMutableArray array]];
+}
 
-  for (float z : data) {
-    z = fabsf(z);
-    if (z > v) {
-      v += (z - v) / 8.0;
-    } else {
-      v -= (v - z) / 512.0;
-    }
+#pragma mark - Windows
 
-    n++;
-    if (n == INTERVAL) {
-      nrg.push_back(v);
-      len++;
-      n = 0;
-    }
-  }
+/// Evenly spread windows, ordered middle first so intros and outros are only analyzed when the middle disagrees.
++ (NSArray<NSValue *> *)windowRangesForTrack:(AVAssetTrack *)track windowCount:(NSUInteger)windowCount {
+  CMTime duration = track.asset.duration;
+  Float64 seconds = CMTimeGetSeconds(duration);
 
-  if (nrg.empty()) {
-    return 0.0;
+  if (!(seconds > kWindowSeconds * 2)) {
+    return @[ [NSValue valueWithCMTimeRange:CMTimeRangeMake(kCMTimeZero, duration)] ];
   }
 
-  double bpm = [self scanForBPM:nrg min:LOWER_BPM max:UPPER_BPM sampleRate:rate];
-  return bpm;
-}
+  NSUInteger count = MIN(windowCount, (NSUInteger)(seconds / kWindowSeconds));
+  NSMutableArray<NSValue *> *ranges = [NSMutableArray arrayWithCapacity:count];
 
-+ (double)scanForBPM:(const std::vector<float> &)nrg min:(double)slowest max:(double)fastest sampleRate:(double)rate {
-  auto bpm_to_interval = [&](double bpm) -> double {
-    double beats_per_second = bpm / 60.0;
-    double samples_per_beat = rate / beats_per_second;
-    return samples_per_beat / INTERVAL;
-  };
+  for (NSUInteger i = 0; i < count; i++) {
+    Float64 center = seconds * (i + 0.5) / count;
+    Float64 start = MAX(0.0, MIN(center - kWindowSeconds / 2.0, seconds - kWindowSeconds));
+    CMTimeRange range = CMTimeRangeMake(CMTimeMakeWithSeconds(start, duration.timescale),
+                                        CMTimeMakeWithSeconds(kWindowSeconds, duration.timescale));
+    [ranges addObject:[NSValue valueWithCMTimeRange:range]];
+  }
 
-  auto interval_to_bpm = [&](double interval) -> double {
-    double samples_per_beat = interval * INTERVAL;
-    double beats_per_second = rate / samples_per_beat;
-    return beats_per_second * 60.0;
-  };
+  Float64 middle = seconds / 2.0;
+  return [ranges sortedArrayUsingComparator:^NSComparisonResult(NSValue *lhs, NSValue *rhs) {
+    Float64 lhsDistance = fabs(CMTimeGetSeconds(lhs.CMTimeRangeValue.start) + kWindowSeconds / 2.0 - middle);
+    Float64 rhsDistance = fabs(CMTimeGetSeconds(rhs.CMTimeRangeValue.start) + kWindowSeconds / 2.0 - middle);
+    return [@(lhsDistance) compare:@(rhsDistance)];
+  }];
+}
 
-  double slowest_interval = bpm_to_interval(slowest);
-  double fastest_interval = bpm_to_interval(fastest);
+/// Analyzes the next round of windows concurrently, then stops once enough windows agree or recurses into the next
+/// round.
++ (BFTask<BPMAnalysisResult *> *)analyzeTrack:(AVAssetTrack *)track
+                                 windowRanges:(NSArray<NSValue *> *)ranges
+                                    fromIndex:(NSUInteger)index
+                                       engine:(BPMAnalyzerEngine)engine
+                                     executor:(BFExecutor *)executor
+                                      threads:(unsigned int)threads
+                                      windows:(NSMutableArray<BPMAnalysisResult *> *)windows {
+  NSUInteger end = MIN(index + kWindowsPerRound, ranges.count);
 
-  unsigned int steps = 1024;
-  unsigned int samples = 1024;
+  NSMutableArray<BFTask *> *tasks = [NSMutableArray array];
+  for (NSUInteger i = index; i < end; i++) {
+    CMTimeRange range = ranges[i].CMTimeRangeValue;
+    [tasks addObject:[BFTask taskFromExecutor:executor withBlock:^id {
+      bpm::Result result = [self analyzeTrack:track timeRange:range engine:engine threads:threads];
+      return [[BPMAnalysisResult alloc] initWithBPM:result.bpm confidence:result.confidence windowBPMs:@[]];
+    }]];
+  }
 
-  double step = (slowest_interval - fastest_interval) / steps;
-  double height = INFINITY;
-  double trough = NAN;
+  BFTask<NSArray *> *round = [BFTask taskForCompletionOfAllTasksWithResults:tasks];
+  return [round continueWithExecutor:executor withSuccessBlock:^id(BFTask<NSArray *> *task) {
+    [windows addObjectsFromArray:task.result];
 
-  for (double interval = fastest_interval; interval <= slowest_interval; interval += step) {
-    double t = 0.0;
-    for (unsigned int s = 0; s < samples; s++) {
-      t += [self autodifference:nrg interval:interval];
+    std::vector<bpm::Result> estimates;
+    NSMutableArray<NSNumber *> *windowBPMs = [NSMutableArray arrayWithCapacity:windows.count];
+    for (BPMAnalysisResult *window in windows) {
+      bpm::Result estimate;
+      estimate.bpm = window.bpm;
+      estimate.confidence = window.confidence;
+      estimates.push_back(estimate);
+      [windowBPMs addObject:@(window.bpm)];
     }
 
-    if (t < height) {
-      trough = interval;
-      height = t;
+    bpm::Consensus consensus = bpm::consensus(estimates);
+    if (end >= ranges.count || consensus.agreeing >= kAgreeingWindowsToStop) {
+      return [[BPMAnalysisResult alloc] initWithBPM:consensus.bpm
+                                         confidence:consensus.confidence
+                                         windowBPMs:windowBPMs];
     }
-  }
 
-  return interval_to_bpm(trough);
+    return [self analyzeTrack:track
+                 windowRanges:ranges
+                    fromIndex:end
+                       engine:engine
+                     executor:executor
+                      threads:threads
+                      windows:windows];
+  }];
 }
 
-+ (double)sample:(const std::vector<float> &)nrg offset:(double)offset {
-  double n = floor(offset);
-  size_t i = (size_t)n;
+#pragma mark - Analysis
 
-  if (n >= 0.0 && n < (double)nrg.size()) {
-    return nrg[i];
-  }
-  return 0.0;
+/// Shared by both engines, only the autodifference analyzer looks at the search mode and thread count.
++ (bpm::Options)optionsWithThreads:(unsigned int)threads {
+  bpm::Options options;
+  options.search = bpm::SearchMode::Hierarchical;
+  options.threads = threads;
+  return options;
 }
 
-+ (double)autodifference:(const std::vector<float> &)nrg interval:(double)interval {
-  double mid, v, diff, total;
-  static const double beats[] = {-32, -16, -8, -4, -2, -1, 1, 2, 4, 8, 16, 32};
-  static const double nobeats[] = {-0.5, -0.25, 0.25, 0.5};
-
-  mid = drand48() * nrg.size();
-  v = [self sample:nrg offset:mid];
-
-  diff = 0.0;
-  total = 0.0;
++ (bpm::Result)analyzeTrack:(AVAssetTrack *)track
+                  timeRange:(CMTimeRange)timeRange
+                     engine:(BPMAnalyzerEngine)engine
+                    threads:(unsigned int)threads {
+  if (engine == BPMAnalyzerEngineSpectralFlux) {
+    bpm::SpectralFlux flux(kAnalysisSampleRate, [self optionsWithThreads:threads]);
+    if (!ReadTrack(track, timeRange, flux)) {
+      return bpm::Result();
+    }
+    return flux.estimate();
+  }
 
-  for (double beat : beats) {
-    double y = [self sample:nrg offset:mid + beat * interval];
-    double w = 1.0 / fabs(beat);
-    diff += w * fabs(y - v);
-    total += w;
+  bpm::EnvelopeFollower follower;
+  // Ranges are never longer than two windows, see `windowRangesForTrack:`. An indefinite duration reads as NaN.
+  Float64 seconds = CMTimeGetSeconds(timeRange.duration);
+  if (std::isfinite(seconds) && seconds > 0) {
+    follower.reserve((size_t)(std::min(seconds, kWindowSeconds * 2) * kAnalysisSampleRate));
+  }
+  if (!ReadTrack(track, timeRange, follower)) {
+    return bpm::Result();
   }
 
-  for (double nobeat : nobeats) {
-    double y = [self sample:nrg offset:mid + nobeat * interval];
-    double w = fabs(nobeat);
-    diff -= w * fabs(y - v);
-    total += w;
+  return [self analyzeEnvelope:follower.envelope() sampleRate:kAnalysisSampleRate threads:threads];
+}
+
++ (bpm::Result)analyzeEnvelope:(std::span<const float>)nrg sampleRate:(double)sampleRate threads:(unsigned int)threads {
+  if (nrg.empty() || sampleRate <= 0) {
+    return bpm::Result();
   }
 
-  return diff / total;
+  bpm::Analyzer analyzer(sampleRate, [self optionsWithThreads:threads]);
+  return analyzer.analyzeEnvelope(nrg);
 }
 
 @end
@@ -0,0 +1,27 @@
+//
+//  DirectoryScanner.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class BFTask<__covariant ResultType>;
+@class BFCancellationToken;
+
+/// Finds the audio files among dropped files and folders, walking folders to any depth on several threads.
+/// Files are matched by extension, see `FileExtensionHelper`.
+@interface DirectoryScanner : NSObject
+
+/// Hands audio files to `batchHandler` as they are found, a few hundred at a time, on a background thread but never
+/// concurrently. Resolves to the number of files found once every folder has been walked or the walk was cancelled.
++ (BFTask<NSNumber *> *)scanURLs:(NSArray<NSURL *> *)urls
+               cancellationToken:(nullable BFCancellationToken *)cancellationToken
+                    batchHandler:(void (^)(NSArray<NSURL *> *fileURLs))batchHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
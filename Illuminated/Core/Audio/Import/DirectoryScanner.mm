@@ -0,0 +1,66 @@
+//
+//  DirectoryScanner.mm
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "DirectoryScanner.h"
+#import "BFCancellationToken.h"
+#import "BFExecutor.h"
+#import "BFTask.h"
+#import "FileExtensionHelper.h"
+
+#include "DirectoryWalker.h"
+
+#include <atomic>
+#include <memory>
+
+static const size_t kScanBatchSize = 500;
+
+@implementation DirectoryScanner
+
++ (BFTask<NSNumber *> *)scanURLs:(NSArray<NSURL *> *)urls
+               cancellationToken:(BFCancellationToken *)cancellationToken
+                    batchHandler:(void (^)(NSArray<NSURL *> *fileURLs))batchHandler {
+  std::vector<std::string> roots;
+  for (NSURL *url in urls) {
+    if (url.isFileURL) {
+      roots.emplace_back(url.fileSystemRepresentation);
+    }
+  }
+
+  library::WalkOptions options;
+  options.batchSize = kScanBatchSize;
+  for (NSString *extension in [FileExtensionHelper audioExtensions]) {
+    options.extensions.emplace_back(extension.UTF8String);
+  }
+
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  [cancellationToken registerCancellationObserverWithBlock:^{ cancelled->store(true); }];
+
+  BFExecutor *executor = [BFExecutor executorWithDispatchQueue:dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0)];
+  return [BFTask taskFromExecutor:executor withBlock:^id {
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    library::WalkStats stats = library::walkDirectories(roots, options, [&](std::vector<std::string> &&paths) {
+      @autoreleasepool {
+        NSMutableArray<NSURL *> *fileURLs = [NSMutableArray arrayWithCapacity:paths.size()];
+        for (const std::string &path : paths) {
+          [fileURLs addObject:[NSURL fileURLWithFileSystemRepresentation:path.c_str()
+                                                              isDirectory:NO
+                                                            relativeToURL:nil]];
+        }
+        batchHandler(fileURLs);
+      }
+    }, cancelled.get());
+
+    NSLog(@"DirectoryScanner: %llu audio files in %llu folders in %.2fs, %llu unreadable",
+          (unsigned long long)stats.matches,
+          (unsigned long long)stats.directories,
+          CFAbsoluteTimeGetCurrent() - start,
+          (unsigned long long)stats.errors);
+    return @(stats.matches);
+  }];
+}
+
+@end
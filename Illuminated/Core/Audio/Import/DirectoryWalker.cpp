@@ -0,0 +1,272 @@
+//
+//  DirectoryWalker.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "DirectoryWalker.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <strings.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace library {
+
+namespace {
+
+std::string joinPath(const std::string &directory, const char *name) {
+  std::string path;
+  path.reserve(directory.size() + std::char_traits<char>::length(name) + 1);
+  path += directory;
+  if (path.empty() || path.back() != '/') {
+    path += '/';
+  }
+  path += name;
+  return path;
+}
+
+void addStats(WalkStats &into, const WalkStats &stats) {
+  into.directories += stats.directories;
+  into.entries += stats.entries;
+  into.matches += stats.matches;
+  into.errors += stats.errors;
+}
+
+class Walker {
+public:
+  Walker(const WalkOptions &options, const WalkSink &sink, const std::atomic<bool> *cancelled)
+      : _options(options), _sink(sink), _cancelled(cancelled) {}
+
+  WalkStats run(const std::vector<std::string> &roots) {
+    std::vector<std::string> matches;
+    WalkStats stats;
+    for (const std::string &root : roots) {
+      struct stat info;
+      if (stat(root.c_str(), &info) != 0) {
+        stats.errors++;
+      } else if (S_ISDIR(info.st_mode)) {
+        _queue.push_back(root);
+      } else if (S_ISREG(info.st_mode) && matchesExtension(root.c_str())) {
+        stats.matches++;
+        matches.push_back(root);
+      }
+    }
+    flush(matches);
+    addStats(_stats, stats);
+
+    unsigned threadCount = _options.threads ? _options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) {
+      threads.emplace_back([this] { work(); });
+    }
+    work();
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    return _stats;
+  }
+
+private:
+  bool isCancelled() const {
+    return _cancelled && _cancelled->load(std::memory_order_relaxed);
+  }
+
+  /// Takes folders off the shared stack until it is empty and nobody is still listing one that could refill it.
+  void work() {
+    std::vector<std::string> matches;
+    std::vector<std::string> subdirectories;
+    WalkStats stats;
+
+    while (true) {
+      std::string directory;
+      {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        _queueChanged.wait(lock, [this] { return !_queue.empty() || _active == 0 || isCancelled(); });
+        if (_queue.empty() || isCancelled()) break;
+
+        // Last in, first out: depth first keeps the stack about as deep as the tree instead of as wide
+        directory = std::move(_queue.back());
+        _queue.pop_back();
+        _active++;
+      }
+
+      scan(directory, subdirectories, matches, stats);
+
+      bool wakeAll;
+      {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _active--;
+        for (std::string &subdirectory : subdirectories) {
+          _queue.push_back(std::move(subdirectory));
+        }
+        wakeAll = _active == 0 || subdirectories.size() > 1 || isCancelled();
+      }
+      if (wakeAll) {
+        _queueChanged.notify_all();
+      } else if (!subdirectories.empty()) {
+        _queueChanged.notify_one();
+      }
+      subdirectories.clear();
+    }
+    _queueChanged.notify_all();
+
+    flush(matches);
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    addStats(_stats, stats);
+  }
+
+  void scan(const std::string &directory,
+            std::vector<std::string> &subdirectories,
+            std::vector<std::string> &matches,
+            WalkStats &stats) {
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      stats.errors++;
+      return;
+    }
+    DIR *dir = fdopendir(fd);
+    if (!dir) {
+      close(fd);
+      stats.errors++;
+      return;
+    }
+    stats.directories++;
+
+    while (dirent *entry = readdir(dir)) {
+      const char *name = entry->d_name;
+      if (name[0] == '.') {
+        bool isDotOrDotDot = name[1] == '\0' || (name[1] == '.' && name[2] == '\0');
+        if (isDotOrDotDot || _options.skipHidden) continue;
+      }
+      stats.entries++;
+
+      // Not following links, which would be read a second time through their target or could loop
+      unsigned char type = entry->d_type;
+      if (type == DT_UNKNOWN) {
+        struct stat info;
+        if (fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) != 0) continue;
+        type = S_ISDIR(info.st_mode) ? DT_DIR : S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN;
+      }
+
+      if (type == DT_DIR) {
+        subdirectories.push_back(joinPath(directory, name));
+      } else if (type == DT_REG && matchesExtension(name)) {
+        stats.matches++;
+        matches.push_back(joinPath(directory, name));
+        if (matches.size() >= _options.batchSize) {
+          flush(matches);
+        }
+      }
+    }
+    closedir(dir);
+  }
+
+  bool matchesExtension(const char *path) const {
+    if (_options.extensions.empty()) {
+      return true;
+    }
+    const char *slash = strrchr(path, '/');
+    const char *dot = strrchr(slash ? slash : path, '.');
+    if (!dot) {
+      return false;
+    }
+    for (const std::string &extension : _options.extensions) {
+      if (strcasecmp(dot + 1, extension.c_str()) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void flush(std::vector<std::string> &matches) {
+    if (matches.empty()) {
+      return;
+    }
+    std::vector<std::string> batch;
+    batch.swap(matches);
+    std::lock_guard<std::mutex> lock(_sinkMutex);
+    _sink(std::move(batch));
+  }
+
+  const WalkOptions &_options;
+  const WalkSink &_sink;
+  const std::atomic<bool> *_cancelled;
+
+  std::mutex _queueMutex;
+  std::condition_variable _queueChanged;
+  std::vector<std::string> _queue;
+  size_t _active = 0;
+
+  std::mutex _sinkMutex;
+  std::mutex _statsMutex;
+  WalkStats _stats;
+};
+
+} // namespace
+
+FileStatus statFile(const std::string &path) {
+  FileStatus status;
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    status.state = (errno == ENOENT || errno == ENOTDIR) ? FileState::Missing : FileState::Unreadable;
+    return status;
+  }
+  if (!S_ISREG(info.st_mode)) {
+    status.state = FileState::Missing;
+    return status;
+  }
+
+#if defined(__APPLE__)
+  const struct timespec &modified = info.st_mtimespec;
+#else
+  const struct timespec &modified = info.st_mtim;
+#endif
+  status.state = FileState::Present;
+  status.stamp.size = (uint64_t)info.st_size;
+  status.stamp.modificationTime = (int64_t)modified.tv_sec * 1000000000 + modified.tv_nsec;
+  status.stamp.inode = (uint64_t)info.st_ino;
+  return status;
+}
+
+std::vector<FileStatus> statFiles(const std::vector<std::string> &paths, unsigned threads) {
+  std::vector<FileStatus> statuses(paths.size());
+  unsigned threadCount = threads ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+  threadCount = (unsigned)std::min<size_t>(threadCount, std::max<size_t>(paths.size(), 1));
+
+  // Each stat is a metadata lookup that may wait on the disk, so even a cold cache spreads well across threads
+  std::atomic<size_t> next{0};
+  auto work = [&] {
+    for (size_t i = next++; i < paths.size(); i = next++) {
+      statuses[i] = statFile(paths[i]);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < threadCount; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  return statuses;
+}
+
+WalkStats walkDirectories(const std::vector<std::string> &roots,
+                          const WalkOptions &options,
+                          const WalkSink &sink,
+                          const std::atomic<bool> *cancelled) {
+  Walker walker(options, sink, cancelled);
+  return walker.run(roots);
+}
+
+} // namespace library
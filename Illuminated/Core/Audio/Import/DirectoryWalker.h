@@ -0,0 +1,81 @@
+//
+//  DirectoryWalker.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Finds files by extension in deep folder trees on several threads, and checks known files for changes. Entry types
+/// come from the directory listing itself, so most files cost no `stat()` while walking, only the few file systems
+/// that leave the type out need one.
+namespace library {
+
+struct WalkOptions {
+  /// Without the dot, matched case-insensitively. Empty matches every file.
+  std::vector<std::string> extensions;
+  /// 0 picks one per core.
+  unsigned threads = 0;
+  /// Paths handed to the sink at once, fewer for the last batch of each thread.
+  size_t batchSize = 256;
+  /// Skips names starting with a dot, which also covers AppleDouble `._` files and `.Trashes`.
+  bool skipHidden = true;
+};
+
+struct WalkStats {
+  uint64_t directories = 0;
+  uint64_t entries = 0;
+  uint64_t matches = 0;
+  /// Directories that could not be opened, e.g. for lack of permission.
+  uint64_t errors = 0;
+};
+
+/// Gets batches of matching paths. Called from the walking threads but never concurrently, in no particular order.
+using WalkSink = std::function<void(std::vector<std::string> &&paths)>;
+
+/// Walks every folder in `roots` and hands the files matching `options` to `sink`. Plain files in `roots` are
+/// matched too, and `roots` may be symlinks. Symlinks inside them are skipped: a linked file mostly sits in the
+/// library under its own path as well and would be imported twice, a linked folder could loop. Setting `cancelled`
+/// stops taking new folders, whatever was found so far is still delivered. Returns once done.
+WalkStats walkDirectories(const std::vector<std::string> &roots,
+                          const WalkOptions &options,
+                          const WalkSink &sink,
+                          const std::atomic<bool> *cancelled = nullptr);
+
+/// What a rescan compares to tell whether a file changed, from one `stat()` without opening the file.
+struct FileStamp {
+  uint64_t size = 0;
+  /// Nanoseconds since 1970.
+  int64_t modificationTime = 0;
+  uint64_t inode = 0;
+
+  bool operator==(const FileStamp &) const = default;
+};
+
+enum class FileState {
+  Present,
+  /// Nothing there, or not a file anymore.
+  Missing,
+  /// Could not be checked, e.g. a permission error outside the sandbox. Says nothing about the file.
+  Unreadable,
+};
+
+struct FileStatus {
+  FileState state = FileState::Unreadable;
+  FileStamp stamp;
+};
+
+FileStatus statFile(const std::string &path);
+
+/// `statFile()` for every path on up to `threads` threads, 0 for one per core. Results are in the order of `paths`.
+std::vector<FileStatus> statFiles(const std::vector<std::string> &paths, unsigned threads = 0);
+
+} // namespace library
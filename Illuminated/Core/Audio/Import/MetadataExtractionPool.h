@@ -0,0 +1,80 @@
+//
+//  MetadataExtractionPool.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class BFTask<__covariant ResultType>;
+@class BFCancellationToken;
+
+/// What one worker found out about a file: its bookmark, tags and content fingerprint, or why it could not make a
+/// bookmark.
+@interface MetadataExtractionResult : NSObject
+
+@property(nonatomic, strong, readonly) NSURL *fileURL;
+@property(nonatomic, strong, readonly, nullable) NSData *bookmark;
+@property(nonatomic, copy, readonly) NSDictionary *metadata;
+/// See `AnalysisCache`.
+@property(nonatomic, copy, readonly, nullable) NSString *fingerprint;
+/// The file's stamp as of the probe, see `Track.fileSize`. All 0 if it could not be stat'ed.
+@property(nonatomic, readonly) int64_t fileSize;
+@property(nonatomic, readonly) int64_t fileModificationTime;
+@property(nonatomic, readonly) int64_t fileInode;
+@property(nonatomic, strong, readonly, nullable) NSError *error;
+
+@end
+
+/// Gets every result in order, then nil once the run is done or cancelled. The returned task holds the result's
+/// slot in the window until it completes, its value is ignored for the nil call.
+typedef BFTask *_Nullable (^MetadataExtractionDelivery)(MetadataExtractionResult *_Nullable result);
+
+/// One probe run that takes URLs as they come in. Its workers wait for more until `finish`, so the window and the
+/// delivery order carry across `addURLs:` calls.
+@interface MetadataExtractionRun : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Finishes once `finish` was called and every task `delivery` returned has, or cancelled.
+@property(nonatomic, strong, readonly) BFTask *task;
+
+/// Probes `urls` after everything added before.
+- (void)addURLs:(NSArray<NSURL *> *)urls;
+
+/// No more URLs are coming. The workers leave once the ones added are probed.
+- (void)finish;
+
+@end
+
+/// Creates bookmarks and reads tags for many files at once. Both are file I/O plus a TagLib parse per file, which
+/// spreads well across cores on an SSD and less so on a network share, hence the tunable worker count.
+@interface MetadataExtractionPool : NSObject
+
+@property(class, readonly, strong) MetadataExtractionPool *sharedPool;
+
+/// Files probed at once. Defaults to the number of active cores.
+@property(nonatomic) NSUInteger maxConcurrentExtractions;
+
+/// Starts a run on up to `maxConcurrentExtractions` workers, fed through `addURLs:` until `finish`. Results are handed
+/// to `delivery` as `extractMetadataForURLs:` does.
+- (MetadataExtractionRun *)startRunWithMaxPendingResults:(NSUInteger)maxPendingResults
+                                       cancellationToken:(nullable BFCancellationToken *)cancellationToken
+                                                delivery:(MetadataExtractionDelivery)delivery;
+
+/// Probes `urls` on up to `maxConcurrentExtractions` workers and hands every result to `delivery` one at a time, in
+/// the order of `urls`, on a serial queue. At most `maxPendingResults` results are alive at once, probed but not yet
+/// released by their delivery task, so a slow consumer holds the workers back instead of piling up results.
+/// Cancelling stops taking new files, results already probed are still delivered.
+/// The task finishes once every task `delivery` returned has, and logs the throughput in files per second.
+- (BFTask *)extractMetadataForURLs:(NSArray<NSURL *> *)urls
+                 maxPendingResults:(NSUInteger)maxPendingResults
+                 cancellationToken:(nullable BFCancellationToken *)cancellationToken
+                          delivery:(MetadataExtractionDelivery)delivery;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,234 @@
+//
+//  MetadataExtractionPool.mm
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "MetadataExtractionPool.h"
+#import "AnalysisCache.h"
+#import "BFCancellationToken.h"
+#import "BFTask.h"
+#import "BFTaskCompletionSource.h"
+#import "BookmarkResolver.h"
+#import "MetadataExtractor.h"
+
+#include "DirectoryWalker.h"
+
+@interface MetadataExtractionResult ()
+
+@property(nonatomic, strong, readwrite) NSURL *fileURL;
+@property(nonatomic, strong, readwrite, nullable) NSData *bookmark;
+@property(nonatomic, copy, readwrite) NSDictionary *metadata;
+@property(nonatomic, copy, readwrite, nullable) NSString *fingerprint;
+@property(nonatomic, readwrite) int64_t fileSize;
+@property(nonatomic, readwrite) int64_t fileModificationTime;
+@property(nonatomic, readwrite) int64_t fileInode;
+@property(nonatomic, strong, readwrite, nullable) NSError *error;
+
+@end
+
+@implementation MetadataExtractionResult
+@end
+
+@interface MetadataExtractionRun ()
+
+- (instancetype)initRun;
+
+/// Guards the run's state and the pool's bookkeeping for it, workers wait on it for more URLs.
+@property(nonatomic, strong) NSCondition *condition;
+@property(nonatomic, strong) NSMutableArray<NSURL *> *urls;
+@property(nonatomic) BOOL isFinished;
+@property(nonatomic, strong, readwrite) BFTask *task;
+
+@end
+
+@implementation MetadataExtractionRun
+
+- (instancetype)initRun {
+  self = [super init];
+  if (self) {
+    _condition = [[NSCondition alloc] init];
+    _urls = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (void)addURLs:(NSArray<NSURL *> *)urls {
+  [self.condition lock];
+  if (self.isFinished) {
+    NSLog(@"MetadataExtractionRun: Ignoring %lu files added after finish", (unsigned long)urls.count);
+  } else {
+    [self.urls addObjectsFromArray:urls];
+    [self.condition broadcast];
+  }
+  [self.condition unlock];
+}
+
+- (void)finish {
+  [self.condition lock];
+  self.isFinished = YES;
+  [self.condition broadcast];
+  [self.condition unlock];
+}
+
+@end
+
+@interface MetadataExtractionPool ()
+
+@property(nonatomic, strong) dispatch_queue_t workQueue;
+@property(nonatomic, strong) dispatch_queue_t deliveryQueue;
+
+@end
+
+@implementation MetadataExtractionPool
+
++ (MetadataExtractionPool *)sharedPool {
+  static MetadataExtractionPool *sharedPool = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{ sharedPool = [[self alloc] init]; });
+  return sharedPool;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _maxConcurrentExtractions = [NSProcessInfo processInfo].activeProcessorCount;
+    _workQueue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    _deliveryQueue = dispatch_queue_create("com.illuminated.metadata-delivery", DISPATCH_QUEUE_SERIAL);
+  }
+  return self;
+}
+
++ (MetadataExtractionResult *)probeURL:(NSURL *)url {
+  MetadataExtractionResult *result = [[MetadataExtractionResult alloc] init];
+  result.fileURL = url;
+  result.metadata = @{};
+
+  // Stamped before the tags are read, so a write racing the read shows up as a change on the next rescan
+  library::FileStatus status = library::statFile(url.fileSystemRepresentation);
+  result.fileSize = (int64_t)status.stamp.size;
+  result.fileModificationTime = status.stamp.modificationTime;
+  result.fileInode = (int64_t)status.stamp.inode;
+
+  NSError *error = nil;
+  result.bookmark = [BookmarkResolver bookmarkForURL:url error:&error];
+  if (error) {
+    result.error = error;
+    return result;
+  }
+
+  result.metadata = [MetadataExtractor extractMetadataFromFileAtURL:url];
+  result.fingerprint = [AnalysisCache fingerprintForFileAtURL:url];
+  return result;
+}
+
+- (BFTask *)extractMetadataForURLs:(NSArray<NSURL *> *)urls
+                 maxPendingResults:(NSUInteger)maxPendingResults
+                 cancellationToken:(BFCancellationToken *)cancellationToken
+                          delivery:(MetadataExtractionDelivery)delivery {
+  MetadataExtractionRun *run = [self startRunWithMaxPendingResults:maxPendingResults
+                                                 cancellationToken:cancellationToken
+                                                          delivery:delivery];
+  [run addURLs:urls];
+  [run finish];
+  return run.task;
+}
+
+- (MetadataExtractionRun *)startRunWithMaxPendingResults:(NSUInteger)maxPendingResults
+                                       cancellationToken:(BFCancellationToken *)cancellationToken
+                                                delivery:(MetadataExtractionDelivery)delivery {
+  MetadataExtractionRun *run = [[MetadataExtractionRun alloc] initRun];
+  NSUInteger workerCount = MAX(self.maxConcurrentExtractions, 1);
+  CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+
+  // Workers take a slot, then the next index, and park finished results in `pending` under the run's lock. Whoever
+  // fills the gap at the front hands the results now in order over to the delivery queue. Slots are taken before
+  // indexes, so the front of `pending` always holds one and the window cannot stall waiting on a later result.
+  NSCondition *condition = run.condition;
+  dispatch_semaphore_t slots = dispatch_semaphore_create((long)MAX(maxPendingResults, workerCount));
+  NSMutableDictionary<NSNumber *, MetadataExtractionResult *> *pending = [NSMutableDictionary dictionary];
+  __block NSUInteger nextIndex = 0;
+  __block NSUInteger deliveredCount = 0;
+
+  NSMutableArray<BFTask *> *deliveredTasks = [NSMutableArray array];
+  dispatch_queue_t deliveryQueue = self.deliveryQueue;
+  dispatch_group_t workers = dispatch_group_create();
+
+  // Workers waiting for more URLs wake up to leave
+  [cancellationToken registerCancellationObserverWithBlock:^{
+    [condition lock];
+    [condition broadcast];
+    [condition unlock];
+  }];
+
+  void (^worker)(void) = ^{
+    while (YES) {
+      dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+
+      [condition lock];
+      while (!cancellationToken.cancellationRequested && !run.isFinished && nextIndex >= run.urls.count) {
+        [condition wait];
+      }
+      BOOL hasURL = !cancellationToken.cancellationRequested && nextIndex < run.urls.count;
+      NSUInteger index = hasURL ? nextIndex++ : 0;
+      NSURL *url = hasURL ? run.urls[index] : nil;
+      [condition unlock];
+      if (!url) {
+        dispatch_semaphore_signal(slots);
+        return;
+      }
+
+      MetadataExtractionResult *result = nil;
+      @autoreleasepool {
+        result = [MetadataExtractionPool probeURL:url];
+      }
+
+      [condition lock];
+      pending[@(index)] = result;
+      while (pending[@(deliveredCount)]) {
+        MetadataExtractionResult *ready = pending[@(deliveredCount)];
+        [pending removeObjectForKey:@(deliveredCount)];
+        deliveredCount++;
+
+        // Queued under the lock, so the serial queue sees results in index order
+        dispatch_async(deliveryQueue, ^{
+          BFTask *task = delivery(ready) ?: [BFTask taskWithResult:nil];
+          [deliveredTasks addObject:task];
+          [task continueWithBlock:^id(BFTask *_) {
+            dispatch_semaphore_signal(slots);
+            return nil;
+          }];
+        });
+      }
+      [condition unlock];
+    }
+  };
+
+  for (NSUInteger i = 0; i < workerCount; i++) {
+    dispatch_group_async(workers, self.workQueue, worker);
+  }
+
+  // Every delivery is queued before its worker leaves the group, so this runs after the last one
+  BFTaskCompletionSource *source = [BFTaskCompletionSource taskCompletionSource];
+  dispatch_group_notify(workers, deliveryQueue, ^{
+    delivery(nil);
+
+    CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+    NSLog(@"MetadataExtractionPool: %lu files in %.2fs, %.1f files/s with %lu workers",
+          (unsigned long)deliveredCount,
+          elapsed,
+          elapsed > 0 ? deliveredCount / elapsed : 0.0,
+          (unsigned long)workerCount);
+    [source setResult:[deliveredTasks copy]];
+  });
+
+  run.task = [source.task continueWithSuccessBlock:^id(BFTask<NSArray<BFTask *> *> *task) {
+    return [[BFTask taskForCompletionOfAllTasks:task.result] continueWithBlock:^id(BFTask *allTask) {
+      return cancellationToken.cancellationRequested ? [BFTask cancelledTask] : allTask;
+    }];
+  }];
+  return run;
+}
+
+@end
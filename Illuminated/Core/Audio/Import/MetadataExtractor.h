@@ -11,8 +11,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface MetadataExtractor : NSObject
 
+/// Tags and audio properties. Embedded pictures are only flagged under `hasEmbeddedArtwork`, not copied.
 + (NSDictionary *)extractMetadataFromFileAtURL:(NSURL *)fileURL;
 
+/// The first embedded picture, as stored in the file. Skips reading audio properties.
++ (nullable NSData *)extractArtworkFromFileAtURL:(NSURL *)fileURL;
+
 + (void)updateMetadataAtURL:(NSURL *)fileURL metadata:(NSDictionary *)metadata;
 
 @end
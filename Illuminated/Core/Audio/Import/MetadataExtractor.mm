@@ -21,6 +21,11 @@
 #import <mpegfile.h>
 #import <attachedpictureframe.h>
 #import <mp4coverart.h>
+#import <vorbisfile.h>
+#import <opusfile.h>
+#import <oggflacfile.h>
+#import <wavfile.h>
+#import <aifffile.h>
 
 @implementation MetadataExtractor
 
@@ -72,20 +77,10 @@
     metadata[@"sampleRate"] = @(properties->sampleRate());
   }
   
-  NSString *extension = [[fileURL pathExtension] lowercaseString];
-  NSData *artworkData = nil;
-  
-  if ([extension isEqualToString:@"mp3"]) {
-    artworkData = [self extractArtworkFromMP3:filePath];
-  } else if ([extension isEqualToString:@"flac"]) {
-    artworkData = [self extractArtworkFromFLAC:filePath];
-  } else if ([extension isEqualToString:@"m4a"] || [extension isEqualToString:@"mp4"]) {
-    artworkData = [self extractArtworkFromM4A:filePath];
-  }
-  
-  if (artworkData) {
-    metadata[@"artwork"] = artworkData;
-    NSLog(@"TagLib: Extracted artwork (%lu bytes)", (unsigned long)artworkData.length);
+  // Only note that there is a picture, the import has no use for the bytes. `extractArtworkFromFileAtURL:` reads
+  // it once something wants to show it.
+  if (![self extractArtworkFromFile:file.file()].isEmpty()) {
+    metadata[@"hasEmbeddedArtwork"] = @YES;
   }
   
   return [self applyFilenameFallback:[metadata copy] audioURL:fileURL];
@@ -126,70 +121,100 @@
 
 #pragma mark - Artwork Metadata
 
-+ (NSData *)extractArtworkFromMP3:(const char *)filePath {
-  TagLib::MPEG::File mp3File(filePath);
++ (NSData *)extractArtworkFromFileAtURL:(NSURL *)fileURL {
+  TagLib::FileRef file([[fileURL path] UTF8String], false);
   
-  if (!mp3File.isValid() || !mp3File.ID3v2Tag()) {
+  if (file.isNull()) {
     return nil;
   }
   
-  TagLib::ID3v2::Tag *tag = mp3File.ID3v2Tag();
-  TagLib::ID3v2::FrameList frameList = tag->frameList("APIC");
+  TagLib::ByteVector pictureData = [self extractArtworkFromFile:file.file()];
   
-  if (frameList.isEmpty()) {
+  if (pictureData.isEmpty()) {
     return nil;
   }
   
-  TagLib::ID3v2::AttachedPictureFrame *frame =
-    static_cast<TagLib::ID3v2::AttachedPictureFrame *>(frameList.front());
-  
-  TagLib::ByteVector pictureData = frame->picture();
-  
   return [NSData dataWithBytes:pictureData.data() length:pictureData.size()];
 }
 
-+ (NSData *)extractArtworkFromFLAC:(const char *)filePath {
-  TagLib::FLAC::File flacFile(filePath);
+/// The picture bytes stay in TagLib's buffer, which is shared rather than copied when passed around.
++ (TagLib::ByteVector)extractArtworkFromFile:(TagLib::File *)file {
+  if (auto *mp3File = dynamic_cast<TagLib::MPEG::File *>(file)) {
+    return [self extractArtworkFromID3v2Tag:mp3File->ID3v2Tag()];
+  }
+  if (auto *flacFile = dynamic_cast<TagLib::FLAC::File *>(file)) {
+    TagLib::ByteVector pictureData = [self extractArtworkFromPictures:flacFile->pictureList()];
+    return pictureData.isEmpty() ? [self extractArtworkFromXiphComment:flacFile->xiphComment()] : pictureData;
+  }
+  if (auto *mp4File = dynamic_cast<TagLib::MP4::File *>(file)) {
+    return [self extractArtworkFromMP4Tag:mp4File->tag()];
+  }
+  if (auto *vorbisFile = dynamic_cast<TagLib::Ogg::Vorbis::File *>(file)) {
+    return [self extractArtworkFromXiphComment:vorbisFile->tag()];
+  }
+  if (auto *opusFile = dynamic_cast<TagLib::Ogg::Opus::File *>(file)) {
+    return [self extractArtworkFromXiphComment:opusFile->tag()];
+  }
+  if (auto *oggFlacFile = dynamic_cast<TagLib::Ogg::FLAC::File *>(file)) {
+    return [self extractArtworkFromXiphComment:oggFlacFile->tag()];
+  }
+  if (auto *wavFile = dynamic_cast<TagLib::RIFF::WAV::File *>(file)) {
+    return wavFile->hasID3v2Tag() ? [self extractArtworkFromID3v2Tag:wavFile->ID3v2Tag()] : TagLib::ByteVector();
+  }
+  if (auto *aiffFile = dynamic_cast<TagLib::RIFF::AIFF::File *>(file)) {
+    return aiffFile->hasID3v2Tag() ? [self extractArtworkFromID3v2Tag:aiffFile->tag()] : TagLib::ByteVector();
+  }
+  return TagLib::ByteVector();
+}
+
++ (TagLib::ByteVector)extractArtworkFromID3v2Tag:(TagLib::ID3v2::Tag *)tag {
+  if (!tag) {
+    return TagLib::ByteVector();
+  }
   
-  if (!flacFile.isValid()) {
-    return nil;
+  TagLib::ID3v2::FrameList frameList = tag->frameList("APIC");
+  
+  if (frameList.isEmpty()) {
+    return TagLib::ByteVector();
   }
   
-  const TagLib::List<TagLib::FLAC::Picture *> &picList = flacFile.pictureList();
+  TagLib::ID3v2::AttachedPictureFrame *frame =
+    static_cast<TagLib::ID3v2::AttachedPictureFrame *>(frameList.front());
   
+  return frame->picture();
+}
+
+/// FLAC picture blocks, also what Vorbis comments carry as METADATA_BLOCK_PICTURE.
++ (TagLib::ByteVector)extractArtworkFromPictures:(const TagLib::List<TagLib::FLAC::Picture *> &)picList {
   if (picList.isEmpty()) {
-    return nil;
+    return TagLib::ByteVector();
   }
   
   TagLib::FLAC::Picture *picture = picList.front();
-  TagLib::ByteVector pictureData = picture->data();
-  
-  return [NSData dataWithBytes:pictureData.data() length:pictureData.size()];
+  return picture->data();
 }
 
-+ (NSData *)extractArtworkFromM4A:(const char *)filePath {
-  TagLib::MP4::File mp4File(filePath);
-  
-  if (!mp4File.isValid() || !mp4File.tag()) {
-    return nil;
++ (TagLib::ByteVector)extractArtworkFromXiphComment:(TagLib::Ogg::XiphComment *)comment {
+  if (!comment) {
+    return TagLib::ByteVector();
   }
   
-  TagLib::MP4::Tag *tag = mp4File.tag();
-  
-  if (!tag->contains("covr")) {
-    return nil;
+  return [self extractArtworkFromPictures:comment->pictureList()];
+}
+
++ (TagLib::ByteVector)extractArtworkFromMP4Tag:(TagLib::MP4::Tag *)tag {
+  if (!tag || !tag->contains("covr")) {
+    return TagLib::ByteVector();
   }
   
   TagLib::MP4::CoverArtList coverList = tag->item("covr").toCoverArtList();
   
   if (coverList.isEmpty()) {
-    return nil;
+    return TagLib::ByteVector();
   }
   
   TagLib::MP4::CoverArt coverArt = coverList.front();
-  TagLib::ByteVector pictureData = coverArt.data();
-  
-  return [NSData dataWithBytes:pictureData.data() length:pictureData.size()];
+  return coverArt.data();
 }
 
 #pragma mark - Write
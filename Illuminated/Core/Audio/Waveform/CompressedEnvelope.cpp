@@ -0,0 +1,294 @@
+//
+//  CompressedEnvelope.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "CompressedEnvelope.h"
+#include "PeakFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace waveform {
+
+namespace {
+
+/// Frames that must follow a candidate header before it is trusted, guards against sync words inside tags or data.
+constexpr int kSyncConfirmations = 2;
+
+/// Global gain is a step size in quarter powers of two. These are the values for unity gain.
+constexpr int kMP3GainOffset = 210;
+constexpr int kAACGainOffset = 100;
+
+constexpr uint16_t kMP3Bitrates[2][16] = {
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0},
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},
+};
+constexpr uint32_t kMP3SampleRates[3] = {44100, 48000, 32000};
+constexpr uint32_t kAACSampleRates[13] = {96000, 88200, 64000, 48000, 44100, 32000, 24000,
+                                          22050, 16000, 12000, 11025, 8000,  7350};
+
+class BitReader {
+public:
+  BitReader(const uint8_t *data, size_t size) : _data(data), _size(size) {}
+
+  uint32_t read(int bits) {
+    uint32_t value = 0;
+    for (int i = 0; i < bits; i++) {
+      size_t byte = _position >> 3;
+      uint32_t bit = byte < _size ? (_data[byte] >> (7 - (_position & 7))) & 1 : 0;
+      value = (value << 1) | bit;
+      _position++;
+    }
+    return value;
+  }
+
+  void skip(size_t bits) {
+    _position += bits;
+  }
+
+  bool overrun() const {
+    return _position > _size * 8;
+  }
+
+private:
+  const uint8_t *_data;
+  size_t _size;
+  size_t _position = 0;
+};
+
+struct FrameHeader {
+  CompressedFormat format;
+  uint32_t sampleRate = 0;
+  uint32_t channels = 0;
+  uint32_t length = 0;
+  /// Fields that must stay the same from frame to frame within one stream.
+  uint32_t signature = 0;
+
+  // MP3
+  bool mpeg1 = false;
+  bool crc = false;
+
+  // ADTS
+  uint32_t headerLength = 0;
+  uint32_t blocks = 1;
+};
+
+bool parseMP3Header(const uint8_t *p, size_t available, FrameHeader &header) {
+  if (available < 4 || p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return false;
+
+  uint32_t version = (p[1] >> 3) & 3; // 0 MPEG-2.5, 2 MPEG-2, 3 MPEG-1
+  uint32_t layer = (p[1] >> 1) & 3;   // 1 Layer III
+  uint32_t bitrateIndex = p[2] >> 4;
+  uint32_t rateIndex = (p[2] >> 2) & 3;
+  if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) return false;
+
+  header.format = CompressedFormat::MP3;
+  header.mpeg1 = version == 3;
+  header.crc = (p[1] & 1) == 0;
+  header.sampleRate = kMP3SampleRates[rateIndex] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+  header.channels = (p[3] >> 6) == 3 ? 1 : 2;
+
+  uint32_t bitrate = kMP3Bitrates[header.mpeg1 ? 0 : 1][bitrateIndex] * 1000;
+  uint32_t padding = (p[2] >> 1) & 1;
+  header.length = (header.mpeg1 ? 144 : 72) * bitrate / header.sampleRate + padding;
+  header.signature = (p[1] << 8) | (p[2] & 0x0C) | (p[3] >> 6 == 3 ? 1 : 0);
+  return header.length > 4;
+}
+
+bool parseADTSHeader(const uint8_t *p, size_t available, FrameHeader &header) {
+  if (available < 7 || p[0] != 0xFF || (p[1] & 0xF6) != 0xF0) return false;
+
+  uint32_t rateIndex = (p[2] >> 2) & 0xF;
+  uint32_t channelConfig = ((p[2] & 1) << 2) | (p[3] >> 6);
+  if (rateIndex >= 13) return false;
+
+  header.format = CompressedFormat::ADTS;
+  header.crc = (p[1] & 1) == 0;
+  header.headerLength = header.crc ? 9 : 7;
+  header.sampleRate = kAACSampleRates[rateIndex];
+  header.channels = channelConfig == 7 ? 8 : std::max(channelConfig, 1u);
+  header.length = ((p[3] & 3) << 11) | (p[4] << 3) | (p[5] >> 5);
+  header.blocks = (p[6] & 3) + 1;
+  header.signature = (p[1] << 16) | ((p[2] & 0xFD) << 8) | (p[3] & 0xC0);
+  return header.length > header.headerLength;
+}
+
+bool parseHeader(const uint8_t *p, size_t available, FrameHeader &header) {
+  return parseMP3Header(p, available, header) || parseADTSHeader(p, available, header);
+}
+
+/// True if `kSyncConfirmations` frames of the same stream follow the one at `offset`, or the data ends cleanly. A
+/// stream cut off inside one of those frames counts as ending cleanly, the caller still drops the partial frame.
+bool confirmSync(const uint8_t *data, size_t size, size_t offset, const FrameHeader &first) {
+  FrameHeader header = first;
+  for (int i = 0; i < kSyncConfirmations; i++) {
+    offset += header.length;
+    if (offset >= size) return offset == size;
+
+    FrameHeader next;
+    if (!parseHeader(data + offset, size - offset, next) || next.signature != first.signature) return false;
+    if (next.length > size - offset) return true;
+    header = next;
+  }
+  return true;
+}
+
+size_t skipID3v2(const uint8_t *data, size_t size) {
+  size_t offset = 0;
+  while (size - offset >= 10 && std::memcmp(data + offset, "ID3", 3) == 0) {
+    const uint8_t *p = data + offset;
+    size_t length = ((p[6] & 0x7F) << 21) | ((p[7] & 0x7F) << 14) | ((p[8] & 0x7F) << 7) | (p[9] & 0x7F);
+    length += (p[5] & 0x10) ? 20 : 10;
+    if (length > size - offset) break;
+    offset += length;
+  }
+  return offset;
+}
+
+float gainToLevel(uint32_t globalGain, int offset) {
+  return std::exp2f(((int)globalGain - offset) * 0.25f);
+}
+
+/// Appends one level per granule, the loudest channel of each. A granule that spends no bits is silent.
+/// False for the Xing/Info frame, whose side information is empty.
+bool readMP3Frame(const uint8_t *frame, const FrameHeader &header, std::vector<float> &levels) {
+  size_t sideInfoOffset = 4 + (header.crc ? 2 : 0);
+  size_t sideInfoLength = header.mpeg1 ? (header.channels == 1 ? 17 : 32) : (header.channels == 1 ? 9 : 17);
+  if (sideInfoOffset + sideInfoLength > header.length) return false;
+
+  const uint8_t *tag = frame + sideInfoOffset + sideInfoLength;
+  if (sideInfoOffset + sideInfoLength + 4 <= header.length &&
+      (std::memcmp(tag, "Xing", 4) == 0 || std::memcmp(tag, "Info", 4) == 0)) {
+    return false;
+  }
+
+  BitReader bits(frame + sideInfoOffset, sideInfoLength);
+  int granules = header.mpeg1 ? 2 : 1;
+  if (header.mpeg1) {
+    bits.skip(9 + (header.channels == 1 ? 5 : 3) + 4 * header.channels);
+  } else {
+    bits.skip(8 + (header.channels == 1 ? 1 : 2));
+  }
+
+  for (int granule = 0; granule < granules; granule++) {
+    float level = 0.0f;
+    for (uint32_t channel = 0; channel < header.channels; channel++) {
+      uint32_t part23Length = bits.read(12);
+      bits.skip(9); // big_values
+      uint32_t globalGain = bits.read(8);
+      bits.skip(header.mpeg1 ? 4 : 9); // scalefac_compress
+      bool windowSwitching = bits.read(1);
+      bits.skip(windowSwitching ? 2 + 1 + 10 + 9 : 15 + 4 + 3);
+      bits.skip(header.mpeg1 ? 3 : 2);
+
+      if (part23Length > 0) {
+        level = std::max(level, gainToLevel(globalGain, kMP3GainOffset));
+      }
+    }
+    levels.push_back(level);
+  }
+  return true;
+}
+
+/// Reads the global gain of the first channel element in the first raw data block. Nothing for streams that
+/// open with some other element, or use AAC Main prediction.
+std::optional<uint32_t> readADTSGain(const uint8_t *frame, const FrameHeader &header) {
+  size_t offset = header.headerLength + (header.crc && header.blocks > 1 ? 2 * (header.blocks - 1) : 0);
+  if (offset >= header.length) return std::nullopt;
+
+  BitReader bits(frame + offset, header.length - offset);
+  uint32_t element = bits.read(3);
+  bits.skip(4); // element_instance_tag
+
+  if (element == 1 && bits.read(1)) { // channel pair with a shared ics_info
+    bits.skip(1);
+    uint32_t windowSequence = bits.read(2);
+    bits.skip(1);
+
+    uint32_t groups = 1;
+    uint32_t maxBands;
+    if (windowSequence == 2) {
+      maxBands = bits.read(4);
+      uint32_t grouping = bits.read(7);
+      for (int i = 0; i < 7; i++) {
+        groups += ((grouping >> i) & 1) == 0;
+      }
+    } else {
+      maxBands = bits.read(6);
+      if (bits.read(1)) return std::nullopt;
+    }
+
+    if (bits.read(2) == 1) {
+      bits.skip(groups * maxBands);
+    }
+  } else if (element != 0 && element != 1 && element != 3) {
+    return std::nullopt;
+  }
+
+  uint32_t globalGain = bits.read(8);
+  if (bits.overrun()) return std::nullopt;
+  return globalGain;
+}
+
+} // namespace
+
+std::optional<CompressedEnvelope> readCompressedEnvelope(const uint8_t *data, size_t size) {
+  if (!data) return std::nullopt;
+
+  CompressedEnvelope envelope;
+  std::optional<FrameHeader> stream;
+  size_t offset = skipID3v2(data, size);
+
+  while (offset + 4 <= size) {
+    FrameHeader header;
+    bool valid = parseHeader(data + offset, size - offset, header) && header.length <= size - offset;
+    if (valid && stream) {
+      valid = header.signature == stream->signature;
+    } else if (valid) {
+      valid = confirmSync(data, size, offset, header);
+    }
+    if (!valid) {
+      offset++;
+      continue;
+    }
+
+    if (!stream) {
+      stream = header;
+      envelope.format = header.format;
+      envelope.sampleRate = header.sampleRate;
+      envelope.channels = header.channels;
+      envelope.framesPerLevel = header.format == CompressedFormat::ADTS ? 1024 : 576;
+    }
+
+    const uint8_t *frame = data + offset;
+    if (header.format == CompressedFormat::MP3) {
+      readMP3Frame(frame, header, envelope.levels);
+    } else {
+      std::optional<uint32_t> gain = readADTSGain(frame, header);
+      float previous = envelope.levels.empty() ? 0.0f : envelope.levels.back();
+      float level = !gain ? previous : *gain == 0 ? 0.0f : gainToLevel(*gain, kAACGainOffset);
+      envelope.levels.insert(envelope.levels.end(), header.blocks, level);
+    }
+    offset += header.length;
+  }
+
+  if (envelope.levels.empty()) return std::nullopt;
+  return envelope;
+}
+
+std::vector<uint8_t> encodeEnvelopePeaks(const CompressedEnvelope &envelope) {
+  float loudest = *std::max_element(envelope.levels.begin(), envelope.levels.end());
+  float scale = loudest > 0.0f ? (float)M_SQRT1_2 / loudest : 0.0f;
+
+  PeakWriter writer(envelope.sampleRate, envelope.channels, framesPerBlockFor(envelope.frames()));
+  for (float level : envelope.levels) {
+    writer.appendLevel(level * scale, envelope.framesPerLevel);
+  }
+  return writer.finish();
+}
+
+} // namespace waveform
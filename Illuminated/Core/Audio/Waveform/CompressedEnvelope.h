@@ -0,0 +1,44 @@
+//
+//  CompressedEnvelope.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// Rough loudness envelopes read from compressed audio without decoding it. Every MP3 granule and AAC frame
+/// carries a global gain, the quantizer step the encoder picked for it, which follows the loudness of the music
+/// closely enough for a preview. Parsing headers is a few hundred times cheaper than decoding.
+namespace waveform {
+
+enum class CompressedFormat { MP3, ADTS };
+
+/// One entry per MP3 granule or AAC raw data block, in stream order.
+struct CompressedEnvelope {
+  CompressedFormat format = CompressedFormat::MP3;
+  uint32_t sampleRate = 0;
+  uint32_t channels = 0;
+  /// Frames each entry of `levels` covers, 576 for MP3 and 1024 for AAC.
+  uint32_t framesPerLevel = 0;
+  /// Relative amplitude, only meaningful against the other entries.
+  std::vector<float> levels;
+
+  uint64_t frames() const {
+    return (uint64_t)levels.size() * framesPerLevel;
+  }
+};
+
+/// Walks the frames of an MP3 (MPEG-1/2/2.5 Layer III) or ADTS AAC stream. ID3v2 tags and the Xing/Info frame are
+/// skipped, damaged stretches are resynced past. Nothing if no frames were found, or for free-format MP3.
+std::optional<CompressedEnvelope> readCompressedEnvelope(const uint8_t *data, size_t size);
+
+/// Encodes an envelope as a peak file (see `PeakFile.h`), scaled so the loudest entry is full scale.
+std::vector<uint8_t> encodeEnvelopePeaks(const CompressedEnvelope &envelope);
+
+} // namespace waveform
@@ -0,0 +1,42 @@
+//
+//  LittleEndian.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/// Byte-order helpers for the on-disk waveform formats, which are little endian whatever the host.
+namespace waveform {
+
+inline void put16(uint8_t *p, uint16_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+}
+
+inline void put32(uint8_t *p, uint32_t value) {
+  put16(p, (uint16_t)value);
+  put16(p + 2, (uint16_t)(value >> 16));
+}
+
+inline void put64(uint8_t *p, uint64_t value) {
+  put32(p, (uint32_t)value);
+  put32(p + 4, (uint32_t)(value >> 32));
+}
+
+inline uint16_t get16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t get32(const uint8_t *p) {
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+inline uint64_t get64(const uint8_t *p) {
+  return get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+
+} // namespace waveform
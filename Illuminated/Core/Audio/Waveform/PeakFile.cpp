@@ -0,0 +1,252 @@
+//
+//  PeakFile.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "PeakFile.h"
+#include "LittleEndian.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace waveform {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'I', 'P', 'K', 'F'};
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kLevelEntrySize = 16;
+constexpr size_t kBlockSize = 6;
+
+int16_t quantizeSigned(float value) {
+  return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+uint16_t quantizeUnsigned(float value) {
+  return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+Peak merge(std::span<const Peak> peaks) {
+  Peak merged = peaks.front();
+  double sumSquares = 0.0;
+  for (const Peak &peak : peaks) {
+    merged.min = std::min(merged.min, peak.min);
+    merged.max = std::max(merged.max, peak.max);
+    sumSquares += (double)peak.rms * peak.rms;
+  }
+  merged.rms = (float)std::sqrt(sumSquares / peaks.size());
+  return merged;
+}
+
+} // namespace
+
+uint32_t framesPerBlockFor(uint64_t expectedFrames) {
+  uint32_t framesPerBlock = 64;
+  while ((uint64_t)framesPerBlock * kMaxBaseBlocks < expectedFrames && framesPerBlock < (1u << 24)) {
+    framesPerBlock *= 2;
+  }
+  return framesPerBlock;
+}
+
+PeakWriter::PeakWriter(double sampleRate, uint32_t channels, uint32_t framesPerBlock)
+    : _sampleRate((uint32_t)std::lround(sampleRate)), _channels(std::max(channels, 1u)),
+      _framesPerBlock(std::max(framesPerBlock, 1u)), _blockSamples((size_t)_framesPerBlock * _channels) {}
+
+void PeakWriter::append(std::span<const int16_t> samples) {
+  appendSamples(samples);
+}
+
+void PeakWriter::append(std::span<const float> samples) {
+  appendSamples(samples);
+}
+
+void PeakWriter::appendLevel(float rms, uint64_t frames) {
+  SampleStats level;
+  level.max = std::min(rms * (float)M_SQRT2, 1.0f);
+  level.min = -level.max;
+
+  uint64_t samples = frames * _channels;
+  while (samples > 0) {
+    size_t count = (size_t)std::min<uint64_t>(samples, _blockSamples - _inBlock);
+    level.sumSquares = (double)rms * rms * count;
+    _block.merge(level);
+    _inBlock += count;
+    _samples += count;
+    samples -= count;
+
+    if (_inBlock == _blockSamples) {
+      closeBlock();
+    }
+  }
+}
+
+/// Block boundaries are handled here, so the kernel always sees the longest run that stays inside one block.
+template <typename Sample> void PeakWriter::appendSamples(std::span<const Sample> samples) {
+  while (!samples.empty()) {
+    size_t count = std::min(samples.size(), _blockSamples - _inBlock);
+    _block.merge(measure(samples.first(count)));
+    _inBlock += count;
+    _samples += count;
+    samples = samples.subspan(count);
+
+    if (_inBlock == _blockSamples) {
+      closeBlock();
+    }
+  }
+}
+
+void PeakWriter::closeBlock() {
+  _base.push_back({_block.min, _block.max, (float)std::sqrt(_block.sumSquares / _inBlock)});
+  _block = SampleStats();
+  _inBlock = 0;
+}
+
+void PeakWriter::appendSegment(PeakWriter &&next) {
+  if (_inBlock > 0) {
+    closeBlock();
+  }
+
+  _base.insert(_base.end(), next._base.begin(), next._base.end());
+  _block = next._block;
+  _inBlock = next._inBlock;
+  _samples += next._samples;
+  next._base.clear();
+}
+
+std::vector<uint8_t> PeakWriter::finish() {
+  if (_inBlock > 0) {
+    closeBlock();
+  }
+
+  std::vector<uint8_t> data = encode(std::move(_base), frames());
+  _base.clear();
+  return data;
+}
+
+std::vector<uint8_t> PeakWriter::snapshot() const {
+  return encode(_base, completedFrames());
+}
+
+std::vector<uint8_t> PeakWriter::encode(std::vector<Peak> base, uint64_t frames) const {
+  // A level without blocks is not a peak file, `PeakReader` would turn it down
+  if (base.empty()) {
+    return {};
+  }
+
+  std::vector<std::vector<Peak>> levels;
+  levels.push_back(std::move(base));
+  while (levels.back().size() > kMinLevelBlocks) {
+    const std::vector<Peak> &finer = levels.back();
+    std::vector<Peak> coarser;
+    coarser.reserve((finer.size() + kLevelFactor - 1) / kLevelFactor);
+    for (size_t i = 0; i < finer.size(); i += kLevelFactor) {
+      size_t count = std::min<size_t>(kLevelFactor, finer.size() - i);
+      coarser.push_back(merge(std::span<const Peak>(finer).subspan(i, count)));
+    }
+    levels.push_back(std::move(coarser));
+  }
+
+  size_t size = kHeaderSize + kLevelEntrySize * levels.size();
+  for (const std::vector<Peak> &level : levels) {
+    size += kBlockSize * level.size();
+  }
+
+  std::vector<uint8_t> data(size, 0);
+  std::memcpy(data.data(), kMagic, sizeof(kMagic));
+  put16(&data[4], kPeakFileVersion);
+  put16(&data[6], (uint16_t)levels.size());
+  put32(&data[8], _sampleRate);
+  put16(&data[12], (uint16_t)_channels);
+  put64(&data[16], frames);
+
+  size_t offset = kHeaderSize + kLevelEntrySize * levels.size();
+  uint32_t framesPerBlock = _framesPerBlock;
+  for (size_t i = 0; i < levels.size(); i++) {
+    uint8_t *entry = &data[kHeaderSize + kLevelEntrySize * i];
+    put32(entry, framesPerBlock);
+    put32(entry + 4, (uint32_t)levels[i].size());
+    put64(entry + 8, offset);
+
+    for (const Peak &peak : levels[i]) {
+      put16(&data[offset], (uint16_t)quantizeSigned(peak.min));
+      put16(&data[offset + 2], (uint16_t)quantizeSigned(peak.max));
+      put16(&data[offset + 4], quantizeUnsigned(peak.rms));
+      offset += kBlockSize;
+    }
+    framesPerBlock *= kLevelFactor;
+  }
+
+  return data;
+}
+
+bool PeakReader::open(const uint8_t *data, size_t size) {
+  _levels.clear();
+  if (!data || size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+      get16(data + 4) != kPeakFileVersion) {
+    return false;
+  }
+
+  size_t levelCount = get16(data + 6);
+  if (levelCount == 0 || size < kHeaderSize + kLevelEntrySize * levelCount) {
+    return false;
+  }
+
+  std::vector<Level> levels;
+  levels.reserve(levelCount);
+  for (size_t i = 0; i < levelCount; i++) {
+    const uint8_t *entry = data + kHeaderSize + kLevelEntrySize * i;
+    uint32_t blockCount = get32(entry + 4);
+    uint64_t offset = get64(entry + 8);
+    if (blockCount == 0 || offset > size || (size - offset) / kBlockSize < blockCount) {
+      return false;
+    }
+    levels.push_back({get32(entry), blockCount, data + offset});
+  }
+
+  _sampleRate = get32(data + 8);
+  _frames = get64(data + 16);
+  _levels = std::move(levels);
+  return true;
+}
+
+Peak PeakReader::peak(const Level &level, size_t index) const {
+  const uint8_t *block = level.blocks + kBlockSize * index;
+  return {(int16_t)get16(block) / 32767.0f, (int16_t)get16(block + 2) / 32767.0f, get16(block + 4) / 65535.0f};
+}
+
+void PeakReader::render(std::span<Peak> columns) const {
+  if (columns.empty()) {
+    return;
+  }
+  if (_levels.empty()) {
+    std::fill(columns.begin(), columns.end(), Peak());
+    return;
+  }
+
+  // Levels go from fine to coarse. Several blocks per column keep the column edges close to where they belong,
+  // so stop at the last level that still has `kLevelFactor` of them
+  const Level *source = &_levels.front();
+  for (const Level &level : _levels) {
+    if (level.blockCount < columns.size() * kLevelFactor) break;
+    source = &level;
+  }
+
+  size_t width = columns.size();
+  size_t blocks = source->blockCount;
+  std::vector<Peak> span;
+  for (size_t column = 0; column < width; column++) {
+    size_t first = column * blocks / width;
+    size_t last = std::max((column + 1) * blocks / width, first + 1);
+
+    span.clear();
+    for (size_t index = first; index < last; index++) {
+      span.push_back(peak(*source, index));
+    }
+    columns[column] = merge(span);
+  }
+}
+
+} // namespace waveform
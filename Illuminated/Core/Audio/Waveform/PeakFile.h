@@ -0,0 +1,135 @@
+//
+//  PeakFile.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include "PeakKernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// Compact waveform overviews: min/max/RMS per block of audio at several zoom levels, like a mipmap, so any
+/// width can be drawn from the nearest level without decoding again. Plain C++ with no Foundation dependency.
+///
+/// Layout, all little endian:
+///   header  magic "IPKF", u16 version, u16 level count, u32 sample rate, u16 channels, u16 reserved,
+///           u64 frames
+///   levels  u32 frames per block, u32 block count, u64 byte offset of the blocks, finest level first
+///   blocks  i16 min, i16 max, u16 RMS
+namespace waveform {
+
+constexpr uint16_t kPeakFileVersion = 1;
+/// Each level merges this many blocks of the one below.
+constexpr uint32_t kLevelFactor = 4;
+/// Finest level size cap, keeps files around 64 KiB however long the track is.
+constexpr uint64_t kMaxBaseBlocks = 8192;
+/// Levels stop once they are this coarse.
+constexpr uint32_t kMinLevelBlocks = 64;
+
+struct Peak {
+  float min = 0.0f;
+  float max = 0.0f;
+  float rms = 0.0f;
+};
+
+/// Block size for the finest level so that `expectedFrames` fits in `kMaxBaseBlocks`, a power of two.
+uint32_t framesPerBlockFor(uint64_t expectedFrames);
+
+/// Builds a peak file from interleaved PCM delivered in arbitrary chunks. Channels are not split, a block covers
+/// every sample of its frames.
+class PeakWriter {
+public:
+  PeakWriter(double sampleRate, uint32_t channels, uint32_t framesPerBlock);
+
+  void append(std::span<const int16_t> samples);
+  void append(std::span<const float> samples);
+
+  /// Stands in for `frames` frames at a known RMS when there are no samples, e.g. a loudness estimate. Peaks are
+  /// taken to be those of a sine at that level.
+  void appendLevel(float rms, uint64_t frames);
+
+  uint64_t frames() const {
+    return _samples / _channels;
+  }
+
+  /// Continues with a writer that picked up where this one stops, like the next segment of a track decoded in
+  /// parallel. A partial block here is closed first. Both need the same block size and channel count.
+  void appendSegment(PeakWriter &&next);
+
+  /// Frames covered by `snapshot()`, i.e. every closed block.
+  uint64_t completedFrames() const {
+    return (uint64_t)_base.size() * _framesPerBlock;
+  }
+
+  /// Encodes the blocks closed so far as a complete file, for drawing while decoding continues. Empty until the
+  /// first block is closed.
+  std::vector<uint8_t> snapshot() const;
+
+  /// Closes the last partial block, builds the coarser levels and returns the encoded file. Empty if nothing was
+  /// appended.
+  std::vector<uint8_t> finish();
+
+private:
+  std::vector<uint8_t> encode(std::vector<Peak> base, uint64_t frames) const;
+  template <typename Sample> void appendSamples(std::span<const Sample> samples);
+  void closeBlock();
+
+  uint32_t _sampleRate;
+  uint32_t _channels;
+  uint32_t _framesPerBlock;
+  size_t _blockSamples;
+
+  uint64_t _samples = 0;
+  size_t _inBlock = 0;
+  SampleStats _block;
+
+  std::vector<Peak> _base;
+};
+
+/// Reads an encoded peak file in place. The bytes are borrowed and must outlive the reader.
+class PeakReader {
+public:
+  struct Level {
+    uint32_t framesPerBlock = 0;
+    uint32_t blockCount = 0;
+    const uint8_t *blocks = nullptr;
+  };
+
+  /// Validates the header and level table against `size`. False for anything that is not a peak file.
+  bool open(const uint8_t *data, size_t size);
+
+  uint32_t sampleRate() const {
+    return _sampleRate;
+  }
+
+  uint64_t frames() const {
+    return _frames;
+  }
+
+  size_t levelCount() const {
+    return _levels.size();
+  }
+
+  const Level &level(size_t index) const {
+    return _levels[index];
+  }
+
+  Peak peak(const Level &level, size_t index) const;
+
+  /// One peak per column. Uses the coarsest level that still has a few blocks for every column and merges them,
+  /// repeating blocks when the width exceeds the finest level.
+  void render(std::span<Peak> columns) const;
+
+private:
+  uint32_t _sampleRate = 0;
+  uint64_t _frames = 0;
+  std::vector<Level> _levels;
+};
+
+} // namespace waveform
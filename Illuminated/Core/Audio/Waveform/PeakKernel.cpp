@@ -0,0 +1,311 @@
+//
+//  PeakKernel.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "PeakKernel.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PEAK_KERNEL_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PEAK_KERNEL_NEON 1
+#endif
+
+namespace waveform {
+
+namespace {
+
+/// Float squares are summed in float lanes for this many samples before moving to the double total.
+constexpr size_t kFloatStretch = 1024;
+
+/// Converts integer results to the [-1, 1) scale. Squares are exact in 64 bits, so every kernel agrees.
+SampleStats fromIntegers(int32_t min, int32_t max, uint64_t sumSquares, size_t count) {
+  SampleStats stats;
+  if (count == 0) {
+    return stats;
+  }
+  stats.min = min / 32768.0f;
+  stats.max = max / 32768.0f;
+  stats.sumSquares = (double)sumSquares / (32768.0 * 32768.0);
+  return stats;
+}
+
+/// Integer accumulation for the tails of the SIMD kernels.
+void accumulateScalar(std::span<const int16_t> samples, int32_t &min, int32_t &max, uint64_t &sumSquares) {
+  for (int16_t sample : samples) {
+    min = std::min<int32_t>(min, sample);
+    max = std::max<int32_t>(max, sample);
+    sumSquares += (uint64_t)((int32_t)sample * sample);
+  }
+}
+
+void accumulateScalar(std::span<const float> samples, SampleStats &stats) {
+  for (float sample : samples) {
+    stats.min = std::min(stats.min, sample);
+    stats.max = std::max(stats.max, sample);
+    stats.sumSquares += (double)sample * sample;
+  }
+}
+
+#if PEAK_KERNEL_X86
+
+// madd of two int16 squares can reach 2^31, which only fits when read as unsigned. Zero-extending into 64-bit
+// lanes keeps it that way.
+
+__attribute__((target("avx2"))) SampleStats measureAVX2(std::span<const int16_t> samples) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i min = _mm256_set1_epi16(INT16_MAX);
+  __m256i max = _mm256_set1_epi16(INT16_MIN);
+  __m256i sum = zero;
+
+  size_t i = 0;
+  for (; i + 16 <= samples.size(); i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(samples.data() + i));
+    min = _mm256_min_epi16(min, x);
+    max = _mm256_max_epi16(max, x);
+    __m256i squares = _mm256_madd_epi16(x, x);
+    sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(squares, zero));
+    sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(squares, zero));
+  }
+
+  alignas(32) int16_t mins[16];
+  alignas(32) int16_t maxs[16];
+  alignas(32) uint64_t sums[4];
+  _mm256_store_si256((__m256i *)mins, min);
+  _mm256_store_si256((__m256i *)maxs, max);
+  _mm256_store_si256((__m256i *)sums, sum);
+
+  int32_t lowest = *std::min_element(mins, mins + 16);
+  int32_t highest = *std::max_element(maxs, maxs + 16);
+  uint64_t sumSquares = sums[0] + sums[1] + sums[2] + sums[3];
+  accumulateScalar(samples.subspan(i), lowest, highest, sumSquares);
+  return fromIntegers(lowest, highest, sumSquares, samples.size());
+}
+
+__attribute__((target("avx2"))) SampleStats measureAVX2(std::span<const float> samples) {
+  SampleStats stats;
+  __m256 min = _mm256_set1_ps(stats.min);
+  __m256 max = _mm256_set1_ps(stats.max);
+
+  size_t i = 0;
+  while (i + 8 <= samples.size()) {
+    size_t end = std::min(samples.size() - (samples.size() - i) % 8, i + kFloatStretch);
+    __m256 sum = _mm256_setzero_ps();
+    for (; i < end; i += 8) {
+      __m256 x = _mm256_loadu_ps(samples.data() + i);
+      min = _mm256_min_ps(min, x);
+      max = _mm256_max_ps(max, x);
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+    }
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, sum);
+    for (float lane : lanes) {
+      stats.sumSquares += lane;
+    }
+  }
+
+  alignas(32) float mins[8];
+  alignas(32) float maxs[8];
+  _mm256_store_ps(mins, min);
+  _mm256_store_ps(maxs, max);
+  stats.min = *std::min_element(mins, mins + 8);
+  stats.max = *std::max_element(maxs, maxs + 8);
+  accumulateScalar(samples.subspan(i), stats);
+  return stats;
+}
+
+__attribute__((target("sse2"))) SampleStats measureSSE2(std::span<const int16_t> samples) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i min = _mm_set1_epi16(INT16_MAX);
+  __m128i max = _mm_set1_epi16(INT16_MIN);
+  __m128i sum = zero;
+
+  size_t i = 0;
+  for (; i + 8 <= samples.size(); i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(samples.data() + i));
+    min = _mm_min_epi16(min, x);
+    max = _mm_max_epi16(max, x);
+    __m128i squares = _mm_madd_epi16(x, x);
+    sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+  }
+
+  alignas(16) int16_t mins[8];
+  alignas(16) int16_t maxs[8];
+  alignas(16) uint64_t sums[2];
+  _mm_store_si128((__m128i *)mins, min);
+  _mm_store_si128((__m128i *)maxs, max);
+  _mm_store_si128((__m128i *)sums, sum);
+
+  int32_t lowest = *std::min_element(mins, mins + 8);
+  int32_t highest = *std::max_element(maxs, maxs + 8);
+  uint64_t sumSquares = sums[0] + sums[1];
+  accumulateScalar(samples.subspan(i), lowest, highest, sumSquares);
+  return fromIntegers(lowest, highest, sumSquares, samples.size());
+}
+
+__attribute__((target("sse2"))) SampleStats measureSSE2(std::span<const float> samples) {
+  SampleStats stats;
+  __m128 min = _mm_set1_ps(stats.min);
+  __m128 max = _mm_set1_ps(stats.max);
+
+  size_t i = 0;
+  while (i + 4 <= samples.size()) {
+    size_t end = std::min(samples.size() - (samples.size() - i) % 4, i + kFloatStretch);
+    __m128 sum = _mm_setzero_ps();
+    for (; i < end; i += 4) {
+      __m128 x = _mm_loadu_ps(samples.data() + i);
+      min = _mm_min_ps(min, x);
+      max = _mm_max_ps(max, x);
+      sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+    }
+
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, sum);
+    for (float lane : lanes) {
+      stats.sumSquares += lane;
+    }
+  }
+
+  alignas(16) float mins[4];
+  alignas(16) float maxs[4];
+  _mm_store_ps(mins, min);
+  _mm_store_ps(maxs, max);
+  stats.min = *std::min_element(mins, mins + 4);
+  stats.max = *std::max_element(maxs, maxs + 4);
+  accumulateScalar(samples.subspan(i), stats);
+  return stats;
+}
+
+#elif PEAK_KERNEL_NEON
+
+SampleStats measureNEON(std::span<const int16_t> samples) {
+  int16x8_t min = vdupq_n_s16(INT16_MAX);
+  int16x8_t max = vdupq_n_s16(INT16_MIN);
+  int64x2_t sum = vdupq_n_s64(0);
+
+  size_t i = 0;
+  for (; i + 8 <= samples.size(); i += 8) {
+    int16x8_t x = vld1q_s16(samples.data() + i);
+    min = vminq_s16(min, x);
+    max = vmaxq_s16(max, x);
+    // A single int16 square fits in int32, pairs are widened straight into the 64-bit lanes
+    sum = vpadalq_s32(sum, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+    sum = vpadalq_s32(sum, vmull_high_s16(x, x));
+  }
+
+  int32_t lowest = vminvq_s16(min);
+  int32_t highest = vmaxvq_s16(max);
+  uint64_t sumSquares = (uint64_t)vaddvq_s64(sum);
+  accumulateScalar(samples.subspan(i), lowest, highest, sumSquares);
+  return fromIntegers(lowest, highest, sumSquares, samples.size());
+}
+
+SampleStats measureNEON(std::span<const float> samples) {
+  SampleStats stats;
+  float32x4_t min = vdupq_n_f32(stats.min);
+  float32x4_t max = vdupq_n_f32(stats.max);
+
+  size_t i = 0;
+  while (i + 4 <= samples.size()) {
+    size_t end = std::min(samples.size() - (samples.size() - i) % 4, i + kFloatStretch);
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (; i < end; i += 4) {
+      float32x4_t x = vld1q_f32(samples.data() + i);
+      min = vminq_f32(min, x);
+      max = vmaxq_f32(max, x);
+      sum = vaddq_f32(sum, vmulq_f32(x, x));
+    }
+    stats.sumSquares += vaddvq_f32(sum);
+  }
+
+  stats.min = vminvq_f32(min);
+  stats.max = vmaxvq_f32(max);
+  accumulateScalar(samples.subspan(i), stats);
+  return stats;
+}
+
+#endif
+
+enum class Kernel { Scalar, SSE2, AVX2, NEON };
+
+Kernel detectKernel() {
+#if PEAK_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Kernel::AVX2;
+  if (__builtin_cpu_supports("sse2")) return Kernel::SSE2;
+  return Kernel::Scalar;
+#elif PEAK_KERNEL_NEON
+  return Kernel::NEON;
+#else
+  return Kernel::Scalar;
+#endif
+}
+
+Kernel activeKernel() {
+  static const Kernel kernel = detectKernel();
+  return kernel;
+}
+
+template <typename Sample> SampleStats dispatch(std::span<const Sample> samples) {
+  switch (activeKernel()) {
+#if PEAK_KERNEL_X86
+  case Kernel::AVX2:
+    return measureAVX2(samples);
+  case Kernel::SSE2:
+    return measureSSE2(samples);
+#elif PEAK_KERNEL_NEON
+  case Kernel::NEON:
+    return measureNEON(samples);
+#endif
+  default:
+    return measureScalar(samples);
+  }
+}
+
+} // namespace
+
+SampleStats measure(std::span<const int16_t> samples) {
+  return dispatch(samples);
+}
+
+SampleStats measure(std::span<const float> samples) {
+  return dispatch(samples);
+}
+
+SampleStats measureScalar(std::span<const int16_t> samples) {
+  int32_t min = INT16_MAX;
+  int32_t max = INT16_MIN;
+  uint64_t sumSquares = 0;
+  accumulateScalar(samples, min, max, sumSquares);
+  return fromIntegers(min, max, sumSquares, samples.size());
+}
+
+SampleStats measureScalar(std::span<const float> samples) {
+  SampleStats stats;
+  accumulateScalar(samples, stats);
+  return stats;
+}
+
+const char *peakKernelName() {
+  switch (activeKernel()) {
+  case Kernel::AVX2:
+    return "avx2";
+  case Kernel::SSE2:
+    return "sse2";
+  case Kernel::NEON:
+    return "neon";
+  default:
+    return "scalar";
+  }
+}
+
+} // namespace waveform
@@ -0,0 +1,42 @@
+//
+//  PeakKernel.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace waveform {
+
+/// Min, max and sum of squares of a run of samples, int16 input scaled to [-1, 1) like the decoder output.
+struct SampleStats {
+  float min = std::numeric_limits<float>::infinity();
+  float max = -std::numeric_limits<float>::infinity();
+  double sumSquares = 0.0;
+
+  void merge(const SampleStats &other) {
+    min = other.min < min ? other.min : min;
+    max = other.max > max ? other.max : max;
+    sumSquares += other.sumSquares;
+  }
+};
+
+/// Measures a whole run at once with SIMD (AVX2 / SSE2 / NEON, picked at runtime). The int16 variant works in
+/// integers and matches `measureScalar` exactly, the float variant sums squares in float lanes per short stretch
+/// and only differs by rounding.
+SampleStats measure(std::span<const int16_t> samples);
+SampleStats measure(std::span<const float> samples);
+
+/// Reference implementations, one sample at a time.
+SampleStats measureScalar(std::span<const int16_t> samples);
+SampleStats measureScalar(std::span<const float> samples);
+
+/// Name of the kernel `measure` dispatches to on this machine.
+const char *peakKernelName();
+
+} // namespace waveform
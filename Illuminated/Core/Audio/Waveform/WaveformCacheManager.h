@@ -10,11 +10,21 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Waveforms are peak files from `WaveformGenerator`, all packed into one memory-mapped store and keyed by a
+/// content fingerprint, or by the track UUID when there is none. `Track.waveformPath` holds that key.
 @interface WaveformCacheManager : NSObject
 
-+ (NSString *)saveWaveformImage:(NSImage *)image forTrackUUID:(NSUUID *)uuid;
-+ (NSImage *)loadWaveformForPath:(NSString *)path;
-+ (void)removeWaveformForPath:(NSString *)path;
+/// Returns the key the peaks were stored under.
++ (nullable NSString *)savePeaks:(NSData *)peaks forTrackUUID:(NSUUID *)uuid;
+/// Content-keyed waveforms are shared between tracks and outlive them.
++ (nullable NSString *)savePeaks:(NSData *)peaks forFingerprint:(NSString *)fingerprint;
++ (BOOL)hasPeaksForKey:(nullable NSString *)key;
++ (BOOL)isWaveformKey:(NSString *)key ownedByTrackUUID:(NSUUID *)uuid;
+/// Zero-copy view into the store, nil if missing or not a peak file.
++ (nullable NSData *)loadPeaksForKey:(nullable NSString *)key;
++ (void)removePeaksForKey:(nullable NSString *)key;
+/// Commits pending writes to disk, call before quitting.
++ (void)synchronize;
 
 @end
 
@@ -0,0 +1,127 @@
+//
+//  WaveformCacheManager.mm
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 08.02.2026.
+//
+
+#import "WaveformCacheManager.h"
+
+#include "PeakFile.h"
+#include "WaveformStore.h"
+
+NSString *const kLegacyImageExtension = @"png";
+NSString *const kLegacyPeakFileExtension = @"peaks";
+
+@implementation WaveformCacheManager
+
++ (NSString *)waveformDirectory {
+  static NSString *waveformDir = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
+    NSString *appSupport = [paths firstObject];
+    waveformDir = [appSupport stringByAppendingPathComponent:@"Illuminated/Waveforms"];
+
+    [[NSFileManager defaultManager] createDirectoryAtPath:waveformDir
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
+
+    [self removeLegacyFilesInDirectory:waveformDir];
+  });
+  return waveformDir;
+}
+
+/// Opened once, then shared by every thread. Dead records are compacted in the background right after launch,
+/// without holding up lookups made meanwhile.
++ (waveform::WaveformStore *)store {
+  static waveform::WaveformStore *store = nullptr;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    store = new waveform::WaveformStore([self waveformDirectory].fileSystemRepresentation);
+    if (!store->open()) {
+      NSLog(@"WaveformCacheManager: Failed to open the waveform store");
+      return;
+    }
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+      if (store->compactIfNeeded()) {
+        NSLog(@"WaveformCacheManager: Compacted the waveform store, %lu entries",
+              (unsigned long)store->stats().entries);
+      }
+    });
+  });
+  return store;
+}
+
+/// Rendered PNGs and single peak files from before the packed store are never read again.
++ (void)removeLegacyFilesInDirectory:(NSString *)directory {
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSString *filename in [fileManager contentsOfDirectoryAtPath:directory error:nil]) {
+      if ([filename.pathExtension isEqualToString:kLegacyImageExtension] ||
+          [filename.pathExtension isEqualToString:kLegacyPeakFileExtension]) {
+        [fileManager removeItemAtPath:[directory stringByAppendingPathComponent:filename] error:nil];
+      }
+    }
+  });
+}
+
++ (NSString *)savePeaks:(NSData *)peaks forTrackUUID:(NSUUID *)uuid {
+  if (!uuid) return nil;
+  return [self savePeaks:peaks key:uuid.UUIDString];
+}
+
++ (NSString *)savePeaks:(NSData *)peaks forFingerprint:(NSString *)fingerprint {
+  if (!fingerprint) return nil;
+  return [self savePeaks:peaks key:fingerprint];
+}
+
++ (NSString *)savePeaks:(NSData *)peaks key:(NSString *)key {
+  waveform::WaveformStore *store = [self store];
+  if (!peaks || !store) return nil;
+
+  std::span<const uint8_t> bytes((const uint8_t *)peaks.bytes, peaks.length);
+  return store->put(key.UTF8String, bytes) ? key : nil;
+}
+
++ (BOOL)hasPeaksForKey:(NSString *)key {
+  waveform::WaveformStore *store = [self store];
+  return key && store && store->contains(key.UTF8String);
+}
+
++ (BOOL)isWaveformKey:(NSString *)key ownedByTrackUUID:(NSUUID *)uuid {
+  return [key isEqualToString:uuid.UUIDString];
+}
+
++ (NSData *)loadPeaksForKey:(NSString *)key {
+  waveform::WaveformStore *store = [self store];
+  if (!key || !store) return nil;
+
+  waveform::WaveformStore::Blob blob = store->find(key.UTF8String);
+  waveform::PeakReader reader;
+  if (!blob || !reader.open(blob.bytes.data(), blob.bytes.size())) return nil;
+
+  // The data points straight into the mapping and keeps it alive until released
+  std::shared_ptr<const void> owner = blob.owner;
+  return [[NSData alloc] initWithBytesNoCopy:(void *)blob.bytes.data()
+                                      length:blob.bytes.size()
+                                 deallocator:^(void *bytes, NSUInteger length) { (void)owner; }];
+}
+
++ (void)removePeaksForKey:(NSString *)key {
+  waveform::WaveformStore *store = [self store];
+  if (key && store) {
+    store->remove(key.UTF8String);
+  }
+}
+
++ (void)synchronize {
+  waveform::WaveformStore *store = [self store];
+  if (store) {
+    store->flush();
+  }
+}
+
+@end
@@ -13,9 +13,28 @@ NS_ASSUME_NONNULL_BEGIN
 @class Track;
 @class BFTask<__covariant ResultType>;
 
+/// Peaks decoded so far, covering `fraction` of the track from the start. Called on the main queue.
+typedef void (^WaveformProgressBlock)(NSData *partialPeaks, double fraction);
+
 @interface WaveformGenerator : NSObject
 
-+ (BFTask<NSImage *> *)generateWaveformForTrack:(Track *)track url:(NSURL *)url size:(CGSize)size;
+/// Decodes the whole file once into an encoded peak file (see `PeakFile.h`) that can be drawn at any width.
+/// `progress` gets a few partial peak files per second along the way. For MP3 and AAC streams it instead gets a
+/// single estimate of the whole track read from frame headers, see `estimatePeaksForURL:`.
++ (BFTask<NSData *> *)generatePeaksForTrack:(Track *)track
+                                        url:(NSURL *)url
+                                   progress:(nullable WaveformProgressBlock)progress;
+
+/// Approximate peaks from the global gain of every compressed frame, without decoding. Takes milliseconds where a
+/// decode takes seconds. Nil for anything but raw MP3 and ADTS AAC.
++ (nullable NSData *)estimatePeaksForURL:(NSURL *)url;
+
+/// Rasterizes one bar per device pixel, `scale` being the backing scale factor. The left `playedFraction` of the
+/// width is drawn in the played color. Nil if `peaks` is not a valid peak file.
++ (nullable NSImage *)renderWaveformFromPeaks:(NSData *)peaks
+                                         size:(CGSize)size
+                                        scale:(CGFloat)scale
+                               playedFraction:(double)playedFraction;
 
 @end
 
@@ -0,0 +1,461 @@
+//
+//  WaveformGenerator.mm
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 08.02.2026.
+//
+
+#import "WaveformGenerator.h"
+#import "BFExecutor.h"
+#import "BFTask.h"
+#import "Track.h"
+#import <AVFoundation/AVFoundation.h>
+#import <Accelerate/Accelerate.h>
+
+#include "CompressedEnvelope.h"
+#include "PeakFile.h"
+#include "WaveformRaster.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// Partial peaks are published at most this often while decoding.
+static const CFTimeInterval kProgressInterval = 0.25;
+
+static const Float64 kMinSegmentSeconds = 120.0;
+static const NSUInteger kMaxSegments = 8;
+
+/// Shared by the readers of a segmented decode, guarded by `mutex`.
+struct SegmentState {
+  std::mutex mutex;
+  std::vector<std::optional<waveform::PeakWriter>> writers;
+  uint64_t expectedFrames = 0;
+  size_t published = 0;
+};
+
+/// Feeds interleaved int16 PCM into the peak writer, walking every segment of the block buffer.
+static void AppendSampleBuffer(CMSampleBufferRef buffer, waveform::PeakWriter &writer) {
+  CMBlockBufferRef blockBuffer = CMSampleBufferGetDataBuffer(buffer);
+  if (!blockBuffer) return;
+
+  size_t length = CMBlockBufferGetDataLength(blockBuffer);
+  size_t offset = 0;
+  while (offset < length) {
+    size_t segmentLength = 0;
+    char *dataPointer = NULL;
+    if (CMBlockBufferGetDataPointer(blockBuffer, offset, &segmentLength, NULL, &dataPointer) != kCMBlockBufferNoErr ||
+        segmentLength == 0) {
+      break;
+    }
+
+    writer.append(std::span<const int16_t>((const int16_t *)dataPointer, segmentLength / sizeof(int16_t)));
+    offset += segmentLength;
+  }
+}
+
+/// Straight sRGB components of `color` for the rasterizer.
+static waveform::Color RasterColor(NSColor *color) {
+  NSColor *rgb = [color colorUsingColorSpace:[NSColorSpace sRGBColorSpace]];
+  if (!rgb) return {};
+
+  auto channel = [](CGFloat value) { return (uint8_t)lround(MAX(0.0, MIN(1.0, value)) * 255.0); };
+  return {channel(rgb.redComponent),
+          channel(rgb.greenComponent),
+          channel(rgb.blueComponent),
+          channel(rgb.alphaComponent)};
+}
+
+@implementation WaveformGenerator
+
++ (BFTask<NSData *> *)generatePeaksForTrack:(Track *)track
+                                        url:(NSURL *)url
+                                   progress:(WaveformProgressBlock)progress {
+  return [BFTask
+      taskFromExecutor:[BFExecutor defaultExecutor]
+             withBlock:^id {
+               NSError *error = nil;
+
+               // A header-only estimate covers the whole track at once, which beats a growing partial decode
+               NSData *estimate = progress ? [self estimatePeaksForURL:url] : nil;
+               if (estimate) {
+                 dispatch_async(dispatch_get_main_queue(), ^{ progress(estimate, 1.0); });
+               }
+               WaveformProgressBlock decodeProgress = estimate ? nil : progress;
+
+               AVAsset *asset = [AVAsset assetWithURL:url];
+
+               if (!asset.isReadable) {
+                 return [BFTask
+                     taskWithError:[NSError errorWithDomain:@"WaveformGenerator"
+                                                       code:-1
+                                                   userInfo:@{NSLocalizedDescriptionKey : @"Asset not readable"}]];
+               }
+
+               AVAssetTrack *audioTrack = [[asset tracksWithMediaType:AVMediaTypeAudio] firstObject];
+               if (!audioTrack) {
+                 return [BFTask
+                     taskWithError:[NSError errorWithDomain:@"WaveformGenerator"
+                                                       code:-2
+                                                   userInfo:@{NSLocalizedDescriptionKey : @"No audio track found"}]];
+               }
+
+               // Determine the optimal output settings
+               NSDictionary *outputSettings = [self outputSettingsForTrack:track assetTrack:audioTrack];
+
+               Float64 durationSeconds = CMTimeGetSeconds(asset.duration);
+               NSUInteger segmentCount = [self segmentCountForDuration:durationSeconds];
+               if (segmentCount > 1) {
+                 return [self generateSegmentedPeaksForTrack:audioTrack
+                                                    settings:outputSettings
+                                                segmentCount:segmentCount
+                                                    progress:decodeProgress];
+               }
+
+               AVAssetReader *reader = [self startReaderForTrack:audioTrack
+                                                       timeRange:CMTimeRangeMake(kCMTimeZero, kCMTimePositiveInfinity)
+                                                        settings:outputSettings
+                                                           error:&error];
+               if (!reader) {
+                 return [BFTask taskWithError:error];
+               }
+
+               std::optional<waveform::PeakWriter> writer = [self readPeaksFromReader:reader
+                                                                       framesPerBlock:0
+                                                                      durationSeconds:durationSeconds
+                                                                             progress:decodeProgress];
+               if (!writer) {
+                 return [BFTask taskWithError:[self decodeErrorForReader:reader]];
+               }
+
+               return [self taskWithPeaks:writer->finish()];
+             }];
+}
+
++ (NSData *)estimatePeaksForURL:(NSURL *)url {
+  // Raw streams only, `readCompressedEnvelope` does not look inside MP4 containers
+  NSString *extension = url.pathExtension.lowercaseString;
+  if (![extension isEqualToString:@"mp3"] && ![extension isEqualToString:@"aac"]) return nil;
+
+  NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:nil];
+  if (!data) return nil;
+
+  std::optional<waveform::CompressedEnvelope> envelope =
+      waveform::readCompressedEnvelope((const uint8_t *)data.bytes, data.length);
+  if (!envelope) return nil;
+
+  std::vector<uint8_t> peaks = waveform::encodeEnvelopePeaks(*envelope);
+  if (peaks.empty()) return nil;
+  return [NSData dataWithBytes:peaks.data() length:peaks.size()];
+}
+
++ (AVAssetReader *)startReaderForTrack:(AVAssetTrack *)audioTrack
+                             timeRange:(CMTimeRange)timeRange
+                              settings:(NSDictionary *)outputSettings
+                                 error:(NSError **)error {
+  AVAssetReader *reader = [[AVAssetReader alloc] initWithAsset:audioTrack.asset error:error];
+  if (!reader) {
+    return nil;
+  }
+
+  AVAssetReaderTrackOutput *output = [[AVAssetReaderTrackOutput alloc] initWithTrack:audioTrack
+                                                                      outputSettings:outputSettings];
+  if (![reader canAddOutput:output]) {
+    if (error) {
+      *error = [NSError errorWithDomain:@"WaveformGenerator"
+                                   code:-3
+                               userInfo:@{NSLocalizedDescriptionKey : @"Cannot add output to reader"}];
+    }
+    return nil;
+  }
+  [reader addOutput:output];
+  reader.timeRange = timeRange;
+
+  if (![reader startReading]) {
+    if (error) {
+      *error = reader.error;
+    }
+    return nil;
+  }
+
+  return reader;
+}
+
++ (NSError *)decodeErrorForReader:(AVAssetReader *)reader {
+  return reader.error ?: [NSError errorWithDomain:@"WaveformGenerator"
+                                             code:-4
+                                         userInfo:@{NSLocalizedDescriptionKey : @"No audio decoded"}];
+}
+
+/// An empty peak file means no block was ever closed. It fails the task so it never reaches the cache.
++ (BFTask<NSData *> *)taskWithPeaks:(const std::vector<uint8_t> &)peaks {
+  if (peaks.empty()) {
+    return [BFTask taskWithError:[NSError errorWithDomain:@"WaveformGenerator"
+                                                     code:-5
+                                                 userInfo:@{NSLocalizedDescriptionKey : @"No peaks encoded"}]];
+  }
+  return [BFTask taskWithResult:[NSData dataWithBytes:peaks.data() length:peaks.size()]];
+}
+
+#pragma mark - Segments
+
+/// Each reader seeks and primes its own decoder, which only pays off for segments of a couple of minutes.
++ (NSUInteger)segmentCountForDuration:(Float64)durationSeconds {
+  if (!(durationSeconds > 0)) return 1;
+
+  NSUInteger cores = [NSProcessInfo processInfo].activeProcessorCount;
+  NSUInteger bySize = (NSUInteger)(durationSeconds / kMinSegmentSeconds);
+  return MAX(MIN(MIN(cores, bySize), kMaxSegments), 1);
+}
+
+/// Decodes `segmentCount` time ranges concurrently, each with its own reader, and joins their blocks in order.
+/// Segments start on block boundaries so the joined blocks line up with a sequential decode.
++ (BFTask<NSData *> *)generateSegmentedPeaksForTrack:(AVAssetTrack *)audioTrack
+                                            settings:(NSDictionary *)outputSettings
+                                        segmentCount:(NSUInteger)segmentCount
+                                            progress:(WaveformProgressBlock)progress {
+  Float64 durationSeconds = CMTimeGetSeconds(audioTrack.asset.duration);
+  CMFormatDescriptionRef format = (__bridge CMFormatDescriptionRef)audioTrack.formatDescriptions.firstObject;
+  const AudioStreamBasicDescription *asbd = format ? CMAudioFormatDescriptionGetStreamBasicDescription(format) : NULL;
+  int32_t sampleRate = asbd && asbd->mSampleRate > 0 ? (int32_t)asbd->mSampleRate : 44100;
+
+  uint64_t expectedFrames = (uint64_t)(durationSeconds * sampleRate);
+  uint32_t framesPerBlock = waveform::framesPerBlockFor(expectedFrames);
+  uint64_t totalBlocks = (expectedFrames + framesPerBlock - 1) / framesPerBlock;
+  uint64_t segmentFrames = (totalBlocks + segmentCount - 1) / segmentCount * framesPerBlock;
+
+  auto state = std::make_shared<SegmentState>();
+  state->writers.resize(segmentCount);
+  state->expectedFrames = expectedFrames;
+
+  NSMutableArray<BFTask *> *tasks = [NSMutableArray arrayWithCapacity:segmentCount];
+  for (NSUInteger index = 0; index < segmentCount; index++) {
+    uint64_t startFrame = index * segmentFrames;
+    BOOL isLast = index == segmentCount - 1;
+    CMTime start = CMTimeMake((int64_t)startFrame, sampleRate);
+    CMTime duration = isLast ? kCMTimePositiveInfinity : CMTimeMake((int64_t)segmentFrames, sampleRate);
+
+    [tasks addObject:[BFTask taskFromExecutor:[BFExecutor defaultExecutor]
+                                    withBlock:^id {
+                                      NSError *error = nil;
+                                      AVAssetReader *reader = [self startReaderForTrack:audioTrack
+                                                                              timeRange:CMTimeRangeMake(start, duration)
+                                                                               settings:outputSettings
+                                                                                  error:&error];
+                                      if (!reader) {
+                                        return [BFTask taskWithError:error];
+                                      }
+
+                                      std::optional<waveform::PeakWriter> writer =
+                                          [self readPeaksFromReader:reader
+                                                     framesPerBlock:framesPerBlock
+                                                    durationSeconds:0
+                                                           progress:nil];
+                                      if (!writer) {
+                                        return [BFTask taskWithError:[self decodeErrorForReader:reader]];
+                                      }
+
+                                      [self completeSegment:index
+                                                     writer:std::move(*writer)
+                                                      state:state
+                                                   progress:progress];
+                                      return nil;
+                                    }]];
+  }
+
+  return [[BFTask taskForCompletionOfAllTasks:tasks] continueWithSuccessBlock:^id(BFTask *task) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    waveform::PeakWriter joined = std::move(*state->writers[0]);
+    for (size_t index = 1; index < state->writers.size(); index++) {
+      joined.appendSegment(std::move(*state->writers[index]));
+    }
+
+    return [self taskWithPeaks:joined.finish()];
+  }];
+}
+
+/// Segments finish in any order. Progress shows the run of finished segments from the start of the track.
++ (void)completeSegment:(NSUInteger)index
+                 writer:(waveform::PeakWriter &&)writer
+                  state:(std::shared_ptr<SegmentState>)state
+               progress:(WaveformProgressBlock)progress {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->writers[index] = std::move(writer);
+
+  size_t finished = 0;
+  while (finished < state->writers.size() && state->writers[finished]) {
+    finished++;
+  }
+  if (!progress || finished <= state->published || finished == state->writers.size()) {
+    return;
+  }
+  state->published = finished;
+
+  waveform::PeakWriter prefix = *state->writers[0];
+  for (size_t i = 1; i < finished; i++) {
+    prefix.appendSegment(waveform::PeakWriter(*state->writers[i]));
+  }
+  [self publishProgressFromWriter:prefix expectedFrames:state->expectedFrames progress:progress];
+}
+
+#pragma mark - Decoding
+
++ (NSDictionary *)outputSettingsForTrack:(Track *)track assetTrack:(AVAssetTrack *)assetTrack {
+  NSSet *compressedFormats = [NSSet setWithObjects:@"mp3", @"m4a", @"aac", @"m4b", @"m4p", nil];
+  if (track.fileType && [compressedFormats containsObject:track.fileType.lowercaseString]) {
+    return [self defaultOutputSettings];
+  }
+
+  // Inspect the format for valid uncompressed types (WAV, AIFF, FLAC)
+  NSArray *formatDescriptions = assetTrack.formatDescriptions;
+  if (formatDescriptions.count > 0) {
+    CMFormatDescriptionRef formatDescription = (__bridge CMFormatDescriptionRef)formatDescriptions.firstObject;
+    const AudioStreamBasicDescription *asbd = CMAudioFormatDescriptionGetStreamBasicDescription(formatDescription);
+
+    // Check for 16-bit, Signed Integer, Native Endian PCM
+    if (asbd->mFormatID == kAudioFormatLinearPCM) {
+      BOOL isFloat = (asbd->mFormatFlags & kAudioFormatFlagIsFloat);
+      BOOL isSigned = (asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger);
+      BOOL isBigEndian = (asbd->mFormatFlags & kAudioFormatFlagIsBigEndian);
+
+      if (!isFloat && isSigned && asbd->mBitsPerChannel == 16 && !isBigEndian) {
+        return nil;
+      }
+    }
+  }
+
+  return [self defaultOutputSettings];
+}
+
++ (NSDictionary *)defaultOutputSettings {
+  return @{
+    AVFormatIDKey : @(kAudioFormatLinearPCM),
+    AVLinearPCMBitDepthKey : @16,
+    AVLinearPCMIsBigEndianKey : @NO,
+    AVLinearPCMIsFloatKey : @NO,
+    AVLinearPCMIsNonInterleaved : @NO,
+    AVNumberOfChannelsKey : @1
+  };
+}
+
+/// Decodes everything `reader` delivers. The writer is created from the first buffer, which tells the actual layout.
+/// `framesPerBlock` of 0 sizes blocks for `durationSeconds`. Nothing if no audio was decoded or the reader failed.
++ (std::optional<waveform::PeakWriter>)readPeaksFromReader:(AVAssetReader *)reader
+                                            framesPerBlock:(uint32_t)framesPerBlock
+                                           durationSeconds:(Float64)durationSeconds
+                                                  progress:(WaveformProgressBlock)progress {
+  AVAssetReaderOutput *output = reader.outputs.firstObject;
+  if (!(durationSeconds > 0)) durationSeconds = 1;
+
+  std::optional<waveform::PeakWriter> writer;
+  uint64_t expectedFrames = 0;
+  CFAbsoluteTime lastPublished = CFAbsoluteTimeGetCurrent();
+
+  while (reader.status == AVAssetReaderStatusReading) {
+    CMSampleBufferRef sampleBuffer = [output copyNextSampleBuffer];
+    if (!sampleBuffer) break;
+
+    if (!writer) {
+      CMFormatDescriptionRef format = CMSampleBufferGetFormatDescription(sampleBuffer);
+      const AudioStreamBasicDescription *asbd = CMAudioFormatDescriptionGetStreamBasicDescription(format);
+      Float64 sampleRate = asbd && asbd->mSampleRate > 0 ? asbd->mSampleRate : 44100.0;
+      UInt32 channels = asbd && asbd->mChannelsPerFrame > 0 ? asbd->mChannelsPerFrame : 1;
+
+      expectedFrames = (uint64_t)(durationSeconds * sampleRate);
+      writer.emplace(sampleRate, channels, framesPerBlock ?: waveform::framesPerBlockFor(expectedFrames));
+    }
+
+    AppendSampleBuffer(sampleBuffer, *writer);
+    CFRelease(sampleBuffer);
+
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    if (progress && now - lastPublished >= kProgressInterval && writer->completedFrames() > 0) {
+      lastPublished = now;
+      [self publishProgressFromWriter:*writer expectedFrames:expectedFrames progress:progress];
+    }
+  }
+
+  if (!writer || writer->frames() == 0 || reader.status == AVAssetReaderStatusFailed) {
+    return std::nullopt;
+  }
+  return writer;
+}
+
++ (void)publishProgressFromWriter:(const waveform::PeakWriter &)writer
+                   expectedFrames:(uint64_t)expectedFrames
+                         progress:(WaveformProgressBlock)progress {
+  std::vector<uint8_t> snapshot = writer.snapshot();
+  if (snapshot.empty()) return;
+  NSData *partialPeaks = [NSData dataWithBytes:snapshot.data() length:snapshot.size()];
+  double fraction = expectedFrames > 0 ? MIN((double)writer.completedFrames() / expectedFrames, 1.0) : 0.0;
+
+  dispatch_async(dispatch_get_main_queue(), ^{ progress(partialPeaks, fraction); });
+}
+
+#pragma mark - Rendering
+
++ (NSImage *)renderWaveformFromPeaks:(NSData *)peaks
+                                size:(CGSize)size
+                               scale:(CGFloat)scale
+                      playedFraction:(double)playedFraction {
+  std::vector<float> amplitudes = [self amplitudesFromPeaks:peaks count:(NSInteger)round(size.width * scale)];
+  if (amplitudes.empty()) return nil;
+
+  uint32_t width = (uint32_t)amplitudes.size();
+  uint32_t height = (uint32_t)MAX(round(size.height * scale), 1);
+  size_t bytesPerRow = (size_t)width * 4;
+  NSMutableData *pixels = [NSMutableData dataWithLength:bytesPerRow * height];
+
+  waveform::RasterStyle style;
+  style.unplayed = RasterColor([[NSColor systemGrayColor] colorWithAlphaComponent:0.5]);
+  style.played = RasterColor([[NSColor systemBlueColor] colorWithAlphaComponent:0.8]);
+  style.playedWidth = MAX(0.0, MIN(1.0, playedFraction)) * width;
+  waveform::rasterizeWaveform(amplitudes, {(uint8_t *)pixels.mutableBytes, width, height, bytesPerRow}, style);
+
+  CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)pixels);
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+  CGImageRef cgImage = CGImageCreate(width,
+                                     height,
+                                     8,
+                                     32,
+                                     bytesPerRow,
+                                     colorSpace,
+                                     kCGImageAlphaPremultipliedLast | kCGBitmapByteOrderDefault,
+                                     provider,
+                                     NULL,
+                                     false,
+                                     kCGRenderingIntentDefault);
+  CGColorSpaceRelease(colorSpace);
+  CGDataProviderRelease(provider);
+  if (!cgImage) return nil;
+
+  NSImage *image = [[NSImage alloc] initWithCGImage:cgImage size:size];
+  CGImageRelease(cgImage);
+  return image;
+}
+
+/// One RMS value per pixel column, normalized to the loudest column. Empty if `peaks` is not a valid peak file.
++ (std::vector<float>)amplitudesFromPeaks:(NSData *)peaks count:(NSInteger)count {
+  waveform::PeakReader reader;
+  if (count <= 0 || !reader.open((const uint8_t *)peaks.bytes, peaks.length)) return {};
+
+  std::vector<waveform::Peak> columns((size_t)count);
+  reader.render(columns);
+
+  std::vector<float> amplitudes((size_t)count);
+  for (size_t i = 0; i < columns.size(); i++) {
+    amplitudes[i] = columns[i].rms;
+  }
+
+  float maxVal = 0;
+  vDSP_maxv(amplitudes.data(), 1, &maxVal, count);
+  if (maxVal > 0) {
+    float scale = 1.0f / maxVal;
+    vDSP_vsmul(amplitudes.data(), 1, &scale, amplitudes.data(), 1, count);
+  }
+  return amplitudes;
+}
+
+@end
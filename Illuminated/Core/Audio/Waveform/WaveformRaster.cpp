@@ -0,0 +1,104 @@
+//
+//  WaveformRaster.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "WaveformRaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace waveform {
+
+namespace {
+
+/// Vertical extent of one column's bar, in pixels from the top, and its premultiplied color.
+struct Bar {
+  float top = 0.0f;
+  float bottom = 0.0f;
+  uint8_t rgba[4] = {};
+};
+
+uint8_t scale(uint32_t value, uint32_t coverage) {
+  return (uint8_t)((value * coverage + 127) / 255);
+}
+
+void premultiply(Color color, uint32_t coverage, uint8_t *out) {
+  uint32_t alpha = scale(color.a, coverage);
+  out[0] = scale(color.r, alpha);
+  out[1] = scale(color.g, alpha);
+  out[2] = scale(color.b, alpha);
+  out[3] = (uint8_t)alpha;
+}
+
+/// Premultiplied color of a column that is `played` parts played, in [0, 1].
+void columnColor(const RasterStyle &style, float played, uint8_t *out) {
+  if (played >= 1.0f) {
+    premultiply(style.played, 255, out);
+  } else if (played <= 0.0f) {
+    premultiply(style.unplayed, 255, out);
+  } else {
+    uint8_t a[4];
+    uint8_t b[4];
+    uint32_t weight = (uint32_t)std::lround(played * 255.0f);
+    premultiply(style.played, weight, a);
+    premultiply(style.unplayed, 255 - weight, b);
+    for (int i = 0; i < 4; i++) {
+      out[i] = (uint8_t)std::min(a[i] + b[i], 255);
+    }
+  }
+}
+
+} // namespace
+
+void rasterizeWaveform(std::span<const float> amplitudes, const PixelBuffer &buffer, const RasterStyle &style) {
+  if (!buffer.pixels || buffer.width == 0 || buffer.height == 0) {
+    return;
+  }
+  for (uint32_t y = 0; y < buffer.height; y++) {
+    std::memset(buffer.pixels + y * buffer.bytesPerRow, 0, (size_t)buffer.width * 4);
+  }
+  if (amplitudes.empty()) {
+    return;
+  }
+
+  float mid = buffer.height / 2.0f;
+  std::vector<Bar> bars(buffer.width);
+  for (uint32_t x = 0; x < buffer.width; x++) {
+    size_t index = (size_t)((uint64_t)x * amplitudes.size() / buffer.width);
+    float half = std::clamp(amplitudes[index], 0.0f, 1.0f) * mid;
+    bars[x].top = mid - half;
+    bars[x].bottom = mid + half;
+    columnColor(style, (float)std::clamp(style.playedWidth - x, 0.0, 1.0), bars[x].rgba);
+  }
+
+  // Row by row keeps the writes sequential. Rows fully inside a bar copy its color, the two rows holding its
+  // ends are scaled by how much of them it covers.
+  for (uint32_t y = 0; y < buffer.height; y++) {
+    uint8_t *row = buffer.pixels + y * buffer.bytesPerRow;
+    float rowTop = (float)y;
+    float rowBottom = rowTop + 1.0f;
+
+    for (uint32_t x = 0; x < buffer.width; x++) {
+      const Bar &bar = bars[x];
+      if (bar.bottom <= rowTop || bar.top >= rowBottom) continue;
+
+      uint8_t *pixel = row + x * 4;
+      float coverage = std::min(bar.bottom, rowBottom) - std::max(bar.top, rowTop);
+      if (coverage >= 1.0f) {
+        std::memcpy(pixel, bar.rgba, 4);
+      } else {
+        uint32_t weight = (uint32_t)std::lround(coverage * 255.0f);
+        for (int i = 0; i < 4; i++) {
+          pixel[i] = scale(bar.rgba[i], weight);
+        }
+      }
+    }
+  }
+}
+
+} // namespace waveform
@@ -0,0 +1,45 @@
+//
+//  WaveformRaster.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/// Draws waveform bars straight into a pixel buffer, one column per device pixel, without a graphics context.
+/// The caller wraps the buffer in whatever image type the platform wants.
+namespace waveform {
+
+/// Straight (not premultiplied) 8-bit RGBA.
+struct Color {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+  uint8_t a = 0;
+};
+
+struct RasterStyle {
+  Color unplayed;
+  Color played;
+  /// Columns left of this, in pixels, use `played`. The column it falls inside is blended.
+  double playedWidth = 0.0;
+};
+
+/// Premultiplied RGBA, 4 bytes per pixel, top row first. Rows are `bytesPerRow` apart.
+struct PixelBuffer {
+  uint8_t *pixels = nullptr;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  size_t bytesPerRow = 0;
+};
+
+/// Clears `buffer` and draws one bar per column, centered vertically, `amplitudes` in [0, 1] of the half height.
+/// Amplitudes are spread across the width when there are fewer of them than columns. Bar ends are antialiased.
+void rasterizeWaveform(std::span<const float> amplitudes, const PixelBuffer &buffer, const RasterStyle &style);
+
+} // namespace waveform
@@ -0,0 +1,517 @@
+//
+//  WaveformStore.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "WaveformStore.h"
+#include "LittleEndian.h"
+
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace waveform {
+
+namespace {
+
+constexpr uint8_t kDataMagic[4] = {'I', 'W', 'F', 'D'};
+constexpr uint8_t kRecordMagic[4] = {'I', 'W', 'F', 'R'};
+constexpr uint8_t kIndexMagic[4] = {'I', 'W', 'F', 'I'};
+constexpr uint32_t kVersion = 1;
+
+constexpr size_t kDataHeaderSize = 16;
+constexpr size_t kRecordHeaderSize = 16;
+constexpr size_t kIndexHeaderSize = 32;
+constexpr size_t kIndexEntrySize = 16;
+
+constexpr uint16_t kTombstone = 1;
+
+/// Records appended between index commits, bounds how much is replayed after a crash.
+constexpr size_t kCommitInterval = 64;
+
+const std::string kIndexName = "waveforms.index";
+const std::string kDataPrefix = "waveforms-";
+const std::string kDataSuffix = ".data";
+const std::string kTempSuffix = ".tmp";
+
+uint64_t padded(uint64_t length) {
+  return (length + 7) & ~7ull;
+}
+
+uint64_t recordSize(size_t keyLength, uint64_t payloadLength) {
+  return kRecordHeaderSize + padded(keyLength) + padded(payloadLength);
+}
+
+/// FNV-1a over key and payload, enough to tell a torn write from a complete record.
+uint32_t checksum(std::string_view key, std::span<const uint8_t> bytes) {
+  uint32_t hash = 2166136261u;
+  for (char c : key) {
+    hash = (hash ^ (uint8_t)c) * 16777619u;
+  }
+  for (uint8_t byte : bytes) {
+    hash = (hash ^ byte) * 16777619u;
+  }
+  return hash;
+}
+
+bool readAt(int fd, uint64_t offset, void *buffer, size_t length) {
+  uint8_t *bytes = (uint8_t *)buffer;
+  while (length > 0) {
+    ssize_t count = pread(fd, bytes, length, (off_t)offset);
+    if (count <= 0) return false;
+    bytes += count;
+    offset += (uint64_t)count;
+    length -= (size_t)count;
+  }
+  return true;
+}
+
+bool writeAt(int fd, uint64_t offset, const void *buffer, size_t length) {
+  const uint8_t *bytes = (const uint8_t *)buffer;
+  while (length > 0) {
+    ssize_t count = pwrite(fd, bytes, length, (off_t)offset);
+    if (count <= 0) return false;
+    bytes += count;
+    offset += (uint64_t)count;
+    length -= (size_t)count;
+  }
+  return true;
+}
+
+uint64_t fileSize(int fd) {
+  struct stat info;
+  return fstat(fd, &info) == 0 && info.st_size > 0 ? (uint64_t)info.st_size : 0;
+}
+
+bool hasSuffix(const std::string &name, const std::string &suffix) {
+  return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/// Opens a data file and checks its header, or creates it with one. -1 on failure.
+int openDataFile(const std::string &path, uint64_t generation, bool create) {
+  int fd = ::open(path.c_str(), create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+  if (fd < 0) return -1;
+
+  uint8_t header[kDataHeaderSize] = {};
+  if (create) {
+    std::memcpy(header, kDataMagic, sizeof(kDataMagic));
+    put32(header + 4, kVersion);
+    put64(header + 8, generation);
+    if (!writeAt(fd, 0, header, sizeof(header))) {
+      ::close(fd);
+      return -1;
+    }
+  } else if (!readAt(fd, 0, header, sizeof(header)) || std::memcmp(header, kDataMagic, sizeof(kDataMagic)) != 0 ||
+             get32(header + 4) != kVersion || get64(header + 8) != generation) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+} // namespace
+
+struct WaveformStore::Mapping {
+  const uint8_t *address = nullptr;
+  size_t length = 0;
+
+  ~Mapping() {
+    if (address) {
+      munmap((void *)address, length);
+    }
+  }
+};
+
+WaveformStore::WaveformStore(std::string directory) : _directory(std::move(directory)) {}
+
+WaveformStore::~WaveformStore() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_fd >= 0 && _unflushedRecords > 0) {
+    commit();
+  }
+  closeData();
+}
+
+std::string WaveformStore::dataPath(uint64_t generation) const {
+  return _directory + "/" + kDataPrefix + std::to_string(generation) + kDataSuffix;
+}
+
+std::string WaveformStore::indexPath() const {
+  return _directory + "/" + kIndexName;
+}
+
+bool WaveformStore::open() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  closeData();
+  mkdir(_directory.c_str(), 0755);
+
+  uint64_t committedLength = 0;
+  if (loadIndex(committedLength) && openData(_generation, false) && committedLength <= fileSize(_fd)) {
+    replay(committedLength);
+  } else {
+    // Missing or unreadable, start over in a generation nothing else points at
+    closeData();
+    _entries.clear();
+    _liveBytes = 0;
+    _generation++;
+    if (!openData(_generation, true) || !writeIndex(_generation, _dataLength)) {
+      closeData();
+      return false;
+    }
+  }
+
+  removeStaleFiles();
+  return true;
+}
+
+bool WaveformStore::openData(uint64_t generation, bool create) {
+  int fd = openDataFile(dataPath(generation), generation, create);
+  if (fd < 0) return false;
+
+  _fd = fd;
+  _dataLength = kDataHeaderSize;
+  return true;
+}
+
+bool WaveformStore::loadIndex(uint64_t &dataLength) {
+  int fd = ::open(indexPath().c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  std::vector<uint8_t> index(fileSize(fd));
+  bool ok = index.size() >= kIndexHeaderSize && readAt(fd, 0, index.data(), index.size());
+  ::close(fd);
+
+  if (!ok || std::memcmp(index.data(), kIndexMagic, sizeof(kIndexMagic)) != 0 || get32(&index[4]) != kVersion) {
+    return false;
+  }
+
+  uint64_t generation = get64(&index[8]);
+  dataLength = get64(&index[16]);
+  uint64_t count = get64(&index[24]);
+
+  std::unordered_map<std::string, Entry> entries;
+  uint64_t liveBytes = 0;
+  size_t position = kIndexHeaderSize;
+  for (uint64_t i = 0; i < count; i++) {
+    if (index.size() - position < kIndexEntrySize) return false;
+    const uint8_t *entry = &index[position];
+    size_t keyLength = get16(entry);
+    Entry value = {get64(entry + 8), get32(entry + 4)};
+    position += kIndexEntrySize;
+
+    if (index.size() - position < keyLength || value.offset + value.length > dataLength) return false;
+    entries.emplace(std::string((const char *)&index[position], keyLength), value);
+    liveBytes += recordSize(keyLength, value.length);
+    position += keyLength;
+  }
+
+  _generation = generation;
+  _entries = std::move(entries);
+  _liveBytes = liveBytes;
+  return true;
+}
+
+/// Applies records written after the committed length and truncates whatever follows the last complete one.
+void WaveformStore::replay(uint64_t from) {
+  uint64_t end = fileSize(_fd);
+  std::vector<uint8_t> payload;
+  _dataLength = from;
+
+  uint8_t header[kRecordHeaderSize];
+  while (end - _dataLength >= kRecordHeaderSize && readAt(_fd, _dataLength, header, sizeof(header)) &&
+         std::memcmp(header, kRecordMagic, sizeof(kRecordMagic)) == 0) {
+    size_t keyLength = get16(header + 4);
+    uint16_t flags = get16(header + 6);
+    uint32_t length = get32(header + 8);
+    uint64_t size = recordSize(keyLength, length);
+    if (end - _dataLength < size) break;
+
+    std::string key(keyLength, '\0');
+    uint64_t payloadOffset = _dataLength + kRecordHeaderSize + padded(keyLength);
+    payload.resize(length);
+    if (!readAt(_fd, _dataLength + kRecordHeaderSize, key.data(), keyLength) ||
+        !readAt(_fd, payloadOffset, payload.data(), length) || checksum(key, payload) != get32(header + 12)) {
+      break;
+    }
+
+    auto existing = _entries.find(key);
+    if (existing != _entries.end()) {
+      _liveBytes -= recordSize(keyLength, existing->second.length);
+      _entries.erase(existing);
+    }
+    if (!(flags & kTombstone)) {
+      _entries.emplace(key, Entry{payloadOffset, length});
+      _liveBytes += size;
+    }
+
+    _dataLength += size;
+    _unflushedRecords++;
+  }
+
+  if (end > _dataLength) {
+    ftruncate(_fd, (off_t)_dataLength);
+  }
+}
+
+/// Data files of other generations are compactions that never committed, or ones that did and were not deleted.
+void WaveformStore::removeStaleFiles() {
+  DIR *directory = opendir(_directory.c_str());
+  if (!directory) return;
+
+  std::string current = kDataPrefix + std::to_string(_generation) + kDataSuffix;
+  while (struct dirent *entry = readdir(directory)) {
+    std::string name = entry->d_name;
+    bool staleData = name.compare(0, kDataPrefix.size(), kDataPrefix) == 0 && name != current &&
+                     (hasSuffix(name, kDataSuffix) || hasSuffix(name, kTempSuffix));
+    if (staleData || name == kIndexName + kTempSuffix) {
+      unlink((_directory + "/" + name).c_str());
+    }
+  }
+  closedir(directory);
+}
+
+void WaveformStore::closeData() {
+  // Blobs already handed out keep their own reference to the mapping
+  _mapping.reset();
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+WaveformStore::Blob WaveformStore::find(std::string_view key) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _entries.find(std::string(key));
+  if (it == _entries.end()) return {};
+
+  const Entry &entry = it->second;
+  if (!_mapping || _mapping->length < entry.offset + entry.length) {
+    // The file only grows between compactions, so one new mapping covers every entry so far
+    void *address = mmap(nullptr, (size_t)_dataLength, PROT_READ, MAP_SHARED, _fd, 0);
+    if (address == MAP_FAILED) return {};
+
+    auto mapping = std::make_shared<Mapping>();
+    mapping->address = (const uint8_t *)address;
+    mapping->length = (size_t)_dataLength;
+    _mapping = std::move(mapping);
+  }
+
+  return {_mapping, std::span<const uint8_t>(_mapping->address + entry.offset, entry.length)};
+}
+
+bool WaveformStore::contains(std::string_view key) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.count(std::string(key)) > 0;
+}
+
+WaveformStore::Stats WaveformStore::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return {_entries.size(), _liveBytes, _dataLength > kDataHeaderSize ? _dataLength - kDataHeaderSize : 0};
+}
+
+bool WaveformStore::append(int fd, uint64_t &offset, std::string_view key, std::span<const uint8_t> bytes,
+                           uint16_t flags, Entry *entry) {
+  uint64_t size = recordSize(key.size(), bytes.size());
+  std::vector<uint8_t> record(size, 0);
+
+  std::memcpy(record.data(), kRecordMagic, sizeof(kRecordMagic));
+  put16(&record[4], (uint16_t)key.size());
+  put16(&record[6], flags);
+  put32(&record[8], (uint32_t)bytes.size());
+  put32(&record[12], checksum(key, bytes));
+  std::memcpy(&record[kRecordHeaderSize], key.data(), key.size());
+
+  uint64_t payloadOffset = kRecordHeaderSize + padded(key.size());
+  if (!bytes.empty()) {
+    std::memcpy(&record[payloadOffset], bytes.data(), bytes.size());
+  }
+
+  if (!writeAt(fd, offset, record.data(), record.size())) return false;
+
+  if (entry) {
+    *entry = {offset + payloadOffset, (uint32_t)bytes.size()};
+  }
+  offset += size;
+  return true;
+}
+
+bool WaveformStore::put(std::string_view key, std::span<const uint8_t> bytes) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_fd < 0 || key.empty() || key.size() > kMaxKeyLength || bytes.size() > UINT32_MAX) return false;
+
+  Entry entry;
+  if (!append(_fd, _dataLength, key, bytes, 0, &entry)) return false;
+
+  std::string name(key);
+  auto existing = _entries.find(name);
+  if (existing != _entries.end()) {
+    _liveBytes -= recordSize(key.size(), existing->second.length);
+  }
+  _entries[name] = entry;
+  _liveBytes += recordSize(key.size(), bytes.size());
+
+  if (++_unflushedRecords >= kCommitInterval) {
+    commit();
+  }
+  return true;
+}
+
+bool WaveformStore::remove(std::string_view key) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto existing = _entries.find(std::string(key));
+  if (_fd < 0 || existing == _entries.end()) return false;
+
+  // A tombstone, so replaying after a crash does not bring the entry back
+  if (!append(_fd, _dataLength, key, {}, kTombstone, nullptr)) return false;
+
+  _liveBytes -= recordSize(key.size(), existing->second.length);
+  _entries.erase(existing);
+  _unflushedRecords++;
+  return true;
+}
+
+bool WaveformStore::flush() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _fd >= 0 && commit();
+}
+
+bool WaveformStore::commit() {
+  // The index must never point at data that is not on disk yet
+  if (fsync(_fd) != 0 || !writeIndex(_generation, _dataLength)) return false;
+
+  _unflushedRecords = 0;
+  return true;
+}
+
+bool WaveformStore::writeIndex(uint64_t generation, uint64_t dataLength) {
+  size_t size = kIndexHeaderSize;
+  for (const auto &[key, entry] : _entries) {
+    size += kIndexEntrySize + key.size();
+  }
+
+  std::vector<uint8_t> index(size, 0);
+  std::memcpy(index.data(), kIndexMagic, sizeof(kIndexMagic));
+  put32(&index[4], kVersion);
+  put64(&index[8], generation);
+  put64(&index[16], dataLength);
+  put64(&index[24], _entries.size());
+
+  size_t position = kIndexHeaderSize;
+  for (const auto &[key, entry] : _entries) {
+    put16(&index[position], (uint16_t)key.size());
+    put32(&index[position + 4], entry.length);
+    put64(&index[position + 8], entry.offset);
+    std::memcpy(&index[position + kIndexEntrySize], key.data(), key.size());
+    position += kIndexEntrySize + key.size();
+  }
+
+  std::string temporaryPath = indexPath() + kTempSuffix;
+  int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return false;
+
+  bool ok = writeAt(fd, 0, index.data(), index.size()) && fsync(fd) == 0;
+  ::close(fd);
+
+  if (!ok || rename(temporaryPath.c_str(), indexPath().c_str()) != 0) {
+    unlink(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool WaveformStore::compactIfNeeded(double deadFraction, uint64_t minimumDeadBytes) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  uint64_t dataBytes = _dataLength > kDataHeaderSize ? _dataLength - kDataHeaderSize : 0;
+  uint64_t deadBytes = dataBytes > _liveBytes ? dataBytes - _liveBytes : 0;
+  if (_fd < 0 || _compacting || deadBytes < minimumDeadBytes || deadBytes < dataBytes * deadFraction) return false;
+
+  return compactUnlocked(lock);
+}
+
+bool WaveformStore::compact() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _fd >= 0 && !_compacting && compactUnlocked(lock);
+}
+
+bool WaveformStore::copyRecords(int from, int to, uint64_t &length, std::unordered_map<std::string, Entry> &entries) {
+  std::vector<uint8_t> payload;
+  for (auto &[key, entry] : entries) {
+    payload.resize(entry.length);
+    if (!readAt(from, entry.offset, payload.data(), payload.size()) || !append(to, length, key, payload, 0, &entry)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Records are only ever appended, so everything below the snapshot's length stays put while the lock is released.
+/// What was written meanwhile lies past it and is copied once the lock is back, together with the index swap.
+bool WaveformStore::compactUnlocked(std::unique_lock<std::mutex> &lock) {
+  uint64_t oldGeneration = _generation;
+  uint64_t newGeneration = oldGeneration + 1;
+  int oldFd = _fd;
+  uint64_t copiedLength = _dataLength;
+  std::unordered_map<std::string, Entry> copied = _entries;
+  _compacting = true;
+  lock.unlock();
+
+  int newFd = openDataFile(dataPath(newGeneration), newGeneration, true);
+  uint64_t newLength = kDataHeaderSize;
+  bool ok = newFd >= 0 && copyRecords(oldFd, newFd, newLength, copied);
+
+  lock.lock();
+  _compacting = false;
+  // Reopened while copying, the snapshot is of a store that is gone
+  ok = ok && _fd == oldFd && _generation == oldGeneration;
+
+  // Entries still pointing below the snapshot's length are the records that were copied
+  std::unordered_map<std::string, Entry> entries;
+  if (ok) {
+    std::unordered_map<std::string, Entry> written;
+    for (const auto &[key, entry] : _entries) {
+      auto moved = copied.find(key);
+      if (entry.offset < copiedLength && moved != copied.end()) {
+        entries.emplace(key, moved->second);
+      } else {
+        written.emplace(key, entry);
+      }
+    }
+    ok = copyRecords(oldFd, newFd, newLength, written) && fsync(newFd) == 0;
+    entries.merge(written);
+  }
+
+  // Renaming the new index over the old one is what switches generations
+  if (ok) {
+    std::swap(_entries, entries);
+    ok = writeIndex(newGeneration, newLength);
+    if (!ok) {
+      std::swap(_entries, entries);
+    }
+  }
+
+  if (!ok) {
+    if (newFd >= 0) {
+      ::close(newFd);
+      unlink(dataPath(newGeneration).c_str());
+    }
+    return false;
+  }
+
+  _generation = newGeneration;
+  _fd = newFd;
+  _dataLength = newLength;
+  _mapping.reset();
+  _unflushedRecords = 0;
+  ::close(oldFd);
+  unlink(dataPath(oldGeneration).c_str());
+  return true;
+}
+
+} // namespace waveform
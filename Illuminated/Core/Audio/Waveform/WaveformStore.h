@@ -0,0 +1,121 @@
+//
+//  WaveformStore.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// Every cached peak file packed into one append-only data file, read through a memory map, plus a small index
+/// from key to record. Plain C++ with no Foundation dependency.
+///
+/// Files in the store directory:
+///   waveforms-<generation>.data  file header, then records: u32 magic, u16 key length, u16 flags,
+///                                u32 payload length, u32 checksum, key, payload, each part padded to 8 bytes
+///   waveforms.index              generation, committed data length and every live entry, replaced by rename
+///
+/// The index rename is the only commit point. Records appended after the last index write are replayed from the
+/// data file on open and a torn tail is dropped, so a crash loses at most the record being written. Compaction
+/// copies live records into the next generation and commits it with the same rename.
+namespace waveform {
+
+class WaveformStore {
+public:
+  /// Payload bytes plus whatever keeps them mapped. Stays valid after later writes, compaction or destroying the
+  /// store.
+  struct Blob {
+    std::shared_ptr<const void> owner;
+    std::span<const uint8_t> bytes;
+
+    explicit operator bool() const {
+      return owner != nullptr;
+    }
+  };
+
+  struct Stats {
+    size_t entries = 0;
+    uint64_t liveBytes = 0;
+    uint64_t dataBytes = 0;
+  };
+
+  /// Keys are at most this long, fingerprints and UUID strings fit easily.
+  static constexpr size_t kMaxKeyLength = 255;
+
+  explicit WaveformStore(std::string directory);
+  ~WaveformStore();
+
+  WaveformStore(const WaveformStore &) = delete;
+  WaveformStore &operator=(const WaveformStore &) = delete;
+
+  /// Opens the committed generation, or creates an empty store. Removes files left behind by an interrupted
+  /// compaction.
+  bool open();
+
+  /// Zero-copy lookup, an empty blob if the key is unknown.
+  Blob find(std::string_view key);
+  bool contains(std::string_view key) const;
+
+  /// Appends a record, replacing any previous payload for the key.
+  bool put(std::string_view key, std::span<const uint8_t> bytes);
+  bool remove(std::string_view key);
+
+  /// Syncs the data file and commits a new index.
+  bool flush();
+
+  /// Rewrites the live records into a new generation once dead records take up `deadFraction` of the data file
+  /// and at least `minimumDeadBytes`. The copy runs without the lock, so lookups and writes carry on meanwhile and
+  /// only wait for the records written during the copy to follow, and for the index swap. False when another
+  /// compaction is running, and on failure, which leaves the store as it was.
+  bool compactIfNeeded(double deadFraction = 0.5, uint64_t minimumDeadBytes = 1 << 20);
+  bool compact();
+
+  Stats stats() const;
+
+private:
+  struct Entry {
+    uint64_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  struct Mapping;
+
+  std::string dataPath(uint64_t generation) const;
+  std::string indexPath() const;
+
+  bool openData(uint64_t generation, bool create);
+  bool loadIndex(uint64_t &dataLength);
+  bool writeIndex(uint64_t generation, uint64_t dataLength);
+  bool commit();
+  bool compactUnlocked(std::unique_lock<std::mutex> &lock);
+  bool copyRecords(int from, int to, uint64_t &length, std::unordered_map<std::string, Entry> &entries);
+  void replay(uint64_t from);
+  void removeStaleFiles();
+  bool append(int fd, uint64_t &offset, std::string_view key, std::span<const uint8_t> bytes, uint16_t flags,
+              Entry *entry);
+  void closeData();
+
+  std::string _directory;
+  mutable std::mutex _mutex;
+
+  uint64_t _generation = 0;
+  int _fd = -1;
+  uint64_t _dataLength = 0;
+  std::shared_ptr<Mapping> _mapping;
+
+  std::unordered_map<std::string, Entry> _entries;
+  uint64_t _liveBytes = 0;
+  size_t _unflushedRecords = 0;
+  bool _compacting = false;
+};
+
+} // namespace waveform
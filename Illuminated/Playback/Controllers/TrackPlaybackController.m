@@ -8,6 +8,7 @@
 
 #import "TrackPlaybackController.h"
 #import "Album.h"
+#import "ArtworkManager.h"
 #import "BookmarkResolver.h"
 #import "Track+PlaybackItem.h"
 #import "Track.h"
@@ -120,7 +121,9 @@ static const NSTimeInterval kProgressTimerInterval = 0.5;
 }
 
 - (NSString *)currentArtworkPath {
-  return self.currentTrack.album.artworkPath;
+  // Artwork still embedded in the audio file has no path yet
+  NSString *artworkPath = self.currentTrack.album.artworkPath;
+  return [ArtworkManager fileURLForEmbeddedArtworkPath:artworkPath] ? nil : artworkPath;
 }
 
 #pragma mark - Public API
@@ -7,7 +7,6 @@
 
 #import "Album.h"
 #import "Artist.h"
-#import "ArtworkManager.h"
 #import "Track+PlaybackItem.h"
 #import "TrackService.h"
 
@@ -30,11 +29,7 @@
 }
 
 - (NSImage *)artworkImage {
-  if (self.album.artworkPath) {
-    return [ArtworkManager loadArtworkAtPath:self.album.artworkPath];
-  } else {
-    return [ArtworkManager placeholderImageWithSize:CGSizeMake(45, 45)];
-  }
+  return [TrackService loadArtworkForTrack:self withPlaceholderSize:CGSizeMake(45, 45)];
 }
 
 @end
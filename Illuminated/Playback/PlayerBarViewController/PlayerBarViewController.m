@@ -179,6 +179,26 @@ static NSTimeInterval const kScrubberResetDelay = 0.1;
   if (manager.currentTrack.bpm) {
     self.bpmLabel.stringValue = manager.currentTrack.roundedBPM.stringValue;
   }
+
+  if (manager.currentItemType == PlaybackItemTypeTrack) {
+    [self loadArtworkForCurrentTrack];
+  }
+}
+
+/// Artwork still embedded in the file shows as a placeholder until it has been read in the background.
+- (void)loadArtworkForCurrentTrack {
+  Track *track = (Track *)[AppPlaybackManager sharedManager].currentItem;
+
+  __weak typeof(self) weakSelf = self;
+  [[TrackService artworkForTrack:track] continueOnMainThreadWithBlock:^id(BFTask<NSImage *> *task) {
+    if (!task.result || [AppPlaybackManager sharedManager].currentItem != track) {
+      return nil;
+    }
+
+    weakSelf.trackArtwork.image = task.result;
+    [weakSelf updateNowPlayingInfo];
+    return nil;
+  }];
 }
 
 - (void)updatePlayPauseButton {
@@ -197,13 +217,23 @@ static NSTimeInterval const kScrubberResetDelay = 0.1;
 
   if (!url || !track) return;
 
-  self.waveformView.waveformImage = nil;
+  self.waveformView.peaks = nil;
 
   __weak typeof(self) weakSelf = self;
-  [[TrackService getWaveformForTrack:track resolvedURL:url size:self.waveformView.bounds.size]
-      continueOnMainThreadWithBlock:^id(BFTask<NSImage *> *task) {
+  WaveformProgressBlock progress = ^(NSData *partialPeaks, double fraction) {
+    // Generation keeps going after a track change, its updates belong to the old track
+    if ([AppPlaybackManager sharedManager].currentItem != track) return;
+    [weakSelf.waveformView setPartialPeaks:partialPeaks loadedFraction:fraction];
+  };
+
+  [[TrackService getWaveformPeaksForTrack:track resolvedURL:url progress:progress]
+      continueOnMainThreadWithBlock:^id(BFTask<NSData *> *task) {
+        if ([AppPlaybackManager sharedManager].currentItem != track) {
+          return nil;
+        }
+
         if (task.result) {
-          weakSelf.waveformView.waveformImage = task.result;
+          weakSelf.waveformView.peaks = task.result;
         } else {
           NSLog(@"Error loading waveform: %@", task.error);
         }
@@ -14,7 +14,13 @@ NS_ASSUME_NONNULL_BEGIN
 @interface WaveformView : NSView
 
 @property(nonatomic, weak) id<WaveformViewDelegate> delegate;
-@property(nonatomic, strong, nullable) NSImage *waveformImage;
+/// Peak file from `TrackService`, redrawn whenever the view changes size.
+@property(nonatomic, strong, nullable) NSData *peaks;
+/// Share of the width the peaks cover, from the left. Below 1 while the waveform is still being generated.
+@property(nonatomic, readonly) double loadedFraction;
+
+/// Shows the part decoded so far and leaves the rest empty.
+- (void)setPartialPeaks:(NSData *)peaks loadedFraction:(double)fraction;
 @property(nonatomic) double progress;
 
 @end
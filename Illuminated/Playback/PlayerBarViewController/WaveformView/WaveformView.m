@@ -6,13 +6,57 @@
 //
 
 #import "WaveformView.h"
+#import "WaveformGenerator.h"
 
 @implementation WaveformView {
   NSTrackingArea *_trackingArea;
+  NSImage *_waveformImage;
+  CGFloat _waveformScale;
+  NSInteger _waveformPlayedColumns;
 }
 
-- (void)setWaveformImage:(NSImage *)waveformImage {
-  _waveformImage = waveformImage;
+- (void)setPeaks:(NSData *)peaks {
+  [self setPartialPeaks:peaks loadedFraction:1.0];
+}
+
+- (void)setPartialPeaks:(NSData *)peaks loadedFraction:(double)fraction {
+  _peaks = peaks;
+  _loadedFraction = MAX(0.0, MIN(1.0, fraction));
+  _waveformImage = nil;
+  [self setNeedsDisplay:YES];
+}
+
+- (NSRect)waveformRect {
+  NSRect rect = self.bounds;
+  rect.size.width = round(rect.size.width * self.loadedFraction);
+  return rect;
+}
+
+/// Rendered lazily at the current size and backing scale, so resizing redraws from the peaks instead of stretching.
+/// Playback only re-renders once the played part has grown by a whole device pixel.
+- (NSImage *)waveformImage {
+  NSSize size = [self waveformRect].size;
+  if (!self.peaks || size.width < 1) return nil;
+
+  CGFloat scale = self.window.backingScaleFactor ?: 1.0;
+  double playedFraction = MIN(self.bounds.size.width * self.progress / size.width, 1.0);
+  NSInteger playedColumns = (NSInteger)floor(playedFraction * size.width * scale);
+
+  if (!_waveformImage || !NSEqualSizes(_waveformImage.size, size) || _waveformScale != scale ||
+      _waveformPlayedColumns != playedColumns) {
+    _waveformImage = [WaveformGenerator renderWaveformFromPeaks:self.peaks
+                                                           size:size
+                                                          scale:scale
+                                                 playedFraction:playedColumns / (size.width * scale)];
+    _waveformScale = scale;
+    _waveformPlayedColumns = playedColumns;
+  }
+  return _waveformImage;
+}
+
+- (void)viewDidChangeBackingProperties {
+  [super viewDidChangeBackingProperties];
+  _waveformImage = nil;
   [self setNeedsDisplay:YES];
 }
 
@@ -28,19 +72,16 @@
   [[NSColor.blackColor colorWithAlphaComponent:0.2] setFill];
   NSRectFill(self.bounds);
 
-  if (self.waveformImage) {
-    [self.waveformImage drawInRect:self.bounds
-                          fromRect:NSZeroRect
-                         operation:NSCompositingOperationSourceOver
-                          fraction:1.0];
+  NSImage *waveformImage = [self waveformImage];
+  if (waveformImage) {
+    [waveformImage drawInRect:[self waveformRect]
+                     fromRect:NSZeroRect
+                    operation:NSCompositingOperationSourceOver
+                     fraction:1.0];
   }
 
+  // The played part is drawn two-tone by the renderer
   CGFloat needleX = self.bounds.size.width * self.progress;
-  NSRect progressRect = NSMakeRect(0, 0, needleX, self.bounds.size.height);
-
-  [[NSColor.systemBlueColor colorWithAlphaComponent:0.3] setFill];
-  NSRectFillUsingOperation(progressRect, NSCompositingOperationSourceAtop);
-
   NSRect needleRect = NSMakeRect(needleX - 1, 0, 2, self.bounds.size.height);
   [NSColor.whiteColor setFill];
   NSRectFill(needleRect);
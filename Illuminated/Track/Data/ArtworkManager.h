@@ -9,17 +9,31 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class BFTask<__covariant ResultType>;
+
+/// Artwork files are named after a hash of their content, so a cover shared by many albums is stored and written
+/// once. Albums refer to them through `artworkPath`, files no album refers to are removed by
+/// `removeArtworkUnreferencedBy:`.
 @interface ArtworkManager : NSObject
 
-+ (NSString *)saveArtwork:(NSData *)artworkData forUUID:(NSUUID *)uuid;
+/// Saves embedded picture bytes as JPEG. Bytes saved before are not decoded again.
++ (nullable NSString *)saveArtwork:(nullable NSData *)artworkData;
+
++ (nullable NSString *)saveArtworkFromImage:(NSImage *)image;
 
 + (NSImage *)loadArtworkAtPath:(NSString *)path;
 
-+ (void)deleteArtworkAtPath:(NSString *)path;
+/// Stands in for an album's artwork that is still embedded in `fileURL`, until it is first shown.
++ (NSString *)embeddedArtworkPathForFileURL:(NSURL *)fileURL;
+
+/// The audio file behind an `embeddedArtworkPathForFileURL:` path, nil for saved artwork.
++ (nullable NSURL *)fileURLForEmbeddedArtworkPath:(NSString *)path;
 
 + (NSImage *)placeholderImageWithSize:(CGSize)size;
 
-+ (NSString *)saveArtworkFromImage:(NSImage *)image forUUID:(NSUUID *)uuid;
+/// Deletes artwork files that `references` does not count, in the background. Files written or reused in the last
+/// hour are kept, they may belong to an import that has not been saved yet. Resolves to the number of files removed.
++ (BFTask<NSNumber *> *)removeArtworkUnreferencedBy:(NSCountedSet<NSString *> *)references;
 
 @end
 
@@ -6,9 +6,15 @@
 //
 
 #import "ArtworkManager.h"
+#import "BFExecutor.h"
+#import "BFTask.h"
+#import <CommonCrypto/CommonDigest.h>
 #import <Foundation/Foundation.h>
 
 NSString *const kArtworkDirectoryPath = @"Illuminated/Artwork";
+NSString *const kEmbeddedArtworkPrefix = @"embedded:";
+
+static const NSTimeInterval kCollectionGracePeriod = 60 * 60;
 
 @implementation ArtworkManager
 
@@ -28,11 +34,48 @@ NSString *const kArtworkDirectoryPath = @"Illuminated/Artwork";
   return artworkDir;
 }
 
-+ (NSString *)saveArtwork:(NSData *)artworkData forUUID:(NSUUID *)uuid {
-  if (!artworkData || !uuid) return nil;
+/// Hex SHA-256 of `data`, truncated to 128 bits.
++ (NSString *)contentHashForData:(NSData *)data {
+  unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+
+  NSMutableString *hash = [NSMutableString stringWithCapacity:32];
+  for (int i = 0; i < 16; i++) {
+    [hash appendFormat:@"%02x", digest[i]];
+  }
+  return hash;
+}
+
++ (NSString *)artworkPathForContentHash:(NSString *)hash {
+  NSString *filename = [NSString stringWithFormat:@"%@.jpg", hash];
+  return [[self artworkDirectory] stringByAppendingPathComponent:filename];
+}
+
++ (NSString *)embeddedArtworkPathForFileURL:(NSURL *)fileURL {
+  return [kEmbeddedArtworkPrefix stringByAppendingString:fileURL.path];
+}
+
++ (NSURL *)fileURLForEmbeddedArtworkPath:(NSString *)path {
+  if (![path hasPrefix:kEmbeddedArtworkPrefix]) return nil;
+  return [NSURL fileURLWithPath:[path substringFromIndex:kEmbeddedArtworkPrefix.length]];
+}
+
+/// Touches an existing file, so collection grants a reused cover the same grace period as a freshly written one.
+/// NO if there is no such file.
++ (BOOL)reuseArtworkAtPath:(NSString *)filePath {
+  return [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate : [NSDate date]}
+                                          ofItemAtPath:filePath
+                                                 error:nil];
+}
 
-  NSString *filename = [NSString stringWithFormat:@"%@.jpg", uuid.UUIDString];
-  NSString *filePath = [[self artworkDirectory] stringByAppendingPathComponent:filename];
++ (NSString *)saveArtwork:(NSData *)artworkData {
+  if (!artworkData) return nil;
+
+  // Named after the source bytes, so a cover seen before skips the decode and the JPEG encode
+  NSString *filePath = [self artworkPathForContentHash:[self contentHashForData:artworkData]];
+  if ([self reuseArtworkAtPath:filePath]) {
+    return filePath;
+  }
 
   NSImage *image = [[NSImage alloc] initWithData:artworkData];
   NSData *jpegData = [self jpegDataFromImage:image compressionQuality:0.8];
@@ -44,13 +87,12 @@ NSString *const kArtworkDirectoryPath = @"Illuminated/Artwork";
   return nil;
 }
 
-+ (NSString *)saveArtworkFromImage:(NSImage *)image forUUID:(NSUUID *)uuid {
++ (NSString *)saveArtworkFromImage:(NSImage *)image {
   NSData *jpegData = [self jpegDataFromImage:image compressionQuality:0.8];
+  if (!jpegData) return nil;
 
-  NSString *filename = [NSString stringWithFormat:@"%@.jpg", uuid.UUIDString];
-  NSString *filePath = [[self artworkDirectory] stringByAppendingPathComponent:filename];
-
-  if ([jpegData writeToFile:filePath atomically:YES]) {
+  NSString *filePath = [self artworkPathForContentHash:[self contentHashForData:jpegData]];
+  if ([self reuseArtworkAtPath:filePath] || [jpegData writeToFile:filePath atomically:YES]) {
     return filePath;
   }
 
@@ -58,14 +100,35 @@ NSString *const kArtworkDirectoryPath = @"Illuminated/Artwork";
 }
 
 + (NSImage *)loadArtworkAtPath:(NSString *)path {
-  if (!path) return nil;
+  if (!path || [path hasPrefix:kEmbeddedArtworkPrefix]) return nil;
   return [[NSImage alloc] initWithContentsOfFile:path];
 }
 
-+ (void)deleteArtworkAtPath:(NSString *)path {
-  if (path) {
-    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
-  }
++ (BFTask<NSNumber *> *)removeArtworkUnreferencedBy:(NSCountedSet<NSString *> *)references {
+  return [BFTask taskFromExecutor:[BFExecutor defaultExecutor] withBlock:^id {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *directory = [NSURL fileURLWithPath:[self artworkDirectory] isDirectory:YES];
+    NSArray<NSURL *> *files = [fileManager contentsOfDirectoryAtURL:directory
+                                         includingPropertiesForKeys:@[ NSURLContentModificationDateKey ]
+                                                            options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                              error:nil];
+
+    NSDate *cutoff = [NSDate dateWithTimeIntervalSinceNow:-kCollectionGracePeriod];
+    NSUInteger removedCount = 0;
+    for (NSURL *file in files) {
+      NSString *path = [[self artworkDirectory] stringByAppendingPathComponent:file.lastPathComponent];
+      if ([references countForObject:path] > 0) continue;
+
+      NSDate *modified = nil;
+      [file getResourceValue:&modified forKey:NSURLContentModificationDateKey error:nil];
+      if (modified && [modified compare:cutoff] == NSOrderedDescending) continue;
+
+      if ([fileManager removeItemAtURL:file error:nil]) {
+        removedCount++;
+      }
+    }
+    return @(removedCount);
+  }];
 }
 
 + (NSData *)jpegDataFromImage:(NSImage *)image compressionQuality:(CGFloat)quality {
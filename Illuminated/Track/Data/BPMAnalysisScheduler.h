@@ -0,0 +1,35 @@
+//
+//  BPMAnalysisScheduler.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Works through every track without a BPM in the background, a page at a time, and saves the results in batches.
+/// Runs at utility QoS, drops to a single analysis while something plays and pauses while the visualizer is on screen.
+/// Progress lives in the store itself, so a relaunch picks up where it stopped. Tracks that fail are stamped with
+/// `bpmAnalysisFailedAt` and left out of the fetch for the next page.
+@interface BPMAnalysisScheduler : NSObject
+
+@property(class, readonly, strong) BPMAnalysisScheduler *sharedScheduler;
+
+/// Tracks analyzed at once while nothing is playing.
+@property(nonatomic) NSUInteger maxConcurrentAnalyses;
+
+@property(nonatomic, readonly) BOOL isPaused;
+
+/// Tracks analyzed since `start`.
+@property(nonatomic, readonly) NSUInteger analyzedCount;
+
+- (void)start;
+
+/// Stops taking new tracks and saves whatever has been analyzed so far.
+- (void)stop;
+
+@end
+
+NS_ASSUME_NONNULL_END
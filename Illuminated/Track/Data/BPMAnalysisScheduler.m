@@ -0,0 +1,278 @@
+//
+//  BPMAnalysisScheduler.m
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "BPMAnalysisScheduler.h"
+#import "AppPlaybackManager.h"
+#import "BFExecutor.h"
+#import "BFTask.h"
+#import "BPMAnalyzer.h"
+#import "Track.h"
+#import "TrackDataStore.h"
+#import "TrackService.h"
+#import "VizualizationViewController.h"
+
+static const NSUInteger kDefaultConcurrentAnalyses = 2;
+static const NSUInteger kFetchLimit = 100;
+static const NSUInteger kWriteBatchSize = 25;
+static const NSTimeInterval kIdlePollInterval = 60.0;
+
+static void *PlaybackObservationContext = &PlaybackObservationContext;
+
+@interface BPMAnalysisScheduler ()
+
+@property(nonatomic, strong) BFExecutor *executor;
+@property(nonatomic, strong) NSTimer *idleTimer;
+
+@property(nonatomic, strong) NSMutableArray<Track *> *queue;
+@property(nonatomic, strong) NSMutableArray<NSManagedObjectID *> *pendingObjectIDs;
+@property(nonatomic, strong) NSMutableArray<BPMAnalysisResult *> *pendingResults;
+@property(nonatomic, strong) NSMutableArray<NSManagedObjectID *> *failedObjectIDs;
+
+@property(nonatomic) NSUInteger runningCount;
+@property(nonatomic) NSUInteger analyzedCount;
+@property(nonatomic) BOOL isRunning;
+@property(nonatomic) BOOL isFetching;
+@property(nonatomic) BOOL isVisualizerVisible;
+
+@end
+
+@implementation BPMAnalysisScheduler
+
++ (BPMAnalysisScheduler *)sharedScheduler {
+  static BPMAnalysisScheduler *sharedScheduler = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{ sharedScheduler = [[self alloc] init]; });
+  return sharedScheduler;
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _maxConcurrentAnalyses = kDefaultConcurrentAnalyses;
+    _executor = [BFExecutor executorWithDispatchQueue:dispatch_get_global_queue(QOS_CLASS_UTILITY, 0)];
+    _queue = [NSMutableArray array];
+    _pendingObjectIDs = [NSMutableArray array];
+    _pendingResults = [NSMutableArray array];
+    _failedObjectIDs = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (BOOL)isPaused {
+  return self.isVisualizerVisible;
+}
+
+- (NSUInteger)concurrencyLimit {
+  return AppPlaybackManager.sharedManager.isPlaying ? 1 : MAX(self.maxConcurrentAnalyses, 1);
+}
+
+#pragma mark - Lifecycle
+
+- (void)start {
+  if (self.isRunning) {
+    return;
+  }
+  self.isRunning = YES;
+
+  [AppPlaybackManager.sharedManager addObserver:self
+                                     forKeyPath:@"isPlaying"
+                                        options:NSKeyValueObservingOptionNew
+                                        context:PlaybackObservationContext];
+
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(visualizationDidAppear:)
+                                               name:VisualizationDidAppearNotification
+                                             object:nil];
+
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(visualizationDidDisappear:)
+                                               name:VisualizationDidDisappearNotification
+                                             object:nil];
+
+  [self scheduleNext];
+}
+
+- (void)stop {
+  if (!self.isRunning) {
+    return;
+  }
+  self.isRunning = NO;
+
+  [AppPlaybackManager.sharedManager removeObserver:self forKeyPath:@"isPlaying" context:PlaybackObservationContext];
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+
+  [self.idleTimer invalidate];
+  self.idleTimer = nil;
+  [self.queue removeAllObjects];
+
+  [self flushResults];
+}
+
+#pragma mark - Observers
+
+- (void)observeValueForKeyPath:(NSString *)keyPath
+                      ofObject:(id)object
+                        change:(NSDictionary *)change
+                       context:(void *)context {
+  if (context != PlaybackObservationContext) {
+    [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    return;
+  }
+
+  // Stopping playback frees up CPU for more analyses
+  dispatch_async(dispatch_get_main_queue(), ^{ [self scheduleNext]; });
+}
+
+- (void)visualizationDidAppear:(NSNotification *)notification {
+  self.isVisualizerVisible = YES;
+}
+
+- (void)visualizationDidDisappear:(NSNotification *)notification {
+  self.isVisualizerVisible = NO;
+  [self scheduleNext];
+}
+
+#pragma mark - Scheduling
+
+/// Main thread only. Starts analyses up to the current limit, or refills the queue once everything queued is done.
+- (void)scheduleNext {
+  if (!self.isRunning || self.isPaused) {
+    return;
+  }
+
+  while (self.runningCount < [self concurrencyLimit] && self.queue.count > 0) {
+    Track *track = self.queue.firstObject;
+    [self.queue removeObjectAtIndex:0];
+    [self analyzeTrack:track];
+  }
+
+  if (self.queue.count == 0 && self.runningCount == 0 && !self.isFetching) {
+    [self fetchNextPage];
+  }
+}
+
+- (void)fetchNextPage {
+  self.isFetching = YES;
+
+  // Unsaved results and failures would still read as missing a BPM, so save them before asking the store again
+  [[self flushResults] continueOnMainThreadWithBlock:^id(BFTask *_) {
+    BFTask *fetchTask = [TrackDataStore tracksWithoutBPMWithLimit:kFetchLimit];
+    return [fetchTask continueOnMainThreadWithBlock:^id(BFTask<NSArray<Track *> *> *task) {
+      self.isFetching = NO;
+      if (!self.isRunning) {
+        return nil;
+      }
+
+      if (task.result.count == 0) {
+        [self scheduleIdlePoll];
+        return nil;
+      }
+
+      [self.queue addObjectsFromArray:task.result];
+      [self scheduleNext];
+      return nil;
+    }];
+  }];
+}
+
+/// Newly imported tracks show up without a BPM, so look again every now and then once the library is done.
+- (void)scheduleIdlePoll {
+  [self.idleTimer invalidate];
+  self.idleTimer = [NSTimer scheduledTimerWithTimeInterval:kIdlePollInterval
+                                                    target:self
+                                                  selector:@selector(scheduleNext)
+                                                  userInfo:nil
+                                                   repeats:NO];
+}
+
+- (void)analyzeTrack:(Track *)track {
+  NSManagedObjectID *objectID = track.objectID;
+
+  NSURL *securityScopeURL = nil;
+  NSURL *url = [TrackService resolveTrackURL:track securityScopeURL:&securityScopeURL];
+  if (!url) {
+    [self markTrackFailed:objectID];
+    return;
+  }
+
+  self.runningCount++;
+  BFTask *analysisTask = [TrackService analyzeBPMAtURL:url executor:self.executor];
+  [analysisTask continueOnMainThreadWithBlock:^id(BFTask<BPMAnalysisResult *> *task) {
+    [securityScopeURL stopAccessingSecurityScopedResource];
+    self.runningCount--;
+
+    if (task.result.bpm > 0) {
+      [self.pendingObjectIDs addObject:objectID];
+      [self.pendingResults addObject:task.result];
+      self.analyzedCount++;
+
+      if (self.pendingObjectIDs.count >= kWriteBatchSize) {
+        [self flushResults];
+      }
+    } else {
+      [self markTrackFailed:objectID];
+    }
+
+    [self scheduleNext];
+    return nil;
+  }];
+}
+
+#pragma mark - Persistence
+
+- (BFTask *)flushResults {
+  BFTask *failuresTask = [self flushFailures];
+  if (self.pendingObjectIDs.count == 0) {
+    return failuresTask;
+  }
+
+  NSArray<NSManagedObjectID *> *objectIDs = [self.pendingObjectIDs copy];
+  NSArray<BPMAnalysisResult *> *results = [self.pendingResults copy];
+  [self.pendingObjectIDs removeAllObjects];
+  [self.pendingResults removeAllObjects];
+
+  BFTask *writeTask = [TrackDataStore updateBPMForTracksWithObjectIDs:objectIDs results:results];
+  writeTask = [BFTask taskForCompletionOfAllTasks:@[ failuresTask, writeTask ]];
+  return [writeTask continueWithBlock:^id(BFTask *task) {
+    if (task.error) {
+      NSLog(@"BPMAnalysisScheduler: Error saving %lu results. Error: %@",
+            (unsigned long)objectIDs.count,
+            task.error.localizedDescription);
+    } else {
+      NSLog(@"BPMAnalysisScheduler: Saved %lu results, %lu analyzed so far",
+            (unsigned long)objectIDs.count,
+            (unsigned long)self.analyzedCount);
+    }
+    return nil;
+  }];
+}
+
+- (BFTask *)flushFailures {
+  if (self.failedObjectIDs.count == 0) {
+    return [BFTask taskWithResult:nil];
+  }
+
+  NSArray<NSManagedObjectID *> *objectIDs = [self.failedObjectIDs copy];
+  [self.failedObjectIDs removeAllObjects];
+
+  return [[TrackDataStore markBPMAnalysisFailedForTracksWithObjectIDs:objectIDs] continueWithBlock:^id(BFTask *task) {
+    if (task.error) {
+      NSLog(@"BPMAnalysisScheduler: Error marking %lu tracks as failed. Error: %@",
+            (unsigned long)objectIDs.count,
+            task.error.localizedDescription);
+    }
+    return nil;
+  }];
+}
+
+/// Unreadable or silent tracks get `bpmAnalysisFailedAt` so they are not picked up again on every page. Saved with
+/// the next batch of results. Playing one still retries it through the lazy path in the track list.
+- (void)markTrackFailed:(NSManagedObjectID *)objectID {
+  [self.failedObjectIDs addObject:objectID];
+}
+
+@end
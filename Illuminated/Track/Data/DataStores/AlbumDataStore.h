@@ -10,7 +10,8 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class Album, Artist;
-@class NSManagedObjectContext, NSFetchedResultsController;
+@class NSManagedObjectContext, NSManagedObjectID, NSFetchedResultsController;
+@class BFTask<__covariant ResultType>;
 
 @interface AlbumDataStore : NSObject
 
@@ -18,8 +19,20 @@ NS_ASSUME_NONNULL_BEGIN
                               artist:(nullable Artist *)artist
                            inContext:(NSManagedObjectContext *)context;
 
++ (Album *)insertAlbumWithName:(NSString *)albumName
+                        artist:(nullable Artist *)artist
+                     inContext:(NSManagedObjectContext *)context;
+
+/// Every album titled one of `albumNames`, with their artists, in one fetch.
++ (NSArray<Album *> *)albumsWithNames:(NSArray<NSString *> *)albumNames inContext:(NSManagedObjectContext *)context;
+
 + (NSFetchedResultsController *)fetchedResultsController;
 
+/// How many albums use each artwork path.
++ (BFTask<NSCountedSet<NSString *> *> *)artworkPathReferenceCounts;
+
++ (BFTask *)updateArtworkPathForAlbumWithObjectID:(NSManagedObjectID *)objectID artworkPath:(NSString *)artworkPath;
+
 @end
 
 NS_ASSUME_NONNULL_END
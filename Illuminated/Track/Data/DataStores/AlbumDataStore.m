@@ -25,15 +25,29 @@
 
   Album *album = [context firstObjectForEntityName:EntityNameAlbum predicate:predicate];
   if (!album) {
-    album = [context insertNewObjectForEntityName:EntityNameAlbum];
-    album.uniqueID = [NSUUID new];
-    album.title = albumName;
-    album.artist = artist;
+    album = [self insertAlbumWithName:albumName artist:artist inContext:context];
   }
 
   return album;
 }
 
++ (Album *)insertAlbumWithName:(NSString *)albumName
+                        artist:(nullable Artist *)artist
+                     inContext:(NSManagedObjectContext *)context {
+  Album *album = [context insertNewObjectForEntityName:EntityNameAlbum];
+  album.uniqueID = [NSUUID new];
+  album.title = albumName;
+  album.artist = artist;
+  return album;
+}
+
++ (NSArray<Album *> *)albumsWithNames:(NSArray<NSString *> *)albumNames inContext:(NSManagedObjectContext *)context {
+  NSFetchRequest *request = [NSFetchRequest fetchRequestWithEntityName:EntityNameAlbum];
+  request.predicate = [NSPredicate predicateWithFormat:@"title IN %@", albumNames];
+  request.relationshipKeyPathsForPrefetching = @[ @"artist" ];
+  return [context executeFetchRequest:request error:nil] ?: @[];
+}
+
 + (NSFetchedResultsController *)fetchedResultsController {
   NSSortDescriptor *albumSort = [NSSortDescriptor sortDescriptorWithKey:@"title" ascending:YES];
   return [[CoreDataStore reader] fetchedResultsControllerForEntity:EntityNameAlbum
@@ -41,4 +55,29 @@
                                                    sortDescriptors:@[ albumSort ]];
 }
 
++ (BFTask<NSCountedSet<NSString *> *> *)artworkPathReferenceCounts {
+  return [[CoreDataStore reader] performRead:^id(NSManagedObjectContext *context) {
+    NSFetchRequest *request = [NSFetchRequest fetchRequestWithEntityName:EntityNameAlbum];
+    request.predicate = [NSPredicate predicateWithFormat:@"artworkPath != nil"];
+    request.resultType = NSDictionaryResultType;
+    request.propertiesToFetch = @[ @"artworkPath" ];
+
+    NSCountedSet<NSString *> *references = [NSCountedSet set];
+    for (NSDictionary *row in [context executeFetchRequest:request error:nil]) {
+      [references addObject:row[@"artworkPath"]];
+    }
+    return references;
+  }];
+}
+
++ (BFTask *)updateArtworkPathForAlbumWithObjectID:(NSManagedObjectID *)objectID artworkPath:(NSString *)artworkPath {
+  return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+    Album *album = [context objectWithID:objectID];
+    if (album) {
+      album.artworkPath = artworkPath;
+    }
+    return nil;
+  }];
+}
+
 @end
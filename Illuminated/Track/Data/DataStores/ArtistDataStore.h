@@ -15,6 +15,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (Artist *)findOrCreateArtistWithName:(NSString *)artistName usingContext:(NSManagedObjectContext *)context;
 
++ (Artist *)insertArtistWithName:(NSString *)artistName inContext:(NSManagedObjectContext *)context;
+
+/// Every artist named one of `artistNames`, in one fetch.
++ (NSArray<Artist *> *)artistsWithNames:(NSArray<NSString *> *)artistNames inContext:(NSManagedObjectContext *)context;
+
 @end
 
 NS_ASSUME_NONNULL_END
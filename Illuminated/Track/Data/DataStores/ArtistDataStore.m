@@ -16,12 +16,23 @@
   Artist *artist = [context firstObjectForEntityName:EntityNameArtist
                                            predicate:[NSPredicate predicateWithFormat:@"name == %@", artistName]];
   if (!artist) {
-    artist = [context insertNewObjectForEntityName:EntityNameArtist];
-    artist.uniqueID = [NSUUID new];
-    artist.name = artistName;
+    artist = [self insertArtistWithName:artistName inContext:context];
   }
 
   return artist;
 }
 
++ (Artist *)insertArtistWithName:(NSString *)artistName inContext:(NSManagedObjectContext *)context {
+  Artist *artist = [context insertNewObjectForEntityName:EntityNameArtist];
+  artist.uniqueID = [NSUUID new];
+  artist.name = artistName;
+  return artist;
+}
+
++ (NSArray<Artist *> *)artistsWithNames:(NSArray<NSString *> *)artistNames inContext:(NSManagedObjectContext *)context {
+  return [context allObjectsForEntityName:EntityNameArtist
+                                predicate:[NSPredicate predicateWithFormat:@"name IN %@", artistNames]
+                          sortDescriptors:nil];
+}
+
 @end
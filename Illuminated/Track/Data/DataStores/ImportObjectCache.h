@@ -0,0 +1,35 @@
+//
+//  ImportObjectCache.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class Album, Artist;
+@class NSManagedObjectContext;
+
+/// Artists and albums one import has resolved, by name, so tracks sharing them cost no fetch. Holds object IDs, not
+/// objects, so it outlives the batches and their saves. Only use it from the writer context's queue.
+@interface ImportObjectCache : NSObject
+
+/// Looks up every artist and album named in `metadata` not seen yet, one fetch each for artists and albums.
+- (void)prefetchObjectsForMetadata:(NSArray<NSDictionary *> *)metadata inContext:(NSManagedObjectContext *)context;
+
+/// Inserts the artist if neither the store nor this import has it yet.
+- (Artist *)artistWithName:(NSString *)artistName inContext:(NSManagedObjectContext *)context;
+
+/// Same as `AlbumDataStore findOrCreateAlbumWithName:artist:inContext:`, without the fetch.
+- (Album *)albumWithName:(NSString *)albumName
+                  artist:(nullable Artist *)artist
+               inContext:(NSManagedObjectContext *)context;
+
+/// Gives the artists and albums inserted since the last call permanent IDs, so they can be cached across saves.
+- (void)finishBatchInContext:(NSManagedObjectContext *)context;
+
+@end
+
+NS_ASSUME_NONNULL_END
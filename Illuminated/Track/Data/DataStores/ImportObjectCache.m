@@ -0,0 +1,181 @@
+//
+//  ImportObjectCache.m
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "ImportObjectCache.h"
+#import "Album.h"
+#import "AlbumDataStore.h"
+#import "Artist.h"
+#import "ArtistDataStore.h"
+#import "CoreDataStore.h"
+
+static NSString *AlbumKey(NSString *albumName, NSString *_Nullable artistName) {
+  return [NSString stringWithFormat:@"%@\n%@", albumName, artistName ?: @""];
+}
+
+@interface ImportObjectCache ()
+
+@property(nonatomic, strong) NSMutableDictionary<NSString *, NSManagedObjectID *> *artistIDs;
+/// By `AlbumKey`.
+@property(nonatomic, strong) NSMutableDictionary<NSString *, NSManagedObjectID *> *albumIDs;
+/// Any album with the name, for tracks without an artist.
+@property(nonatomic, strong) NSMutableDictionary<NSString *, NSManagedObjectID *> *albumIDsByName;
+
+@property(nonatomic, strong) NSMutableSet<NSString *> *prefetchedArtistNames;
+@property(nonatomic, strong) NSMutableSet<NSString *> *prefetchedAlbumNames;
+
+// Inserted in the current batch, their IDs are temporary until `finishBatchInContext:`
+@property(nonatomic, strong) NSMutableDictionary<NSString *, Artist *> *insertedArtists;
+@property(nonatomic, strong) NSMutableDictionary<NSString *, Album *> *insertedAlbums;
+@property(nonatomic, strong) NSMutableDictionary<NSString *, Album *> *insertedAlbumsByName;
+
+@end
+
+@implementation ImportObjectCache
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _artistIDs = [NSMutableDictionary dictionary];
+    _albumIDs = [NSMutableDictionary dictionary];
+    _albumIDsByName = [NSMutableDictionary dictionary];
+    _prefetchedArtistNames = [NSMutableSet set];
+    _prefetchedAlbumNames = [NSMutableSet set];
+    _insertedArtists = [NSMutableDictionary dictionary];
+    _insertedAlbums = [NSMutableDictionary dictionary];
+    _insertedAlbumsByName = [NSMutableDictionary dictionary];
+  }
+  return self;
+}
+
+- (void)prefetchObjectsForMetadata:(NSArray<NSDictionary *> *)metadata inContext:(NSManagedObjectContext *)context {
+  NSMutableSet<NSString *> *artistNames = [NSMutableSet set];
+  NSMutableSet<NSString *> *albumNames = [NSMutableSet set];
+  for (NSDictionary *item in metadata) {
+    if (item[@"artist"] && ![self.prefetchedArtistNames containsObject:item[@"artist"]]) {
+      [artistNames addObject:item[@"artist"]];
+    }
+    if (item[@"album"] && ![self.prefetchedAlbumNames containsObject:item[@"album"]]) {
+      [albumNames addObject:item[@"album"]];
+    }
+  }
+
+  if (artistNames.count > 0) {
+    for (Artist *artist in [ArtistDataStore artistsWithNames:artistNames.allObjects inContext:context]) {
+      if (!self.artistIDs[artist.name]) {
+        self.artistIDs[artist.name] = artist.objectID;
+      }
+    }
+    [self.prefetchedArtistNames unionSet:artistNames];
+  }
+
+  if (albumNames.count > 0) {
+    for (Album *album in [AlbumDataStore albumsWithNames:albumNames.allObjects inContext:context]) {
+      NSString *key = AlbumKey(album.title, album.artist.name);
+      if (!self.albumIDs[key]) {
+        self.albumIDs[key] = album.objectID;
+      }
+      if (!self.albumIDsByName[album.title]) {
+        self.albumIDsByName[album.title] = album.objectID;
+      }
+    }
+    [self.prefetchedAlbumNames unionSet:albumNames];
+  }
+}
+
+- (Artist *)artistWithName:(NSString *)artistName inContext:(NSManagedObjectContext *)context {
+  Artist *artist = self.insertedArtists[artistName] ?: [self objectWithID:self.artistIDs[artistName] inContext:context];
+  if (artist) {
+    return artist;
+  }
+
+  // Nothing to fetch for a name the prefetch already missed. A cached ID that went stale, e.g. the artist was
+  // deleted mid-import, goes back to a regular lookup.
+  if ([self.prefetchedArtistNames containsObject:artistName] && !self.artistIDs[artistName]) {
+    artist = [ArtistDataStore insertArtistWithName:artistName inContext:context];
+  } else {
+    artist = [ArtistDataStore findOrCreateArtistWithName:artistName usingContext:context];
+  }
+
+  if (artist.objectID.isTemporaryID) {
+    self.insertedArtists[artistName] = artist;
+  } else {
+    self.artistIDs[artistName] = artist.objectID;
+  }
+  return artist;
+}
+
+- (Album *)albumWithName:(NSString *)albumName
+                  artist:(nullable Artist *)artist
+               inContext:(NSManagedObjectContext *)context {
+  NSString *key = AlbumKey(albumName, artist.name);
+  NSMutableDictionary<NSString *, NSManagedObjectID *> *albumIDs = artist ? self.albumIDs : self.albumIDsByName;
+  NSMutableDictionary<NSString *, Album *> *insertedAlbums = artist ? self.insertedAlbums : self.insertedAlbumsByName;
+  NSString *lookupKey = artist ? key : albumName;
+
+  Album *album = insertedAlbums[lookupKey] ?: [self objectWithID:albumIDs[lookupKey] inContext:context];
+  if (album) {
+    return album;
+  }
+
+  if ([self.prefetchedAlbumNames containsObject:albumName] && !albumIDs[lookupKey]) {
+    album = [AlbumDataStore insertAlbumWithName:albumName artist:artist inContext:context];
+  } else {
+    album = [AlbumDataStore findOrCreateAlbumWithName:albumName artist:artist inContext:context];
+  }
+
+  if (album.objectID.isTemporaryID) {
+    self.insertedAlbums[key] = album;
+    if (!self.insertedAlbumsByName[albumName] && !self.albumIDsByName[albumName]) {
+      self.insertedAlbumsByName[albumName] = album;
+    }
+  } else {
+    albumIDs[lookupKey] = album.objectID;
+  }
+  return album;
+}
+
+- (void)finishBatchInContext:(NSManagedObjectContext *)context {
+  NSMutableSet<NSManagedObject *> *objects = [NSMutableSet setWithArray:self.insertedArtists.allValues];
+  [objects addObjectsFromArray:self.insertedAlbums.allValues];
+  [objects addObjectsFromArray:self.insertedAlbumsByName.allValues];
+  if (objects.count == 0) {
+    return;
+  }
+
+  // Kept as objects on failure, which still works for as long as this context holds them
+  NSError *error = nil;
+  if (![context obtainPermanentIDsForObjects:objects.allObjects error:&error]) {
+    NSLog(@"ImportObjectCache: Failed to obtain permanent IDs. Error: %@", error.localizedDescription);
+    return;
+  }
+
+  [self.insertedArtists enumerateKeysAndObjectsUsingBlock:^(NSString *name, Artist *artist, BOOL *_) {
+    self.artistIDs[name] = artist.objectID;
+  }];
+  [self.insertedAlbums enumerateKeysAndObjectsUsingBlock:^(NSString *key, Album *album, BOOL *_) {
+    self.albumIDs[key] = album.objectID;
+  }];
+  [self.insertedAlbumsByName enumerateKeysAndObjectsUsingBlock:^(NSString *name, Album *album, BOOL *_) {
+    self.albumIDsByName[name] = album.objectID;
+  }];
+
+  [self.insertedArtists removeAllObjects];
+  [self.insertedAlbums removeAllObjects];
+  [self.insertedAlbumsByName removeAllObjects];
+}
+
+#pragma mark - Private
+
+/// Registered objects come back without a fetch, which is the case for everything this import touched.
+- (nullable id)objectWithID:(nullable NSManagedObjectID *)objectID inContext:(NSManagedObjectContext *)context {
+  if (!objectID) {
+    return nil;
+  }
+  return [context existingObjectWithID:objectID error:nil];
+}
+
+@end
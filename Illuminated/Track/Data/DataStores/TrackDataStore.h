@@ -10,7 +10,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class Track, Artist, Album;
+@class Track, Artist, Album, BPMAnalysisResult;
 @class NSManagedObjectContext, NSFetchedResultsController, NSManagedObjectID;
 @class BFTask<__covariant ResultType>;
 
@@ -35,11 +35,32 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (BFTask<Track *> *)trackWithURL:(NSURL *)url;
 
+/// The paths in `filePaths` some track already has, found with one indexed `IN` query per few hundred paths.
++ (BFTask<NSSet<NSString *> *> *)filePathsOfTracksAmongFilePaths:(NSArray<NSString *> *)filePaths;
+
+/// One dictionary per track with its `objectID`, `fileURL`, `urlBookmark`, `fileSize`, `fileModificationTime`,
+/// `fileInode` and `isMissing`, fetched as plain values off the main thread so even a large library faults in no track.
++ (BFTask<NSArray<NSDictionary<NSString *, id> *> *> *)fileStatesOfAllTracks;
+
+/// Sets `values[i]` on the track with `objectIDs[i]` by key, a thousand tracks per save.
++ (BFTask *)updateTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs
+                               values:(NSArray<NSDictionary<NSString *, id> *> *)values;
+
 + (NSFetchedResultsController *)fetchedResultsController;
 
 + (BFTask *)deleteTrackWithObjectID:(NSManagedObjectID *)trackObjectID;
 
-+ (BFTask *)updateBPMForTrackWithFilePath:(NSString *)filePath bpm:(float)bpm;
++ (BFTask *)updateBPMForTrackWithFilePath:(NSString *)filePath bpm:(float)bpm confidence:(float)confidence;
+
+/// Up to `limit` tracks that have no BPM yet and have not failed analysis before.
++ (BFTask<NSArray<Track *> *> *)tracksWithoutBPMWithLimit:(NSUInteger)limit;
+
+/// Stores every result in a single write. `results[i]` belongs to `objectIDs[i]`.
++ (BFTask *)updateBPMForTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs
+                                    results:(NSArray<BPMAnalysisResult *> *)results;
+
+/// Stamps `bpmAnalysisFailedAt` with the current date on every track in a single write.
++ (BFTask *)markBPMAnalysisFailedForTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs;
 
 + (BFTask *)updateURLBookmarkForTrackWithObjectID:(NSManagedObjectID *)objectID urlBookmark:(NSData *)urlBookmark;
 
@@ -11,11 +11,18 @@
 #import "Artist.h"
 #import "ArtistDataStore.h"
 #import "BFTask.h"
+#import "BPMAnalyzer.h"
 #import "CoreDataStore.h"
 #import "Playlist.h"
 #import "Track.h"
 #import <Foundation/Foundation.h>
 
+/// Paths per `IN` query, well below SQLite's limit on bound variables.
+static const NSUInteger kFilePathFetchChunkSize = 500;
+
+/// Tracks per save in bulk updates, so a rescan of a large library does not hold the writer in one long save.
+static const NSUInteger kBulkUpdateChunkSize = 1000;
+
 @implementation TrackDataStore
 
 + (BFTask<Track *> *)trackWithURL:(NSURL *)url {
@@ -23,6 +30,78 @@
                                             predicate:[NSPredicate predicateWithFormat:@"fileURL == %@", [url path]]];
 }
 
++ (BFTask<NSSet<NSString *> *> *)filePathsOfTracksAmongFilePaths:(NSArray<NSString *> *)filePaths {
+  return [[CoreDataStore reader] performRead:^id(NSManagedObjectContext *context) {
+    NSMutableSet<NSString *> *existing = [NSMutableSet set];
+
+    NSFetchRequest *request = [NSFetchRequest fetchRequestWithEntityName:EntityNameTrack];
+    request.resultType = NSDictionaryResultType;
+    request.propertiesToFetch = @[ @"fileURL" ];
+    for (NSUInteger start = 0; start < filePaths.count; start += kFilePathFetchChunkSize) {
+      NSRange range = NSMakeRange(start, MIN(kFilePathFetchChunkSize, filePaths.count - start));
+      request.predicate = [NSPredicate predicateWithFormat:@"fileURL IN %@", [filePaths subarrayWithRange:range]];
+      for (NSDictionary *row in [context executeFetchRequest:request error:nil]) {
+        [existing addObject:row[@"fileURL"]];
+      }
+    }
+
+    // Dictionary fetches only see the store, tracks saved by the writer but not yet to disk are still pending here
+    NSSet<NSString *> *candidates = [NSSet setWithArray:filePaths];
+    for (NSManagedObject *object in context.insertedObjects) {
+      if ([object isKindOfClass:[Track class]] && [candidates containsObject:((Track *)object).fileURL]) {
+        [existing addObject:((Track *)object).fileURL];
+      }
+    }
+    return existing;
+  }];
+}
+
++ (BFTask<NSArray<NSDictionary<NSString *, id> *> *> *)fileStatesOfAllTracks {
+  // Runs on the writer for its private queue, nothing is changed so nothing is saved
+  return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+    NSExpressionDescription *objectID = [[NSExpressionDescription alloc] init];
+    objectID.name = @"objectID";
+    objectID.expression = [NSExpression expressionForEvaluatedObject];
+    objectID.expressionResultType = NSObjectIDAttributeType;
+
+    NSFetchRequest *request = [NSFetchRequest fetchRequestWithEntityName:EntityNameTrack];
+    request.resultType = NSDictionaryResultType;
+    request.propertiesToFetch =
+        @[ objectID, @"fileURL", @"urlBookmark", @"fileSize", @"fileModificationTime", @"fileInode", @"isMissing" ];
+
+    NSError *error = nil;
+    NSArray<NSDictionary *> *states = [context executeFetchRequest:request error:&error];
+    if (error) {
+      NSLog(@"Error fetching file states of tracks: %@", error.localizedDescription);
+    }
+    return states ?: @[];
+  }];
+}
+
++ (BFTask *)updateTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs
+                               values:(NSArray<NSDictionary<NSString *, id> *> *)values {
+  BFTask *task = [BFTask taskWithResult:nil];
+  for (NSUInteger start = 0; start < objectIDs.count; start += kBulkUpdateChunkSize) {
+    NSRange range = NSMakeRange(start, MIN(kBulkUpdateChunkSize, objectIDs.count - start));
+    task = [[task continueWithSuccessBlock:^id(BFTask *_) {
+      return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+        for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+          Track *track = [context existingObjectWithID:objectIDs[i] error:nil];
+          [track setValuesForKeysWithDictionary:values[i]];
+        }
+        return nil;
+      }];
+    }] continueWithSuccessBlock:^id(BFTask *_) {
+      // Saved tracks go back to faults, else the writer context keeps every one of them
+      return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+        [context refreshAllObjects];
+        return nil;
+      }];
+    }];
+  }
+  return task;
+}
+
 + (BFTask<Track *> *)trackWithObjectID:(NSManagedObjectID *)objectID {
   return [[CoreDataStore reader] fetchObjectWithID:objectID];
 }
@@ -86,18 +165,59 @@
   }];
 }
 
-+ (BFTask *)updateBPMForTrackWithFilePath:(NSString *)filePath bpm:(float)bpm {
++ (BFTask *)updateBPMForTrackWithFilePath:(NSString *)filePath bpm:(float)bpm confidence:(float)confidence {
   return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
     Track *track = [context firstObjectForEntityName:EntityNameTrack
                                            predicate:[NSPredicate predicateWithFormat:@"fileURL == %@", filePath]];
     if (track) {
       track.bpm = bpm;
+      track.bpmConfidence = confidence;
       return track;
     }
     return nil;
   }];
 }
 
++ (BFTask<NSArray<Track *> *> *)tracksWithoutBPMWithLimit:(NSUInteger)limit {
+  return [[CoreDataStore reader] performRead:^id(NSManagedObjectContext *context) {
+    NSFetchRequest *request = [NSFetchRequest fetchRequestWithEntityName:EntityNameTrack];
+    request.predicate = [NSPredicate predicateWithFormat:@"bpm <= 0 AND bpmAnalysisFailedAt == nil"];
+    request.fetchLimit = limit;
+
+    NSError *error = nil;
+    NSArray<Track *> *tracks = [context executeFetchRequest:request error:&error];
+    if (error) {
+      NSLog(@"Error fetching tracks without bpm: %@", error.localizedDescription);
+    }
+    return tracks ?: @[];
+  }];
+}
+
++ (BFTask *)updateBPMForTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs
+                                    results:(NSArray<BPMAnalysisResult *> *)results {
+  return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+    [objectIDs enumerateObjectsUsingBlock:^(NSManagedObjectID *objectID, NSUInteger idx, BOOL *stop) {
+      Track *track = [context existingObjectWithID:objectID error:nil];
+      if (track) {
+        track.bpm = results[idx].bpm;
+        track.bpmConfidence = results[idx].confidence;
+      }
+    }];
+    return nil;
+  }];
+}
+
++ (BFTask *)markBPMAnalysisFailedForTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs {
+  return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+    NSDate *now = [NSDate date];
+    for (NSManagedObjectID *objectID in objectIDs) {
+      Track *track = [context existingObjectWithID:objectID error:nil];
+      track.bpmAnalysisFailedAt = now;
+    }
+    return nil;
+  }];
+}
+
 + (BFTask *)deleteTrackWithObjectID:(NSManagedObjectID *)trackObjectID {
   return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
     Track *track = [context objectWithID:trackObjectID];
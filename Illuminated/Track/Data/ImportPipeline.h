@@ -0,0 +1,49 @@
+//
+//  ImportPipeline.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class Playlist;
+@class BFTask<__covariant ResultType>;
+@class BFCancellationToken;
+
+/// Imports files in three stages: the URLs handed to `addURLs:` are filtered against the store, probed for bookmarks
+/// and tags on the `MetadataExtractionPool`, then saved `batchSize` tracks per save. The probe stage runs at most two
+/// batches ahead of the saves, so memory stays flat however many files come in.
+@interface ImportPipeline : NSObject
+
+- (instancetype)initWithPlaylist:(nullable Playlist *)playlist NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Tracks per save. Set it before adding URLs.
+@property(nonatomic) NSUInteger batchSize;
+
+/// One unit per URL added, completed once it is saved, skipped as already imported or failed to probe.
+/// Cancelling it cancels the import.
+@property(nonatomic, strong, readonly) NSProgress *progress;
+
+/// Resolves to the number of tracks imported once `finish` was called and everything added before it is saved,
+/// or cancelled.
+@property(nonatomic, strong, readonly) BFTask<NSNumber *> *task;
+
+/// Cancelled by `cancel`, for stages feeding the pipeline to stop with it.
+@property(nonatomic, strong, readonly) BFCancellationToken *cancellationToken;
+
+/// Queues `urls` behind everything added before. Can be called as files are found, until `finish`.
+- (void)addURLs:(NSArray<NSURL *> *)urls;
+
+/// No more URLs are coming.
+- (void)finish;
+
+/// Stops probing new files. Tracks already probed are still saved.
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
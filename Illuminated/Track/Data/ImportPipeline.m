@@ -0,0 +1,206 @@
+//
+//  ImportPipeline.m
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "ImportPipeline.h"
+#import "BFCancellationTokenSource.h"
+#import "BFTask.h"
+#import "BFTaskCompletionSource.h"
+#import "ImportObjectCache.h"
+#import "MetadataExtractionPool.h"
+#import "TrackService.h"
+
+static const NSUInteger kDefaultBatchSize = 200;
+
+/// Probed results allowed in flight, in batches. More than one, so a batch can fill while the one before it saves.
+static const NSUInteger kBatchesInFlight = 2;
+
+@interface ImportPipeline ()
+
+@property(nonatomic, strong, nullable) Playlist *playlist;
+@property(nonatomic, strong) NSProgress *progress;
+@property(nonatomic, strong) BFCancellationTokenSource *cancellationSource;
+@property(nonatomic, strong) BFTaskCompletionSource *completionSource;
+@property(nonatomic, strong) ImportObjectCache *objectCache;
+@property(nonatomic, strong, nullable) MetadataExtractionRun *extractionRun;
+
+// Guarded by `lock`, along with the unit counts of `progress`
+@property(nonatomic, strong) NSLock *lock;
+@property(nonatomic, strong) BFTask *tail;
+@property(nonatomic) BOOL isFinished;
+@property(nonatomic) NSUInteger importedCount;
+@property(nonatomic, strong, nullable) NSError *saveError;
+
+// Only touched from the pool's delivery queue
+@property(nonatomic, strong) NSMutableArray<MetadataExtractionResult *> *batch;
+@property(nonatomic, strong) BFTaskCompletionSource *batchSource;
+
+@end
+
+@implementation ImportPipeline
+
+- (instancetype)initWithPlaylist:(Playlist *)playlist {
+  self = [super init];
+  if (self) {
+    _playlist = playlist;
+    _batchSize = kDefaultBatchSize;
+    _progress = [NSProgress discreteProgressWithTotalUnitCount:0];
+    _cancellationSource = [BFCancellationTokenSource cancellationTokenSource];
+    _completionSource = [BFTaskCompletionSource taskCompletionSource];
+    _objectCache = [[ImportObjectCache alloc] init];
+    _lock = [[NSLock alloc] init];
+    _tail = [BFTask taskWithResult:nil];
+    _batch = [NSMutableArray array];
+    _batchSource = [BFTaskCompletionSource taskCompletionSource];
+
+    __weak typeof(self) weakSelf = self;
+    _progress.cancellationHandler = ^{ [weakSelf cancel]; };
+  }
+  return self;
+}
+
+- (BFTask<NSNumber *> *)task {
+  return self.completionSource.task;
+}
+
+- (BFCancellationToken *)cancellationToken {
+  return self.cancellationSource.token;
+}
+
+- (void)addURLs:(NSArray<NSURL *> *)urls {
+  [self.lock lock];
+  if (self.isFinished) {
+    [self.lock unlock];
+    NSLog(@"ImportPipeline: Ignoring %lu files added after finish", (unsigned long)urls.count);
+    return;
+  }
+
+  if (!self.extractionRun) {
+    [self startExtractionRun];
+  }
+  self.progress.totalUnitCount += urls.count;
+  self.tail = [self.tail continueWithBlock:^id(BFTask *_) { return [self importURLs:urls]; }];
+  [self.lock unlock];
+}
+
+- (void)finish {
+  [self.lock lock];
+  self.isFinished = YES;
+  BFTask *tail = self.tail;
+  MetadataExtractionRun *extractionRun = self.extractionRun;
+  [self.lock unlock];
+
+  // Only now is the last batch short, every earlier one was filled across calls
+  [[tail continueWithBlock:^id(BFTask *_) {
+    [extractionRun finish];
+    return extractionRun.task;
+  }] continueWithBlock:^id(BFTask *_) {
+    [self.lock lock];
+    NSUInteger importedCount = self.importedCount;
+    NSError *saveError = self.saveError;
+    [self.lock unlock];
+
+    NSLog(@"ImportPipeline: Imported %lu of %lld files",
+          (unsigned long)importedCount,
+          self.progress.totalUnitCount);
+    if (self.cancellationSource.cancellationRequested) {
+      [self.completionSource trySetCancelled];
+    } else if (saveError) {
+      [self.completionSource trySetError:saveError];
+    } else {
+      [self.completionSource trySetResult:@(importedCount)];
+    }
+    return nil;
+  }];
+}
+
+- (void)cancel {
+  [self.cancellationSource cancel];
+}
+
+#pragma mark - Stages
+
+/// The probe stage for the whole import, so batches are cut across `addURLs:` calls and the window never drains
+/// between them. Called under `lock`.
+- (void)startExtractionRun {
+  NSUInteger batchSize = MAX(self.batchSize, 1);
+  self.extractionRun = [[MetadataExtractionPool sharedPool]
+      startRunWithMaxPendingResults:batchSize * kBatchesInFlight
+                  cancellationToken:self.cancellationSource.token
+                           delivery:^BFTask *(MetadataExtractionResult *result) {
+                             return [self collectResult:result batchSize:batchSize];
+                           }];
+}
+
+/// One `addURLs:` call at a time, so the run gets the new files in the order they were added.
+- (BFTask *)importURLs:(NSArray<NSURL *> *)urls {
+  if (self.cancellationSource.token.cancellationRequested) {
+    return nil;
+  }
+
+  return [[TrackService filterExistingURLs:urls] continueWithSuccessBlock:^id(BFTask<NSArray<NSURL *> *> *task) {
+    NSArray<NSURL *> *newURLs = task.result;
+    [self completeUnitCount:urls.count - newURLs.count];
+    [self.extractionRun addURLs:newURLs];
+    return nil;
+  }];
+}
+
+/// Holds each result's slot in the pool's window until the batch it joined is saved. The nil result at the end of the
+/// run flushes.
+- (BFTask *)collectResult:(MetadataExtractionResult *)result batchSize:(NSUInteger)batchSize {
+  if (result.error) {
+    NSLog(@"Error importing url %@: %@", result.fileURL.path, result.error.localizedDescription);
+    [self completeUnitCount:1];
+    return nil;
+  }
+
+  if (result) {
+    [self.batch addObject:result];
+  }
+
+  BFTask *batchTask = self.batchSource.task;
+  if (self.batch.count >= batchSize || (!result && self.batch.count > 0)) {
+    [self saveBatch];
+  }
+  return batchTask;
+}
+
+/// Units finish on the filter's, the pool's and the writer's queues, and `+=` on a progress is a read then a write.
+- (void)completeUnitCount:(int64_t)count {
+  [self.lock lock];
+  self.progress.completedUnitCount += count;
+  [self.lock unlock];
+}
+
+- (void)saveBatch {
+  NSArray<MetadataExtractionResult *> *results = [self.batch copy];
+  BFTaskCompletionSource *batchSource = self.batchSource;
+  [self.batch removeAllObjects];
+  self.batchSource = [BFTaskCompletionSource taskCompletionSource];
+
+  BFTask *saveTask = [TrackService saveTracksFromResults:results
+                                                playlist:self.playlist
+                                             objectCache:self.objectCache];
+  [saveTask continueWithBlock:^id(BFTask<NSNumber *> *task) {
+    [self.lock lock];
+    if (task.error) {
+      NSLog(@"ImportPipeline: Error saving %lu tracks. Error: %@",
+            (unsigned long)results.count,
+            task.error.localizedDescription);
+      self.saveError = self.saveError ?: task.error;
+    } else {
+      self.importedCount += results.count;
+    }
+    self.progress.completedUnitCount += results.count;
+    [self.lock unlock];
+
+    [batchSource setResult:nil];
+    return nil;
+  }];
+}
+
+@end
@@ -0,0 +1,44 @@
+//
+//  LibraryRescanner.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class BFTask<__covariant ResultType>;
+
+/// What one rescan found, in tracks unless noted.
+@interface LibraryRescanResult : NSObject
+
+/// Same size, modification time and inode as at the last read, includes tracks stamped for the first time.
+@property(nonatomic) NSUInteger unchangedCount;
+/// Stamp differed, tags were read again.
+@property(nonatomic) NSUInteger changedCount;
+/// File gone, flagged with `isMissing`.
+@property(nonatomic) NSUInteger missingCount;
+/// Flagged as missing before, back unchanged.
+@property(nonatomic) NSUInteger restoredCount;
+/// Could not be checked, left as they were.
+@property(nonatomic) NSUInteger unreadableCount;
+/// New files imported from the rescanned folders.
+@property(nonatomic) NSUInteger addedCount;
+
+@end
+
+/// Brings the library in line with the disk without reading every file. Each track's file gets one `stat()`, and only
+/// files whose size, modification time or inode moved since the last read are opened again for tags, through the
+/// track's bookmark. Vanished files flag their track instead of deleting it, so play counts and playlists survive an
+/// unplugged drive.
+@interface LibraryRescanner : NSObject
+
+/// Checks every track, then imports the audio files under `folderURLs` no track points at yet. The caller keeps
+/// `folderURLs` accessed until the task finishes.
++ (BFTask<LibraryRescanResult *> *)rescanWithFolderURLs:(NSArray<NSURL *> *)folderURLs;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,336 @@
+//
+//  LibraryRescanner.mm
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#import "LibraryRescanner.h"
+#import "BFExecutor.h"
+#import "BFTask.h"
+#import "BFTaskCompletionSource.h"
+#import "BookmarkResolver.h"
+#import "DirectoryScanner.h"
+#import "ImportObjectCache.h"
+#import "ImportPipeline.h"
+#import "MetadataExtractionPool.h"
+#import "TrackDataStore.h"
+#import "TrackService.h"
+#import <CoreData/CoreData.h>
+
+#include "DirectoryWalker.h"
+
+#include <string>
+#include <vector>
+
+/// Changed tracks per save. Rescans usually find few, so this mostly matters after retagging a whole library.
+static const NSUInteger kRefreshBatchSize = 200;
+static const NSUInteger kRefreshBatchesInFlight = 2;
+/// Security scopes held at once while re-reading, one per file handed to the pool and not yet delivered back.
+static const NSUInteger kRefreshScopesInFlight = kRefreshBatchSize * (kRefreshBatchesInFlight + 1);
+
+/// Values that record `stamp` on a track, which is also proof the file is there.
+static NSDictionary<NSString *, id> *ValuesForStamp(const library::FileStamp &stamp) {
+  return @{
+    @"fileSize" : @((int64_t)stamp.size),
+    @"fileModificationTime" : @(stamp.modificationTime),
+    @"fileInode" : @((int64_t)stamp.inode),
+    @"isMissing" : @NO,
+  };
+}
+
+@implementation LibraryRescanResult
+@end
+
+@interface LibraryRescanner ()
+
+@property(nonatomic, strong) LibraryRescanResult *result;
+@property(nonatomic, strong) NSMutableSet<NSString *> *knownPaths;
+@property(nonatomic, strong) NSMutableArray<NSManagedObjectID *> *changedIDs;
+/// The bookmark of each changed track, NSNull for none, and the path it was stat'ed at.
+@property(nonatomic, strong) NSMutableArray *changedBookmarks;
+@property(nonatomic, strong) NSMutableArray<NSString *> *changedPaths;
+@property(nonatomic, strong) ImportObjectCache *objectCache;
+@property(nonatomic, strong, nullable) MetadataExtractionRun *extractionRun;
+
+// Guarded by `self`, fed from the refresh stage and the pool's delivery queue
+@property(nonatomic) NSUInteger nextChangedIndex;
+@property(nonatomic) NSUInteger deliveredCount;
+@property(nonatomic, strong) NSMutableArray<NSManagedObjectID *> *fedIDs;
+@property(nonatomic, strong) NSMutableArray<NSURL *> *fedScopeURLs;
+
+// Only touched from the pool's delivery queue
+@property(nonatomic, strong) NSMutableArray<NSManagedObjectID *> *batchIDs;
+@property(nonatomic, strong) NSMutableArray<MetadataExtractionResult *> *batch;
+@property(nonatomic, strong) BFTaskCompletionSource *batchSource;
+
+@end
+
+@implementation LibraryRescanner
+
++ (BFTask<LibraryRescanResult *> *)rescanWithFolderURLs:(NSArray<NSURL *> *)folderURLs {
+  return [[[LibraryRescanner alloc] init] rescanWithFolderURLs:folderURLs];
+}
+
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    _result = [[LibraryRescanResult alloc] init];
+    _knownPaths = [NSMutableSet set];
+    _changedIDs = [NSMutableArray array];
+    _changedBookmarks = [NSMutableArray array];
+    _changedPaths = [NSMutableArray array];
+    _fedIDs = [NSMutableArray array];
+    _fedScopeURLs = [NSMutableArray array];
+    _objectCache = [[ImportObjectCache alloc] init];
+    _batchIDs = [NSMutableArray array];
+    _batch = [NSMutableArray array];
+    _batchSource = [BFTaskCompletionSource taskCompletionSource];
+  }
+  return self;
+}
+
+- (BFTask<LibraryRescanResult *> *)rescanWithFolderURLs:(NSArray<NSURL *> *)folderURLs {
+  CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+  BFExecutor *executor = [BFExecutor executorWithDispatchQueue:dispatch_get_global_queue(QOS_CLASS_UTILITY, 0)];
+
+  return [[[[[TrackDataStore fileStatesOfAllTracks]
+      continueWithExecutor:executor
+          withSuccessBlock:^id(BFTask<NSArray<NSDictionary *> *> *task) {
+            return [self checkTracksWithFileStates:task.result];
+          }] continueWithSuccessBlock:^id(BFTask *_) {
+    return [self refreshChangedTracks];
+  }] continueWithSuccessBlock:^id(BFTask *_) {
+    return [self importNewFilesInFolderURLs:folderURLs];
+  }] continueWithSuccessBlock:^id(BFTask *_) {
+    LibraryRescanResult *result = self.result;
+    NSLog(@"LibraryRescanner: %lu unchanged, %lu changed, %lu missing, %lu restored, %lu unreadable, %lu added "
+          @"in %.2fs",
+          (unsigned long)result.unchangedCount,
+          (unsigned long)result.changedCount,
+          (unsigned long)result.missingCount,
+          (unsigned long)result.restoredCount,
+          (unsigned long)result.unreadableCount,
+          (unsigned long)result.addedCount,
+          CFAbsoluteTimeGetCurrent() - start);
+    return result;
+  }];
+}
+
+#pragma mark - Stages
+
+/// Stats every track's file, records what can be settled without opening it and queues the rest for a re-read.
+- (BFTask *)checkTracksWithFileStates:(NSArray<NSDictionary *> *)fileStates {
+  NSMutableArray<NSDictionary *> *states = [NSMutableArray arrayWithCapacity:fileStates.count];
+  std::vector<std::string> paths;
+  paths.reserve(fileStates.count);
+  for (NSDictionary *state in fileStates) {
+    NSString *path = state[@"fileURL"];
+    if (path.length > 0) {
+      [states addObject:state];
+      [self.knownPaths addObject:path];
+      paths.emplace_back(path.fileSystemRepresentation);
+    }
+  }
+
+  std::vector<library::FileStatus> statuses = library::statFiles(paths);
+
+  LibraryRescanResult *result = self.result;
+  NSMutableArray<NSManagedObjectID *> *updatedIDs = [NSMutableArray array];
+  NSMutableArray<NSDictionary *> *updatedValues = [NSMutableArray array];
+  for (NSUInteger i = 0; i < states.count; i++) {
+    NSDictionary *state = states[i];
+    const library::FileStatus &status = statuses[i];
+    BOOL wasMissing = [state[@"isMissing"] boolValue];
+
+    if (status.state == library::FileState::Unreadable) {
+      result.unreadableCount++;
+      continue;
+    }
+    if (status.state == library::FileState::Missing) {
+      result.missingCount++;
+      if (!wasMissing) {
+        [updatedIDs addObject:state[@"objectID"]];
+        [updatedValues addObject:@{@"isMissing" : @YES}];
+      }
+      continue;
+    }
+
+    library::FileStamp stored{[state[@"fileSize"] unsignedLongLongValue],
+                              [state[@"fileModificationTime"] longLongValue],
+                              [state[@"fileInode"] unsignedLongLongValue]};
+    if (stored == library::FileStamp{}) {
+      // Imported before tracks were stamped. Its tags are taken as current, rather than re-reading the whole library
+      result.unchangedCount++;
+      [updatedIDs addObject:state[@"objectID"]];
+      [updatedValues addObject:ValuesForStamp(status.stamp)];
+    } else if (stored != status.stamp) {
+      result.changedCount++;
+      [self.changedIDs addObject:state[@"objectID"]];
+      [self.changedBookmarks addObject:state[@"urlBookmark"] ?: [NSNull null]];
+      [self.changedPaths addObject:state[@"fileURL"]];
+    } else if (wasMissing) {
+      result.restoredCount++;
+      [updatedIDs addObject:state[@"objectID"]];
+      [updatedValues addObject:@{@"isMissing" : @NO}];
+    } else {
+      result.unchangedCount++;
+    }
+  }
+
+  return [TrackDataStore updateTracksWithObjectIDs:updatedIDs values:updatedValues];
+}
+
+- (BFTask *)refreshChangedTracks {
+  if (self.changedIDs.count == 0) {
+    return nil;
+  }
+
+  self.extractionRun = [[MetadataExtractionPool sharedPool]
+      startRunWithMaxPendingResults:kRefreshBatchSize * kRefreshBatchesInFlight
+                  cancellationToken:nil
+                           delivery:^BFTask *(MetadataExtractionResult *result) {
+                             return [self collectResult:result];
+                           }];
+  [self feedChangedTracks];
+  return self.extractionRun.task;
+}
+
+/// Hands changed files to the run through their track's bookmark while fewer than `kRefreshScopesInFlight` wait to
+/// be delivered, so the sandbox never holds more scopes than that. Finishes the run once every one was handed over.
+- (void)feedChangedTracks {
+  @synchronized(self) {
+    if (self.nextChangedIndex == self.changedIDs.count) {
+      return;
+    }
+
+    NSMutableArray<NSURL *> *fileURLs = [NSMutableArray array];
+    while (self.nextChangedIndex < self.changedIDs.count &&
+           self.fedIDs.count - self.deliveredCount < kRefreshScopesInFlight) {
+      NSUInteger index = self.nextChangedIndex++;
+      NSURL *scopeURL = nil;
+      NSURL *fileURL = [self accessFileWithBookmark:self.changedBookmarks[index]
+                                               path:self.changedPaths[index]
+                                           scopeURL:&scopeURL];
+      if (!fileURL) {
+        self.result.changedCount--;
+        self.result.unreadableCount++;
+        continue;
+      }
+      [self.fedIDs addObject:self.changedIDs[index]];
+      [self.fedScopeURLs addObject:scopeURL];
+      [fileURLs addObject:fileURL];
+    }
+
+    if (fileURLs.count > 0) {
+      [self.extractionRun addURLs:fileURLs];
+    }
+    if (self.nextChangedIndex == self.changedIDs.count) {
+      [self.extractionRun finish];
+    }
+  }
+}
+
+/// Resolves a changed track's bookmark and accesses its security scope, handed back in `scopeURL` for the caller to
+/// release. A bookmark for a folder leads to `path` inside it. Nil when the track cannot be reached this way.
+- (NSURL *)accessFileWithBookmark:(id)bookmark path:(NSString *)path scopeURL:(NSURL **)scopeURL {
+  if (![bookmark isKindOfClass:[NSData class]]) {
+    NSLog(@"LibraryRescanner: No bookmark to re-read %@", path);
+    return nil;
+  }
+
+  NSError *error = nil;
+  NSURL *resolvedURL = [BookmarkResolver resolveAndAccessBookmarkData:bookmark error:&error];
+  if (!resolvedURL) {
+    NSLog(@"LibraryRescanner: Skipping re-read of %@. Error: %@", path, error.localizedDescription);
+    return nil;
+  }
+  *scopeURL = resolvedURL;
+
+  NSNumber *isDirectory = nil;
+  [resolvedURL getResourceValue:&isDirectory forKey:NSURLIsDirectoryKey error:nil];
+  return isDirectory.boolValue ? [NSURL fileURLWithPath:path isDirectory:NO] : resolvedURL;
+}
+
+/// Results come in the order their files were fed, which is how each finds its track. Its scope is released and the
+/// next file fed in its place. Holds the result's slot in the pool's window until its batch is saved. A nil result
+/// flushes.
+- (BFTask *)collectResult:(MetadataExtractionResult *)result {
+  if (result) {
+    NSManagedObjectID *objectID = nil;
+    @synchronized(self) {
+      NSUInteger index = self.deliveredCount++;
+      objectID = self.fedIDs[index];
+      [BookmarkResolver releaseAccessedURL:self.fedScopeURLs[index]];
+    }
+    [self feedChangedTracks];
+
+    if (result.error) {
+      NSLog(@"LibraryRescanner: Error re-reading %@: %@", result.fileURL.path, result.error.localizedDescription);
+      return nil;
+    }
+    [self.batchIDs addObject:objectID];
+    [self.batch addObject:result];
+  }
+
+  BFTask *batchTask = self.batchSource.task;
+  if (self.batch.count >= kRefreshBatchSize || (!result && self.batch.count > 0)) {
+    [self saveBatch];
+  }
+  return batchTask;
+}
+
+- (void)saveBatch {
+  NSArray<NSManagedObjectID *> *objectIDs = [self.batchIDs copy];
+  NSArray<MetadataExtractionResult *> *results = [self.batch copy];
+  BFTaskCompletionSource *batchSource = self.batchSource;
+  [self.batchIDs removeAllObjects];
+  [self.batch removeAllObjects];
+  self.batchSource = [BFTaskCompletionSource taskCompletionSource];
+
+  BFTask *saveTask = [TrackService refreshTracksWithObjectIDs:objectIDs
+                                                  fromResults:results
+                                                  objectCache:self.objectCache];
+  [saveTask continueWithBlock:^id(BFTask *task) {
+    if (task.error) {
+      NSLog(@"LibraryRescanner: Error saving %lu changed tracks. Error: %@",
+            (unsigned long)results.count,
+            task.error.localizedDescription);
+    }
+    [batchSource setResult:nil];
+    return nil;
+  }];
+}
+
+- (BFTask *)importNewFilesInFolderURLs:(NSArray<NSURL *> *)folderURLs {
+  if (folderURLs.count == 0) {
+    return nil;
+  }
+
+  // Known files are dropped here, against the paths fetched for the stat pass, instead of querying the store for
+  // every batch the walk finds
+  NSSet<NSString *> *knownPaths = [self.knownPaths copy];
+  ImportPipeline *pipeline = [[ImportPipeline alloc] initWithPlaylist:nil];
+  BFTask *scanTask = [DirectoryScanner scanURLs:folderURLs
+                              cancellationToken:pipeline.cancellationToken
+                                   batchHandler:^(NSArray<NSURL *> *fileURLs) {
+                                     NSIndexSet *newIndexes = [fileURLs
+                                         indexesOfObjectsPassingTest:^BOOL(NSURL *url, NSUInteger idx, BOOL *stop) {
+                                           return ![knownPaths containsObject:url.path];
+                                         }];
+                                     if (newIndexes.count > 0) {
+                                       [pipeline addURLs:[fileURLs objectsAtIndexes:newIndexes]];
+                                     }
+                                   }];
+  [scanTask continueWithBlock:^id(BFTask *_) {
+    [pipeline finish];
+    return nil;
+  }];
+
+  return [pipeline.task continueWithSuccessBlock:^id(BFTask<NSNumber *> *task) {
+    self.result.addedCount = task.result.unsignedIntegerValue;
+    return nil;
+  }];
+}
+
+@end
@@ -5,19 +5,46 @@
 //  Created by Alexandru Solomon on 20.01.2026.
 //
 
+#import "WaveformGenerator.h"
 #import <Cocoa/Cocoa.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class Track, Playlist;
+@class Track, Playlist, BPMAnalysisResult, MetadataExtractionResult, ImportObjectCache, ImportPipeline;
 
 @class BFTask<__covariant ResultType>;
+@class BFExecutor;
 
 @interface TrackService : NSObject
 
-+ (BFTask *)importAudioFilesAtURLs:(NSArray<NSURL *> *)filesURLs withPlaylist:(nullable Playlist *)playlist;
+/// Imports the audio files among `filesURLs`, folders included to any depth. The pipeline's `task` resolves to the
+/// number of tracks imported, its `progress` can be shown and cancelled.
++ (ImportPipeline *)importAudioFilesAtURLs:(NSArray<NSURL *> *)filesURLs withPlaylist:(nullable Playlist *)playlist;
 
-+ (BFTask<NSImage *> *)getWaveformForTrack:(Track *)track resolvedURL:(NSURL *)resolvedURL size:(CGSize)size;
+/// The URLs in `urls` no track points at yet.
++ (BFTask<NSArray<NSURL *> *> *)filterExistingURLs:(NSArray<NSURL *> *)urls;
+
+/// Inserts a track per result in a single save. Results that carry an error are the caller's to drop.
+/// Artists and albums are resolved through `objectCache`, share one across the batches of an import.
++ (BFTask<NSNumber *> *)saveTracksFromResults:(NSArray<MetadataExtractionResult *> *)results
+                                     playlist:(nullable Playlist *)playlist
+                                  objectCache:(ImportObjectCache *)objectCache;
+
+/// Re-reads changed files into their tracks in a single save, `results[i]` into `objectIDs[i]`. Tags, artist, album
+/// and the file's stamp are replaced, the analyzed BPM and waveform are kept.
++ (BFTask<NSNumber *> *)refreshTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs
+                                       fromResults:(NSArray<MetadataExtractionResult *> *)results
+                                       objectCache:(ImportObjectCache *)objectCache;
+
+/// Checks every track and imports new files from the music folder with a `LibraryRescanner`. Runs when the user
+/// asks for it, from the File menu.
++ (BFTask *)rescanLibrary;
+
+/// Peak file for the track's waveform, generated and cached on first use. Draw it with `WaveformGenerator`.
+/// `progress` only fires while generating.
++ (BFTask<NSData *> *)getWaveformPeaksForTrack:(Track *)track
+                                   resolvedURL:(NSURL *)resolvedURL
+                                      progress:(nullable WaveformProgressBlock)progress;
 
 + (BFTask *)importAudioFileAtURL:(NSURL *)fileURL playlist:(nullable Playlist *)playlist;
 
@@ -25,6 +52,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (BFTask *)analyzeBPMForTrackURL:(NSURL *)trackURL;
 
+/// Analyzes without saving, running every step on `executor` so background callers control the QoS.
++ (BFTask<BPMAnalysisResult *> *)analyzeBPMAtURL:(NSURL *)trackURL executor:(BFExecutor *)executor;
+
 + (BFTask<Track *> *)findOrInsertByURL:(nonnull NSURL *)url playlist:(nullable Playlist *)playlist;
 
 + (BFTask<Track *> *)findOrInsertByURL:(NSURL *)url bookmarkData:(NSData *)bookmarkData;
@@ -36,8 +66,16 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (BFTask *)deleteTracks:(NSArray<Track *> *)tracks;
 
+/// The album's saved artwork, or a placeholder while there is none or it is still embedded in the audio file.
 + (NSImage *)loadArtworkForTrack:(Track *)track withPlaceholderSize:(CGSize)size;
 
+/// The album's artwork, read from the audio file in the background first when it is still embedded there. Resolves
+/// to nil when the album has none. Call on the main thread.
++ (BFTask<NSImage *> *)artworkForTrack:(Track *)track;
+
+/// Removes artwork files no album refers to anymore, e.g. covers replaced in the metadata editor.
++ (BFTask *)collectUnusedArtwork;
+
 + (BFTask *)updateTrack:(Track *)track
               withTitle:(NSString *)title
              artistName:(NSString *)artistName
@@ -8,13 +8,20 @@
 #import "TrackService.h"
 #import "Album.h"
 #import "AlbumDataStore.h"
+#import "AnalysisCache.h"
 #import "Artist.h"
 #import "ArtistDataStore.h"
 #import "ArtworkManager.h"
+#import "BFExecutor.h"
 #import "BFTask.h"
 #import "BPMAnalyzer.h"
 #import "BookmarkResolver.h"
 #import "CoreDataStore.h"
+#import "DirectoryScanner.h"
+#import "ImportObjectCache.h"
+#import "ImportPipeline.h"
+#import "LibraryRescanner.h"
+#import "MetadataExtractionPool.h"
 #import "MetadataExtractor.h"
 #import "Track.h"
 #import "TrackDataStore.h"
@@ -22,6 +29,8 @@
 #import "WaveformGenerator.h"
 #import <AVFoundation/AVFoundation.h>
 
+static const NSUInteger kBPMAnalysisWindowCount = 6;
+
 @implementation TrackService
 
 + (BFTask<Track *> *)findOrInsertByURL:(nonnull NSURL *)url playlist:(nullable Playlist *)playlist {
@@ -48,11 +57,17 @@
 }
 
 + (BFTask<Track *> *)analyzeBPMForTrackURL:(NSURL *)trackURL {
-  AVURLAsset *asset = [AVURLAsset URLAssetWithURL:trackURL options:nil];
-  return [[[[self loadAudioTrackFromAsset:asset] continueWithSuccessBlock:^id(BFTask<AVAssetTrack *> *task) {
-    return [BPMAnalyzer analyzeBPMForAssetTrack:task.result];
-  }] continueWithSuccessBlock:^id(BFTask<NSNumber *> *task) {
-    return [TrackDataStore updateBPMForTrackWithFilePath:trackURL.path bpm:task.result.floatValue];
+  BFTask<BPMAnalysisResult *> *analysisTask =
+      [self BPMResultForURL:trackURL
+                   executor:[BFExecutor defaultExecutor]
+                   analysis:^BFTask<BPMAnalysisResult *> *(AVAssetTrack *track) {
+                     return [BPMAnalyzer analyzeWindowsForAssetTrack:track windowCount:kBPMAnalysisWindowCount];
+                   }];
+
+  return [[analysisTask continueWithSuccessBlock:^id(BFTask<BPMAnalysisResult *> *task) {
+    return [TrackDataStore updateBPMForTrackWithFilePath:trackURL.path
+                                                     bpm:task.result.bpm
+                                              confidence:task.result.confidence];
   }] continueWithBlock:^id(BFTask *task) {
     if (task.error) {
       NSLog(@"Error analyzing bpm for track: %@", task.error.localizedDescription);
@@ -62,36 +77,69 @@
   }];
 }
 
-+ (BFTask *)importAudioFilesAtURLs:(NSArray<NSURL *> *)filesURLs withPlaylist:(nullable Playlist *)playlist {
-  return [[self filterExistingURLs:filesURLs] continueWithSuccessBlock:^id(BFTask *task) {
-    NSArray<NSURL *> *urls = task.result;
++ (BFTask<BPMAnalysisResult *> *)analyzeBPMAtURL:(NSURL *)trackURL executor:(BFExecutor *)executor {
+  return [self BPMResultForURL:trackURL
+                      executor:executor
+                      analysis:^BFTask<BPMAnalysisResult *> *(AVAssetTrack *track) {
+                        return [BPMAnalyzer analyzeWindowsForAssetTrack:track
+                                                            windowCount:kBPMAnalysisWindowCount
+                                                                 engine:BPMAnalyzerEngineAutodifference
+                                                               executor:executor];
+                      }];
+}
 
-    NSMutableArray<BFTask *> *tasks = [NSMutableArray array];
-    for (NSURL *url in urls) {
-      NSError *error = nil;
-      NSData *bookmark = [BookmarkResolver bookmarkForURL:url error:&error];
-      if (error) {
-        [tasks addObject:[BFTask taskWithError:error]];
-        continue;
-        ;
+/// Serves known content straight from the analysis cache, otherwise runs `analysis` and caches what it finds.
++ (BFTask<BPMAnalysisResult *> *)BPMResultForURL:(NSURL *)trackURL
+                                        executor:(BFExecutor *)executor
+                                        analysis:(BFTask<BPMAnalysisResult *> * (^)(AVAssetTrack *track))analysis {
+  return [BFTask taskFromExecutor:executor withBlock:^id {
+    NSString *fingerprint = [AnalysisCache fingerprintForFileAtURL:trackURL];
+    NSDictionary *cached = [AnalysisCache resultsForFingerprint:fingerprint];
+    if ([cached[AnalysisCacheKeyBPM] doubleValue] > 0) {
+      return [[BPMAnalysisResult alloc] initWithBPM:[cached[AnalysisCacheKeyBPM] doubleValue]
+                                         confidence:[cached[AnalysisCacheKeyBPMConfidence] doubleValue]
+                                         windowBPMs:@[]];
+    }
+
+    AVURLAsset *asset = [AVURLAsset URLAssetWithURL:trackURL options:nil];
+    BFTask<AVAssetTrack *> *loadTask = [self loadAudioTrackFromAsset:asset];
+    return [[loadTask continueWithExecutor:executor withSuccessBlock:^id(BFTask<AVAssetTrack *> *task) {
+      return analysis(task.result);
+    }] continueWithSuccessBlock:^id(BFTask<BPMAnalysisResult *> *task) {
+      if (fingerprint && task.result.bpm > 0) {
+        NSDictionary *results =
+            @{AnalysisCacheKeyBPM : @(task.result.bpm), AnalysisCacheKeyBPMConfidence : @(task.result.confidence)};
+        [AnalysisCache storeResults:results forFingerprint:fingerprint];
       }
+      return task;
+    }];
+  }];
+}
 
-      NSDictionary *metadata = [MetadataExtractor extractMetadataFromFileAtURL:url];
-      [tasks addObject:[self saveTrackWithMetadata:metadata bookmark:bookmark fileURL:url playlist:playlist]];
-    }
++ (ImportPipeline *)importAudioFilesAtURLs:(NSArray<NSURL *> *)filesURLs withPlaylist:(nullable Playlist *)playlist {
+  ImportPipeline *pipeline = [[ImportPipeline alloc] initWithPlaylist:playlist];
 
-    return [BFTask taskForCompletionOfAllTasks:tasks];
+  // Folders are walked while the first files found are already being imported
+  BFTask *scanTask = [DirectoryScanner scanURLs:filesURLs
+                              cancellationToken:pipeline.cancellationToken
+                                   batchHandler:^(NSArray<NSURL *> *fileURLs) { [pipeline addURLs:fileURLs]; }];
+  [scanTask continueWithBlock:^id(BFTask *_) {
+    [pipeline finish];
+    return nil;
   }];
+  return pipeline;
 }
 
 + (BFTask<NSArray<NSURL *> *> *)filterExistingURLs:(NSArray<NSURL *> *)urls {
-  return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+  NSArray<NSString *> *paths = [urls valueForKey:@"path"];
+  return [[TrackDataStore filePathsOfTracksAmongFilePaths:paths] continueWithSuccessBlock:^id(BFTask *task) {
+    // Seeded with what is already imported, so a file dropped twice in one go is kept once
+    NSMutableSet<NSString *> *seen = [task.result mutableCopy];
     NSMutableArray<NSURL *> *nonExisting = [NSMutableArray array];
 
     for (NSURL *url in urls) {
-      BOOL exists = [context objectExistsForEntityName:EntityNameTrack
-                                             predicate:[NSPredicate predicateWithFormat:@"fileURL == %@", [url path]]];
-      if (!exists) {
+      if (![seen containsObject:url.path]) {
+        [seen addObject:url.path];
         [nonExisting addObject:url];
       }
     }
@@ -134,61 +182,224 @@
                                   bookmark:(NSData *)bookmark
                                    fileURL:(NSURL *)fileURL
                                   playlist:(nullable Playlist *)playlist {
+  // Content seen before, under any path, brings its earlier analysis along
+  NSString *fingerprint = [AnalysisCache fingerprintForFileAtURL:fileURL];
+  NSDictionary *cached = [AnalysisCache resultsForFingerprint:fingerprint];
+  NSString *waveformPath = [WaveformCacheManager hasPeaksForKey:fingerprint] ? fingerprint : nil;
 
   return [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
-    Artist *artist = nil;
-    NSString *artistName = metadata[@"artist"];
-    if (artistName) {
-      artist = [ArtistDataStore findOrCreateArtistWithName:artistName usingContext:context];
-    }
+    Track *track = [self insertTrackWithMetadata:metadata
+                                        bookmark:bookmark
+                                         fileURL:fileURL
+                                  cachedAnalysis:cached
+                                    waveformPath:waveformPath
+                                        playlist:playlist
+                                     objectCache:nil
+                                       inContext:context];
+    track.contentFingerprint = fingerprint;
+    return track;
+  }];
+}
+
++ (BFTask<NSNumber *> *)saveTracksFromResults:(NSArray<MetadataExtractionResult *> *)results
+                                     playlist:(nullable Playlist *)playlist
+                                  objectCache:(ImportObjectCache *)objectCache {
+  NSMutableArray<NSDictionary *> *cachedAnalyses = [NSMutableArray arrayWithCapacity:results.count];
+  NSMutableArray *waveformPaths = [NSMutableArray arrayWithCapacity:results.count];
+  for (MetadataExtractionResult *result in results) {
+    [cachedAnalyses addObject:[AnalysisCache resultsForFingerprint:result.fingerprint] ?: @{}];
+    [waveformPaths addObject:[WaveformCacheManager hasPeaksForKey:result.fingerprint] ? result.fingerprint
+                                                                                        : [NSNull null]];
+  }
 
-    Album *album = nil;
-    NSString *albumName = metadata[@"album"];
-    if (albumName) {
-      album = [AlbumDataStore findOrCreateAlbumWithName:albumName artist:artist inContext:context];
-      if (!album.artworkPath) {
-        album.artworkPath = [ArtworkManager saveArtwork:metadata[@"artwork"] forUUID:album.uniqueID];
+  NSArray<NSDictionary *> *metadata = [results valueForKey:@"metadata"];
+  BFTask *writeTask = [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+    [objectCache prefetchObjectsForMetadata:metadata inContext:context];
+    [results enumerateObjectsUsingBlock:^(MetadataExtractionResult *result, NSUInteger i, BOOL *_) {
+      Track *track = [self insertTrackWithMetadata:result.metadata
+                                          bookmark:result.bookmark
+                                           fileURL:result.fileURL
+                                    cachedAnalysis:cachedAnalyses[i]
+                                      waveformPath:waveformPaths[i] == [NSNull null] ? nil : waveformPaths[i]
+                                          playlist:playlist
+                                       objectCache:objectCache
+                                         inContext:context];
+      [self stampTrack:track withResult:result];
+    }];
+    [objectCache finishBatchInContext:context];
+    return @(results.count);
+  }];
+  return [self faultObjectsSavedByWriteTask:writeTask];
+}
+
++ (BFTask<NSNumber *> *)refreshTracksWithObjectIDs:(NSArray<NSManagedObjectID *> *)objectIDs
+                                       fromResults:(NSArray<MetadataExtractionResult *> *)results
+                                       objectCache:(ImportObjectCache *)objectCache {
+  NSArray<NSDictionary *> *metadata = [results valueForKey:@"metadata"];
+  BFTask *writeTask = [[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+    [objectCache prefetchObjectsForMetadata:metadata inContext:context];
+    __block NSUInteger refreshedCount = 0;
+    [results enumerateObjectsUsingBlock:^(MetadataExtractionResult *result, NSUInteger i, BOOL *_) {
+      Track *track = [context existingObjectWithID:objectIDs[i] error:nil];
+      if (!track) {
+        return;
       }
-    }
 
-    Track *track = [TrackDataStore insertTrackWithTitle:metadata[@"title"] ?: [fileURL lastPathComponent]
-                                                fileURL:[fileURL path]
-                                            urlBookmark:bookmark
-                                            trackNumber:[metadata[@"trackNumber"] intValue]
-                                               fileType:[fileURL pathExtension]
-                                                bitrate:[metadata[@"bitrate"] intValue]
-                                             sampleRate:[metadata[@"sampleRate"] intValue]
-                                               duration:[metadata[@"duration"] doubleValue]
-                                                    bpm:[metadata[@"bpm"] floatValue]
-                                                 artist:artist
-                                                  album:album
-                                              inContext:context];
-    if (playlist) {
-      [track addPlaylistsObject:playlist];
-    }
+      NSDictionary *tags = result.metadata;
+      track.title = tags[@"title"] ?: [result.fileURL lastPathComponent];
+      track.trackNumber = [tags[@"trackNumber"] intValue];
+      track.bitrate = [tags[@"bitrate"] intValue];
+      track.sampleRate = [tags[@"sampleRate"] intValue];
+      track.duration = [tags[@"duration"] doubleValue];
+      track.artist = [self artistForMetadata:tags objectCache:objectCache inContext:context];
+      track.album = [self albumForMetadata:tags
+                                    artist:track.artist
+                                   fileURL:result.fileURL
+                               objectCache:objectCache
+                                 inContext:context];
+      // A tagged BPM wins, otherwise the analyzed one is kept
+      if ([tags[@"bpm"] floatValue] > 0) {
+        track.bpm = [tags[@"bpm"] floatValue];
+      }
+      track.urlBookmark = result.bookmark ?: track.urlBookmark;
+      [self stampTrack:track withResult:result];
+      refreshedCount++;
+    }];
+    [objectCache finishBatchInContext:context];
+    return @(refreshedCount);
+  }];
+  return [self faultObjectsSavedByWriteTask:writeTask];
+}
 
-    return track;
+/// Turns saved objects back into faults once `writeTask` is done, else the long-lived writer context keeps every one
+/// of them. Passes `writeTask` on.
++ (BFTask *)faultObjectsSavedByWriteTask:(BFTask *)writeTask {
+  return [writeTask continueWithSuccessBlock:^id(BFTask *task) {
+    return [[[CoreDataStore writer] performWrite:^id(NSManagedObjectContext *context) {
+      [context refreshAllObjects];
+      return nil;
+    }] continueWithSuccessBlock:^id(BFTask *_) { return task; }];
   }];
 }
 
-+ (BFTask<NSImage *> *)getWaveformForTrack:(Track *)track resolvedURL:(NSURL *)resolvedURL size:(CGSize)size {
-  if (track.waveformPath) {
-    NSImage *cachedImage = [WaveformCacheManager loadWaveformForPath:track.waveformPath];
-    if (cachedImage) {
-      return [BFTask taskWithResult:cachedImage];
-    }
++ (Track *)insertTrackWithMetadata:(NSDictionary *)metadata
+                          bookmark:(NSData *)bookmark
+                           fileURL:(NSURL *)fileURL
+                    cachedAnalysis:(nullable NSDictionary *)cached
+                      waveformPath:(nullable NSString *)waveformPath
+                          playlist:(nullable Playlist *)playlist
+                       objectCache:(nullable ImportObjectCache *)objectCache
+                         inContext:(NSManagedObjectContext *)context {
+  Artist *artist = [self artistForMetadata:metadata objectCache:objectCache inContext:context];
+  Album *album = [self albumForMetadata:metadata
+                                 artist:artist
+                                fileURL:fileURL
+                            objectCache:objectCache
+                              inContext:context];
+
+  Track *track = [TrackDataStore insertTrackWithTitle:metadata[@"title"] ?: [fileURL lastPathComponent]
+                                              fileURL:[fileURL path]
+                                          urlBookmark:bookmark
+                                          trackNumber:[metadata[@"trackNumber"] intValue]
+                                             fileType:[fileURL pathExtension]
+                                              bitrate:[metadata[@"bitrate"] intValue]
+                                           sampleRate:[metadata[@"sampleRate"] intValue]
+                                             duration:[metadata[@"duration"] doubleValue]
+                                                  bpm:[metadata[@"bpm"] floatValue]
+                                               artist:artist
+                                                album:album
+                                            inContext:context];
+  if (track.bpm <= 0 && [cached[AnalysisCacheKeyBPM] floatValue] > 0) {
+    track.bpm = [cached[AnalysisCacheKeyBPM] floatValue];
+    track.bpmConfidence = [cached[AnalysisCacheKeyBPMConfidence] floatValue];
   }
-  return [[WaveformGenerator generateWaveformForTrack:track url:resolvedURL
-                                                 size:size] continueWithSuccessBlock:^id(BFTask<NSImage *> *task) {
-    NSImage *image = task.result;
-    NSString *path = [WaveformCacheManager saveWaveformImage:image forTrackUUID:track.uniqueID];
 
-    if (path) {
-      [TrackDataStore updateWaveformPathForTrackWithObjectID:track.objectID waveformPath:path];
-    }
+  if (waveformPath) {
+    track.waveformPath = waveformPath;
+  }
 
-    return [BFTask taskWithResult:image];
-  }];
+  if (playlist) {
+    [track addPlaylistsObject:playlist];
+  }
+
+  return track;
+}
+
++ (nullable Artist *)artistForMetadata:(NSDictionary *)metadata
+                           objectCache:(nullable ImportObjectCache *)objectCache
+                             inContext:(NSManagedObjectContext *)context {
+  NSString *artistName = metadata[@"artist"];
+  if (!artistName) {
+    return nil;
+  }
+  return objectCache ? [objectCache artistWithName:artistName inContext:context]
+                     : [ArtistDataStore findOrCreateArtistWithName:artistName usingContext:context];
+}
+
++ (nullable Album *)albumForMetadata:(NSDictionary *)metadata
+                              artist:(nullable Artist *)artist
+                             fileURL:(NSURL *)fileURL
+                         objectCache:(nullable ImportObjectCache *)objectCache
+                           inContext:(NSManagedObjectContext *)context {
+  NSString *albumName = metadata[@"album"];
+  if (!albumName) {
+    return nil;
+  }
+
+  Album *album = objectCache ? [objectCache albumWithName:albumName artist:artist inContext:context]
+                             : [AlbumDataStore findOrCreateAlbumWithName:albumName artist:artist inContext:context];
+  if (!album.artworkPath && [metadata[@"hasEmbeddedArtwork"] boolValue]) {
+    album.artworkPath = [ArtworkManager embeddedArtworkPathForFileURL:fileURL];
+  }
+  return album;
+}
+
++ (void)stampTrack:(Track *)track withResult:(MetadataExtractionResult *)result {
+  track.fileSize = result.fileSize;
+  track.fileModificationTime = result.fileModificationTime;
+  track.fileInode = result.fileInode;
+  track.isMissing = NO;
+  track.contentFingerprint = result.fingerprint;
+  // A changed file gets another chance at background BPM analysis
+  track.bpmAnalysisFailedAt = nil;
+}
+
++ (BFTask<NSData *> *)getWaveformPeaksForTrack:(Track *)track
+                                   resolvedURL:(NSURL *)resolvedURL
+                                      progress:(WaveformProgressBlock)progress {
+  NSData *cachedPeaks = [WaveformCacheManager loadPeaksForKey:track.waveformPath];
+  if (cachedPeaks) {
+    return [BFTask taskWithResult:cachedPeaks];
+  }
+
+  // Tracks imported before the fingerprint was kept hash the file, which stays off the main thread
+  NSString *knownFingerprint = track.contentFingerprint;
+  NSManagedObjectID *objectID = track.objectID;
+  NSUUID *uniqueID = track.uniqueID;
+  return [BFTask taskFromExecutor:[BFExecutor defaultExecutor]
+                        withBlock:^id {
+                          NSString *fingerprint =
+                              knownFingerprint ?: [AnalysisCache fingerprintForFileAtURL:resolvedURL];
+                          NSData *peaks = [WaveformCacheManager loadPeaksForKey:fingerprint];
+                          if (peaks) {
+                            [TrackDataStore updateWaveformPathForTrackWithObjectID:objectID waveformPath:fingerprint];
+                            return peaks;
+                          }
+
+                          BFTask *generateTask = [WaveformGenerator generatePeaksForTrack:track
+                                                                                      url:resolvedURL
+                                                                                 progress:progress];
+                          return [generateTask continueWithSuccessBlock:^id(BFTask<NSData *> *task) {
+                            NSData *generated = task.result;
+                            NSString *key = fingerprint
+                                                ? [WaveformCacheManager savePeaks:generated forFingerprint:fingerprint]
+                                                : [WaveformCacheManager savePeaks:generated forTrackUUID:uniqueID];
+                            if (key) {
+                              [TrackDataStore updateWaveformPathForTrackWithObjectID:objectID waveformPath:key];
+                            }
+                            return generated;
+                          }];
+                        }];
 }
 
 + (NSURL *)resolveTrackURL:(Track *)track {
@@ -199,9 +410,16 @@
   if (!track.urlBookmark) {
     return nil;
   }
+  return [self resolveBookmark:track.urlBookmark filePath:track.fileURL securityScopeURL:securityScopeURL];
+}
 
+/// The file a track bookmark leads to, `filePath` inside the folder when the bookmark is for a folder. The bookmark's
+/// security scope is accessed, the caller stops it. Only touches its arguments, so it is safe off the main thread.
++ (NSURL *)resolveBookmark:(NSData *)bookmark
+                  filePath:(NSString *)filePath
+          securityScopeURL:(NSURL *_Nullable *_Nullable)securityScopeURL {
   NSError *error = nil;
-  NSURL *resolvedURL = [BookmarkResolver URLForBookmarkData:track.urlBookmark error:&error];
+  NSURL *resolvedURL = [BookmarkResolver URLForBookmarkData:bookmark error:&error];
   if (error) {
     NSLog(@"PlaybackManager: Failed to resolve bookmark for track. Error: %@", error.localizedDescription);
     return nil;
@@ -215,7 +433,7 @@
     [resolvedURL getResourceValue:&isDirectory forKey:NSURLIsDirectoryKey error:nil];
 
     if (isDirectory.boolValue) {
-      return [NSURL fileURLWithPath:track.fileURL];
+      return [NSURL fileURLWithPath:filePath];
     } else {
       return resolvedURL;
     }
@@ -223,8 +441,9 @@
 }
 
 + (BFTask *)deleteTrack:(Track *)track {
-  if (track.waveformPath) {
-    [WaveformCacheManager removeWaveformForPath:track.waveformPath];
+  // Content-keyed waveforms stay in the store for when the file comes back
+  if (track.waveformPath && [WaveformCacheManager isWaveformKey:track.waveformPath ownedByTrackUUID:track.uniqueID]) {
+    [WaveformCacheManager removePeaksForKey:track.waveformPath];
   }
   return [TrackDataStore deleteTrackWithObjectID:track.objectID];
 }
@@ -239,12 +458,118 @@
   return [BFTask taskForCompletionOfAllTasks:tasks];
 }
 
+/// Extractions of embedded album artwork by album object ID. An album is read once per launch, also while its saved
+/// path is still on the way to the view context. Only used on the main thread.
++ (NSMutableDictionary<NSManagedObjectID *, BFTask<NSString *> *> *)embeddedArtworkExtractions {
+  static NSMutableDictionary *extractions = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{ extractions = [NSMutableDictionary dictionary]; });
+  return extractions;
+}
+
 + (NSImage *)loadArtworkForTrack:(Track *)track withPlaceholderSize:(CGSize)size {
-  if (track.album.artworkPath) {
-    return [ArtworkManager loadArtworkAtPath:track.album.artworkPath];
-  } else {
-    return [ArtworkManager placeholderImageWithSize:size];
+  NSString *artworkPath = track.album.artworkPath;
+  if ([ArtworkManager fileURLForEmbeddedArtworkPath:artworkPath]) {
+    BFTask<NSString *> *extraction = self.embeddedArtworkExtractions[track.album.objectID];
+    artworkPath = extraction.completed ? extraction.result : nil;
+  }
+
+  NSImage *artwork = artworkPath ? [ArtworkManager loadArtworkAtPath:artworkPath] : nil;
+  return artwork ?: [ArtworkManager placeholderImageWithSize:size];
+}
+
++ (BFTask<NSImage *> *)artworkForTrack:(Track *)track {
+  Album *album = track.album;
+  if (![ArtworkManager fileURLForEmbeddedArtworkPath:album.artworkPath]) {
+    return [BFTask taskWithResult:[ArtworkManager loadArtworkAtPath:album.artworkPath]];
   }
+
+  BFTask<NSString *> *extraction = self.embeddedArtworkExtractions[album.objectID];
+  if (!extraction) {
+    extraction = [self extractEmbeddedArtworkForTrack:track];
+    self.embeddedArtworkExtractions[album.objectID] = extraction;
+  }
+  return [extraction continueWithSuccessBlock:^id(BFTask<NSString *> *task) {
+    return [ArtworkManager loadArtworkAtPath:task.result];
+  }];
+}
+
+/// Imports only note which file holds an album's picture. It is read and saved as JPEG the first time it is shown,
+/// from `track` when it has one, else from the album's track in the file that was noted. Both are opened through
+/// their bookmarks, in the background. Resolves to the saved path, nil when neither has a picture.
++ (BFTask<NSString *> *)extractEmbeddedArtworkForTrack:(Track *)track {
+  Album *album = track.album;
+  NSManagedObjectID *albumID = album.objectID;
+  NSString *notedPath = [ArtworkManager fileURLForEmbeddedArtworkPath:album.artworkPath].path;
+
+  // Managed objects stay on this thread, the background only gets their bookmarks and paths
+  NSMutableArray<Track *> *candidates = [NSMutableArray arrayWithObject:track];
+  for (Track *albumTrack in album.tracks) {
+    if (albumTrack != track && [albumTrack.fileURL isEqualToString:notedPath]) {
+      [candidates addObject:albumTrack];
+    }
+  }
+  NSMutableArray<NSData *> *bookmarks = [NSMutableArray array];
+  NSMutableArray<NSString *> *filePaths = [NSMutableArray array];
+  for (Track *candidate in candidates) {
+    if (candidate.urlBookmark && candidate.fileURL) {
+      [bookmarks addObject:candidate.urlBookmark];
+      [filePaths addObject:candidate.fileURL];
+    }
+  }
+
+  return [[BFTask taskFromExecutor:[BFExecutor defaultExecutor] withBlock:^id {
+    NSData *artworkData = nil;
+    for (NSUInteger i = 0; i < bookmarks.count && !artworkData; i++) {
+      NSURL *securityScopeURL = nil;
+      NSURL *fileURL = [self resolveBookmark:bookmarks[i] filePath:filePaths[i] securityScopeURL:&securityScopeURL];
+      artworkData = fileURL ? [MetadataExtractor extractArtworkFromFileAtURL:fileURL] : nil;
+      [securityScopeURL stopAccessingSecurityScopedResource];
+    }
+    return [ArtworkManager saveArtwork:artworkData];
+  }] continueWithSuccessBlock:^id(BFTask<NSString *> *task) {
+    if (task.result) {
+      [AlbumDataStore updateArtworkPathForAlbumWithObjectID:albumID artworkPath:task.result];
+    }
+    return task;
+  }];
+}
+
++ (BFTask *)collectUnusedArtwork {
+  return [[[AlbumDataStore artworkPathReferenceCounts] continueWithSuccessBlock:^id(BFTask *task) {
+    return [ArtworkManager removeArtworkUnreferencedBy:task.result];
+  }] continueWithBlock:^id(BFTask<NSNumber *> *task) {
+    if (task.error) {
+      NSLog(@"Error collecting unused artwork: %@", task.error.localizedDescription);
+    } else if (task.result.unsignedIntegerValue > 0) {
+      NSLog(@"TrackService: Removed %lu unused artwork files", task.result.unsignedLongValue);
+    }
+    return task;
+  }];
+}
+
++ (BFTask *)rescanLibrary {
+  // Only the folder the user picked for music is walked for new files, the sidebar's folders are just for browsing
+  NSURL *musicFolderURL = nil;
+  NSData *bookmark = [BookmarkResolver bookmarkForMusicFolder];
+  if (bookmark) {
+    NSError *error = nil;
+    musicFolderURL = [BookmarkResolver resolveAndAccessBookmarkData:bookmark error:&error];
+    if (!musicFolderURL) {
+      NSLog(@"TrackService: Skipping music folder in rescan. Error: %@", error.localizedDescription);
+    }
+  }
+
+  NSArray<NSURL *> *folderURLs = musicFolderURL ? @[ musicFolderURL ] : @[];
+  return [[LibraryRescanner rescanWithFolderURLs:folderURLs] continueWithBlock:^id(BFTask *rescanTask) {
+    if (musicFolderURL) {
+      [BookmarkResolver releaseAccessedURL:musicFolderURL];
+    }
+    if (rescanTask.error) {
+      NSLog(@"Error rescanning library: %@", rescanTask.error.localizedDescription);
+    }
+    return rescanTask;
+  }];
 }
 
 + (BFTask *)updateTrack:(Track *)track
@@ -256,7 +581,7 @@
                    year:(uint16_t)year {
   NSString *artworkPath = track.album.artworkPath;
   if (albumImage && track.album) {
-    artworkPath = [ArtworkManager saveArtworkFromImage:albumImage forUUID:track.album.uniqueID];
+    artworkPath = [ArtworkManager saveArtworkFromImage:albumImage];
   }
 
   return [[TrackDataStore updateTrackWithObjectID:track.objectID
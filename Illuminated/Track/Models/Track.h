@@ -21,6 +21,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property(nullable, nonatomic, copy) NSString *title;
 @property(nonatomic) double duration;
 @property(nonatomic) float bpm;
+@property(nonatomic) float bpmConfidence;
+/// When background analysis last failed to find a tempo, so the scheduler stops picking the track up.
+@property(nullable, nonatomic, copy) NSDate *bpmAnalysisFailedAt;
 @property(nonatomic) int16_t trackNumber;
 @property(nonatomic) int16_t discNumber;
 @property(nullable, nonatomic, copy) NSString *fileURL;
@@ -37,7 +40,18 @@ NS_ASSUME_NONNULL_BEGIN
 @property(nullable, nonatomic, retain) Artist *artist;
 @property(nullable, nonatomic, retain) NSSet<Playlist *> *playlists;
 @property(nullable, nonatomic, retain) NSData *urlBookmark;
+/// Key of the track's entry in the waveform store, see `WaveformCacheManager`. Named from when it was a file path.
 @property(nullable, nonatomic, copy) NSString *waveformPath;
+/// `AnalysisCache` fingerprint of the file when its tags were last read, nil for tracks imported before it was kept.
+@property(nullable, nonatomic, copy) NSString *contentFingerprint;
+/// Size, modification time in nanoseconds since 1970 and inode when the tags were last read, 0 if never stamped.
+/// A rescan re-reads the file only when one of them changed, see `LibraryRescanner`.
+@property(nonatomic) int64_t fileSize;
+@property(nonatomic) int64_t fileModificationTime;
+@property(nonatomic) int64_t fileInode;
+/// The file was gone at the last rescan. The track shows dimmed and is left out of the play queue, see `fileExists`,
+/// until a rescan finds the file again.
+@property(nonatomic) BOOL isMissing;
 
 - (NSNumber *)roundedBPM;
 
@@ -22,13 +22,16 @@
 }
 
 - (BOOL)fileExists {
-  return [[NSFileManager defaultManager] fileExistsAtPath:self.fileURL];
+  // Flagged tracks skip the lookup, which saves one on the main thread for every row of an unplugged drive
+  return !self.isMissing && [[NSFileManager defaultManager] fileExistsAtPath:self.fileURL];
 }
 
 @dynamic uniqueID;
 @dynamic title;
 @dynamic duration;
 @dynamic bpm;
+@dynamic bpmConfidence;
+@dynamic bpmAnalysisFailedAt;
 @dynamic trackNumber;
 @dynamic discNumber;
 @dynamic fileURL;
@@ -46,5 +49,10 @@
 @dynamic playlists;
 @dynamic urlBookmark;
 @dynamic waveformPath;
+@dynamic contentFingerprint;
+@dynamic fileSize;
+@dynamic fileModificationTime;
+@dynamic fileInode;
+@dynamic isMissing;
 
 @end
@@ -65,6 +65,15 @@
 
   self.artworkImageView.image = [TrackService loadArtworkForTrack:self.track
                                               withPlaceholderSize:self.artworkImageView.bounds.size];
+
+  __weak typeof(self) weakSelf = self;
+  [[TrackService artworkForTrack:self.track] continueOnMainThreadWithBlock:^id(BFTask<NSImage *> *task) {
+    // A picture chosen in the meantime wins
+    if (task.result && !weakSelf.selectedDisplayImage) {
+      weakSelf.artworkImageView.image = task.result;
+    }
+    return nil;
+  }];
 }
 
 #pragma mark - IBActions
@@ -14,6 +14,7 @@
 #import "FileBrowserService.h"
 #import "FileExtensionHelper.h"
 #import "FilesSidebarViewController.h"
+#import "ImportPipeline.h"
 #import "MetadataEditorViewController.h"
 #import "Playlist.h"
 #import "PlaylistDataStore.h"
@@ -44,6 +45,10 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
 @property(nonatomic, strong, nullable) Album *currentAlbum;
 @property(nonatomic, strong, nullable) Track *currentTrack;
 
+@property(nonatomic, strong) NSMutableArray<ImportPipeline *> *runningImports;
+@property(nonatomic, strong, nullable) NSView *importBar;
+@property(nonatomic, strong, nullable) NSProgressIndicator *importIndicator;
+
 @end
 
 #pragma mark - Implementation
@@ -64,6 +69,8 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
   self.view.autoresizingMask = NSViewWidthSizable | NSViewHeightSizable;
   self.view.translatesAutoresizingMaskIntoConstraints = YES;
 
+  self.runningImports = [NSMutableArray array];
+
   [self setupFetchedResultsController];
   [self setupNotifications];
 }
@@ -174,19 +181,17 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
     NSURL *standardURL = [url filePathURL];
     NSString *extension = [standardURL.pathExtension lowercaseString];
 
-    if ([FileExtensionHelper isAudioFileExtension:extension]) {
+    // Folders are walked for audio files by the import itself
+    if ([FileExtensionHelper isAudioFileExtension:extension] || [self isDirectoryURL:standardURL]) {
       [resolvedURLs addObject:standardURL];
     }
   }
 
   if (resolvedURLs.count == 0) {
     return NO;
-  } else if (resolvedURLs.count == 1) {
-    [self importURL:resolvedURLs.firstObject];
-  } else {
-    [self importURLs:resolvedURLs];
   }
 
+  [self importURLs:resolvedURLs];
   return YES;
 }
 
@@ -350,7 +355,7 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
 #pragma mark - Public methods
 
 - (void)importURLs:(NSArray<NSURL *> *)urls {
-  if (urls.count == 1) {
+  if (urls.count == 1 && ![self isDirectoryURL:urls.firstObject]) {
     [self importURL:[urls firstObject]];
   } else {
     NSMutableArray<NSURL *> *accessedURLs = [NSMutableArray array];
@@ -361,14 +366,16 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
       }
     }
 
-    [[TrackService importAudioFilesAtURLs:urls withPlaylist:nil] continueOnMainThreadWithBlock:^id(BFTask *task) {
+    ImportPipeline *pipeline = [TrackService importAudioFilesAtURLs:urls withPlaylist:nil];
+    [self showProgressForImport:pipeline];
+    [pipeline.task continueOnMainThreadWithBlock:^id(BFTask *task) {
       for (NSURL *accessedURL in accessedURLs) {
         [accessedURL stopAccessingSecurityScopedResource];
       }
+      [self importDidFinish:pipeline];
 
       if (task.error) {
         NSLog(@"Error importing url: %@", task.error.localizedDescription);
-      } else {
       }
       return nil;
     }];
@@ -427,6 +434,82 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
   [self.tableView reloadData];
 }
 
+#pragma mark - Import Progress
+
+/// One bar along the bottom of the list for every running import. It follows the latest, its button cancels them all.
+- (void)showProgressForImport:(ImportPipeline *)pipeline {
+  [self.runningImports addObject:pipeline];
+  if (!self.importBar) {
+    [self setupImportBar];
+  }
+  self.importIndicator.observedProgress = pipeline.progress;
+  self.importBar.hidden = NO;
+}
+
+- (void)importDidFinish:(ImportPipeline *)pipeline {
+  [self.runningImports removeObject:pipeline];
+  self.importIndicator.observedProgress = self.runningImports.lastObject.progress;
+  self.importBar.hidden = self.runningImports.count == 0;
+}
+
+- (void)cancelImportsAction:(id)sender {
+  // Tracks already read are still saved, the bar goes away once they are
+  for (ImportPipeline *pipeline in self.runningImports) {
+    [pipeline.progress cancel];
+  }
+}
+
+- (void)setupImportBar {
+  NSVisualEffectView *importBar = [[NSVisualEffectView alloc] initWithFrame:NSMakeRect(0, 0, 200, 28)];
+  importBar.translatesAutoresizingMaskIntoConstraints = NO;
+  importBar.material = NSVisualEffectMaterialContentBackground;
+  importBar.blendingMode = NSVisualEffectBlendingModeWithinWindow;
+  importBar.state = NSVisualEffectStateFollowsWindowActiveState;
+
+  NSTextField *titleLabel = [NSTextField labelWithString:@"IMPORTING"];
+  titleLabel.font = [NSFont systemFontOfSize:11 weight:NSFontWeightSemibold];
+  titleLabel.textColor = [NSColor secondaryLabelColor];
+  titleLabel.translatesAutoresizingMaskIntoConstraints = NO;
+
+  NSProgressIndicator *indicator = [[NSProgressIndicator alloc] init];
+  indicator.style = NSProgressIndicatorStyleBar;
+  indicator.controlSize = NSControlSizeSmall;
+  indicator.translatesAutoresizingMaskIntoConstraints = NO;
+
+  NSButton *cancelButton = [NSButton buttonWithImage:[NSImage imageWithSystemSymbolName:@"xmark.circle.fill"
+                                                               accessibilityDescription:@"Cancel Import"]
+                                              target:self
+                                              action:@selector(cancelImportsAction:)];
+  cancelButton.bezelStyle = NSBezelStyleInline;
+  cancelButton.bordered = NO;
+  cancelButton.translatesAutoresizingMaskIntoConstraints = NO;
+
+  [importBar addSubview:titleLabel];
+  [importBar addSubview:indicator];
+  [importBar addSubview:cancelButton];
+  [self.view addSubview:importBar];
+
+  [NSLayoutConstraint activateConstraints:@[
+    [importBar.leadingAnchor constraintEqualToAnchor:self.view.leadingAnchor],
+    [importBar.trailingAnchor constraintEqualToAnchor:self.view.trailingAnchor],
+    [importBar.bottomAnchor constraintEqualToAnchor:self.view.bottomAnchor],
+    [importBar.heightAnchor constraintEqualToConstant:28],
+
+    [titleLabel.leadingAnchor constraintEqualToAnchor:importBar.leadingAnchor constant:8],
+    [titleLabel.centerYAnchor constraintEqualToAnchor:importBar.centerYAnchor],
+
+    [indicator.leadingAnchor constraintEqualToAnchor:titleLabel.trailingAnchor constant:8],
+    [indicator.trailingAnchor constraintEqualToAnchor:cancelButton.leadingAnchor constant:-8],
+    [indicator.centerYAnchor constraintEqualToAnchor:importBar.centerYAnchor],
+
+    [cancelButton.trailingAnchor constraintEqualToAnchor:importBar.trailingAnchor constant:-8],
+    [cancelButton.centerYAnchor constraintEqualToAnchor:importBar.centerYAnchor]
+  ]];
+
+  self.importBar = importBar;
+  self.importIndicator = indicator;
+}
+
 #pragma mark - Right-Click Menu
 
 - (BOOL)validateMenuItem:(NSMenuItem *)menuItem {
@@ -502,6 +585,12 @@ NSString *const PasteboardItemTypeTrackImports = @"com.illuminated.track.import"
 
 #pragma mark - Private helpers
 
+- (BOOL)isDirectoryURL:(NSURL *)url {
+  NSNumber *isDirectory = nil;
+  [url getResourceValue:&isDirectory forKey:NSURLIsDirectoryKey error:nil];
+  return isDirectory.boolValue;
+}
+
 - (void)reloadData {
   [self.tableView reloadData];
   [self selectRowForTrack:self.currentTrack scroll:NO];
@@ -9,6 +9,10 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Posted while the visualizer starts and stops rendering, so background work can get out of its way.
+extern NSString *const VisualizationDidAppearNotification;
+extern NSString *const VisualizationDidDisappearNotification;
+
 @interface VizualizationViewController : NSViewController
 
 @end
@@ -9,6 +9,9 @@
 #import "ProjectMView.h"
 #import "TrackPlaybackController.h"
 
+NSString *const VisualizationDidAppearNotification = @"VisualizationDidAppearNotification";
+NSString *const VisualizationDidDisappearNotification = @"VisualizationDidDisappearNotification";
+
 @interface VizualizationViewController ()
 
 @property(nonatomic, strong) ProjectMView *projectMView;
@@ -55,12 +58,16 @@
                                            selector:@selector(windowDidExitFullScreen:)
                                                name:NSWindowDidExitFullScreenNotification
                                              object:self.view.window];
+
+  [[NSNotificationCenter defaultCenter] postNotificationName:VisualizationDidAppearNotification object:self];
 }
 
 - (void)viewDidDisappear {
   [super viewDidDisappear];
 
   [[TrackPlaybackController sharedManager] unregisterAudioBufferCallback];
+
+  [[NSNotificationCenter defaultCenter] postNotificationName:VisualizationDidDisappearNotification object:self];
 }
 
 - (void)dealloc {
@@ -0,0 +1,105 @@
+//
+//  BPMEngineTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMEngine.h"
+#include "Check.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr double kSampleRate = 44100.0;
+constexpr double kSeconds = 20.0;
+
+} // namespace
+
+TEST(findsTempoOfClickTracks) {
+  for (double truth : {88.0, 100.0, 120.0, 128.0, 140.0}) {
+    std::vector<float> samples = signals::clickTrack(truth, kSeconds, kSampleRate);
+    bpm::Result result = bpm::Analyzer(kSampleRate).analyze(samples);
+
+    CHECK_NEAR(result.bpm, truth, 1.0);
+    CHECK(result.confidence > 0.2);
+    CHECK_EQ(result.lookups, (size_t)1025 * 1024 * 17);
+  }
+}
+
+TEST(sameSeedGivesSameTempo) {
+  std::vector<float> samples = signals::clickTrack(117.0, kSeconds, kSampleRate);
+  bpm::Options options;
+  options.seed = 42;
+
+  bpm::Result first = bpm::Analyzer(kSampleRate, options).analyze(samples);
+  bpm::Result second = bpm::Analyzer(kSampleRate, options).analyze(samples);
+  CHECK_EQ(first.bpm, second.bpm);
+  CHECK_EQ(first.confidence, second.confidence);
+}
+
+TEST(threadCountDoesNotChangeTempo) {
+  std::vector<float> samples = signals::clickTrack(133.0, kSeconds, kSampleRate);
+  bpm::Options options;
+  options.threads = 1;
+  bpm::Result single = bpm::Analyzer(kSampleRate, options).analyze(samples);
+
+  for (unsigned int threads : {2u, 3u, 8u}) {
+    options.threads = threads;
+    bpm::Result parallel = bpm::Analyzer(kSampleRate, options).analyze(samples);
+    CHECK_EQ(parallel.bpm, single.bpm);
+    CHECK_EQ(parallel.confidence, single.confidence);
+  }
+}
+
+TEST(honorsTheBPMRange) {
+  // 70 BPM sits outside the default range, a wider range has to find it
+  std::vector<float> samples = signals::clickTrack(70.0, kSeconds, kSampleRate);
+  bpm::Options options;
+  options.minBPM = 60.0;
+  options.maxBPM = 90.0;
+
+  CHECK_NEAR(bpm::Analyzer(kSampleRate, options).analyze(samples).bpm, 70.0, 1.0);
+}
+
+TEST(rejectsUnusableInput) {
+  std::vector<float> samples = signals::clickTrack(120.0, kSeconds, kSampleRate);
+
+  CHECK_EQ(bpm::Analyzer(kSampleRate).analyze({}).bpm, 0.0);
+  CHECK_EQ(bpm::Analyzer(0.0).analyze(samples).bpm, 0.0);
+
+  bpm::Options inverted;
+  inverted.minBPM = 150.0;
+  inverted.maxBPM = 80.0;
+  CHECK_EQ(bpm::Analyzer(kSampleRate, inverted).analyze(samples).bpm, 0.0);
+
+  bpm::Options empty;
+  empty.steps = 0;
+  CHECK_EQ(bpm::Analyzer(kSampleRate, empty).analyze(samples).bpm, 0.0);
+}
+
+TEST(silenceHasNoConfidence) {
+  std::vector<float> silence((size_t)(kSeconds * kSampleRate), 0.0f);
+  CHECK_EQ(bpm::Analyzer(kSampleRate).analyze(silence).confidence, 0.0);
+}
+
+TEST(envelopeDoesNotDependOnChunking) {
+  std::vector<float> samples = signals::clickTrack(124.0, 5.0, kSampleRate);
+  std::vector<float> whole = bpm::Analyzer::envelope(samples);
+  CHECK_EQ(whole.size(), samples.size() / bpm::kEnvelopeInterval);
+
+  // Odd chunk sizes, so envelope intervals straddle the chunk edges
+  bpm::EnvelopeFollower follower;
+  std::span<const float> remaining(samples);
+  for (size_t chunk = 1; !remaining.empty(); chunk = chunk * 3 % 1021 + 1) {
+    size_t count = std::min(chunk, remaining.size());
+    follower.process(remaining.first(count));
+    remaining = remaining.subspan(count);
+  }
+
+  std::span<const float> streamed = follower.envelope();
+  REQUIRE(streamed.size() == whole.size());
+  CHECK(std::equal(streamed.begin(), streamed.end(), whole.begin()));
+}
@@ -0,0 +1,68 @@
+//
+//  BPMKernelTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMEngine.h"
+#include "BPMKernel.h"
+#include "Check.h"
+#include "TestSignals.h"
+
+#include <cstdio>
+
+namespace {
+
+std::vector<float> randomEnvelope(size_t size, uint64_t seed) {
+  signals::Random random(seed);
+  std::vector<float> nrg(size);
+  for (float &value : nrg) {
+    value = (float)(random.bipolar() * 0.5 + 0.5);
+  }
+  return nrg;
+}
+
+/// Midpoints anywhere in the envelope and a little past both ends, so lookups fall out of range too.
+std::vector<double> randomMidpoints(size_t count, size_t envelopeSize, uint64_t seed) {
+  signals::Random random(seed);
+  std::vector<double> mids(count);
+  for (double &mid : mids) {
+    mid = (random.bipolar() * 0.6 + 0.5) * envelopeSize;
+  }
+  return mids;
+}
+
+} // namespace
+
+TEST(reportsKernel) {
+  std::printf("autodifference kernel: %s\n", bpm::autodifferenceKernelName());
+}
+
+TEST(simdMatchesScalarBitForBit) {
+  std::vector<float> nrg = randomEnvelope(20000, 7);
+
+  // Counts around the lane widths, so every remainder takes the scalar tail
+  for (size_t count : {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 1023, 1024}) {
+    std::vector<double> mids = randomMidpoints(count, nrg.size(), count + 1);
+    for (double interval : {150.5, 243.0, 314.9, 0.25}) {
+      double simd = bpm::autodifferenceSum(nrg, interval, mids);
+      double scalar = bpm::autodifferenceSumScalar(nrg, interval, mids);
+      CHECK_EQ(simd, scalar);
+    }
+  }
+}
+
+TEST(simdMatchesScalarOnRealEnvelope) {
+  std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(123.0, 10.0, 44100.0));
+  std::vector<double> mids = randomMidpoints(1024, nrg.size(), 3);
+
+  for (double interval = 140.0; interval < 250.0; interval += 3.7) {
+    CHECK_EQ(bpm::autodifferenceSum(nrg, interval, mids), bpm::autodifferenceSumScalar(nrg, interval, mids));
+  }
+}
+
+TEST(emptyEnvelopeSumsToZero) {
+  std::vector<double> mids = {0.0, 1.0, 2.5, 100.0, -4.0};
+  CHECK_EQ(bpm::autodifferenceSum({}, 200.0, mids), 0.0);
+}
@@ -0,0 +1,83 @@
+//
+//  BPMSearchTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMEngine.h"
+#include "Check.h"
+#include "TestSignals.h"
+
+namespace {
+
+constexpr double kSampleRate = 44100.0;
+constexpr double kSeconds = 20.0;
+
+bpm::Options hierarchical() {
+  bpm::Options options;
+  options.search = bpm::SearchMode::Hierarchical;
+  return options;
+}
+
+} // namespace
+
+TEST(hierarchicalMatchesExhaustive) {
+  for (double truth : {86.0, 97.5, 110.0, 126.0, 143.0}) {
+    std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(truth, kSeconds, kSampleRate));
+    bpm::Result exhaustive = bpm::Analyzer(kSampleRate).analyzeEnvelope(nrg);
+    bpm::Result coarseToFine = bpm::Analyzer(kSampleRate, hierarchical()).analyzeEnvelope(nrg);
+
+    CHECK_NEAR(coarseToFine.bpm, truth, 1.0);
+    CHECK_NEAR(coarseToFine.bpm, exhaustive.bpm, 1.0);
+    CHECK(coarseToFine.confidence > 0.2);
+  }
+}
+
+TEST(hierarchicalDoesATenthOfTheWork) {
+  std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(120.0, kSeconds, kSampleRate));
+  bpm::Result exhaustive = bpm::Analyzer(kSampleRate).analyzeEnvelope(nrg);
+  bpm::Result coarseToFine = bpm::Analyzer(kSampleRate, hierarchical()).analyzeEnvelope(nrg);
+
+  // 129 x 128 coarse midpoints plus 3 troughs of 17 x 1024
+  CHECK_EQ(coarseToFine.lookups, ((size_t)129 * 128 + 3 * 17 * 1024) * 17);
+  CHECK(coarseToFine.lookups * 10 <= exhaustive.lookups);
+}
+
+TEST(hierarchicalIsDeterministicAcrossThreads) {
+  std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(104.0, kSeconds, kSampleRate));
+  bpm::Options options = hierarchical();
+  options.threads = 1;
+  bpm::Result single = bpm::Analyzer(kSampleRate, options).analyzeEnvelope(nrg);
+
+  options.threads = 6;
+  bpm::Result parallel = bpm::Analyzer(kSampleRate, options).analyzeEnvelope(nrg);
+  CHECK_EQ(parallel.bpm, single.bpm);
+  CHECK_EQ(parallel.lookups, single.lookups);
+}
+
+TEST(refinementStaysInsideTheRange) {
+  // A tempo right at the edge puts a trough on the last coarse step, its refinement must not step outside
+  bpm::Options options = hierarchical();
+  options.minBPM = 100.0;
+  options.maxBPM = 120.0;
+  std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(120.0, kSeconds, kSampleRate));
+
+  bpm::Result result = bpm::Analyzer(kSampleRate, options).analyzeEnvelope(nrg);
+  CHECK(result.bpm >= options.minBPM - 1e-9);
+  CHECK(result.bpm <= options.maxBPM + 1e-9);
+  CHECK_NEAR(result.bpm, 120.0, 1.0);
+}
+
+TEST(emptyBudgetsFindNothing) {
+  std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(120.0, 5.0, kSampleRate));
+  for (unsigned int bpm::Options::*budget : {&bpm::Options::coarseSteps,
+                                             &bpm::Options::coarseSamples,
+                                             &bpm::Options::troughs,
+                                             &bpm::Options::refineSteps,
+                                             &bpm::Options::refineSamples}) {
+    bpm::Options options = hierarchical();
+    options.*budget = 0;
+    CHECK_EQ(bpm::Analyzer(kSampleRate, options).analyzeEnvelope(nrg).bpm, 0.0);
+  }
+}
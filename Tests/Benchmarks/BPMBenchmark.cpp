@@ -0,0 +1,185 @@
+//
+//  BPMBenchmark.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMEngine.h"
+#include "BPMKernel.h"
+#include "SpectralFlux.h"
+#include "TestSignals.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr double kSampleRate = 44100.0;
+
+struct Corpus {
+  size_t signals = 16;
+  double seconds = 30.0;
+  /// Intervals and midpoints per interval for the kernel sweep, the exhaustive search's defaults.
+  unsigned int steps = 1024;
+  unsigned int samples = 1024;
+};
+
+template <typename Body> double timeSeconds(Body body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Tempos spread over the default range, clear of its edges so half and double tempo errors stay visible.
+double tempoForSignal(size_t index, size_t signals) {
+  bpm::Options defaults;
+  double low = defaults.minBPM + 2.0;
+  double high = defaults.maxBPM - 2.0;
+  return signals == 1 ? (low + high) / 2.0 : low + (high - low) * index / (signals - 1);
+}
+
+/// The analyzer with default options over click tracks, every core.
+void benchmarkAnalyzer(const Corpus &corpus) {
+  double seconds = 0.0;
+  double totalError = 0.0;
+  size_t lookups = 0;
+
+  for (size_t i = 0; i < corpus.signals; i++) {
+    double truth = tempoForSignal(i, corpus.signals);
+    std::vector<float> samples = signals::clickTrack(truth, corpus.seconds, kSampleRate, i + 1);
+
+    bpm::Result result;
+    seconds += timeSeconds([&] { result = bpm::Analyzer(kSampleRate).analyze(samples); });
+    totalError += std::fabs(result.bpm - truth);
+    lookups += result.lookups;
+  }
+
+  std::printf("analyzer: %zu click tracks of %.0fs, mean error %.2f BPM, %.1fms per track, %.0fx realtime, "
+              "%.1fM lookups/s\n",
+              corpus.signals,
+              corpus.seconds,
+              totalError / corpus.signals,
+              seconds / corpus.signals * 1000.0,
+              corpus.signals * corpus.seconds / seconds,
+              lookups / seconds / 1e6);
+}
+
+/// Both engines over the same drum loops, every core. Counts estimates within 2 BPM, the tolerance `consensus()` uses.
+void benchmarkEngines(const Corpus &corpus) {
+  const bpm::Engine engines[] = {bpm::Engine::Autodifference, bpm::Engine::SpectralFlux};
+  for (bpm::Engine engine : engines) {
+    double seconds = 0.0;
+    double totalError = 0.0;
+    size_t accurate = 0;
+
+    for (size_t i = 0; i < corpus.signals; i++) {
+      double truth = tempoForSignal(i, corpus.signals);
+      std::vector<float> samples = signals::drumLoop(truth, corpus.seconds, kSampleRate, i + 1);
+
+      bpm::Result result;
+      seconds += timeSeconds([&] {
+        if (engine == bpm::Engine::SpectralFlux) {
+          bpm::SpectralFlux flux(kSampleRate);
+          flux.process(samples);
+          result = flux.estimate();
+        } else {
+          result = bpm::Analyzer(kSampleRate).analyze(samples);
+        }
+      });
+
+      double error = std::fabs(result.bpm - truth);
+      totalError += error;
+      if (error <= 2.0) accurate++;
+    }
+
+    std::printf("engine: %-14s %zu/%zu drum loops within 2 BPM, mean error %.2f BPM, %.0fx realtime\n",
+                engine == bpm::Engine::SpectralFlux ? "spectral flux" : "autodifference",
+                accurate,
+                corpus.signals,
+                totalError / corpus.signals,
+                corpus.signals * corpus.seconds / seconds);
+  }
+}
+
+/// Exhaustive sweep against coarse-to-fine search on the same envelopes, single threaded so the work shows.
+void benchmarkSearch(const Corpus &corpus) {
+  const bpm::SearchMode modes[] = {bpm::SearchMode::Exhaustive, bpm::SearchMode::Hierarchical};
+  for (bpm::SearchMode mode : modes) {
+    bpm::Options options;
+    options.search = mode;
+    options.threads = 1;
+
+    double seconds = 0.0;
+    double totalError = 0.0;
+    size_t lookups = 0;
+    for (size_t i = 0; i < corpus.signals; i++) {
+      double truth = tempoForSignal(i, corpus.signals);
+      std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(truth, corpus.seconds, kSampleRate, i + 1));
+
+      bpm::Result result;
+      seconds += timeSeconds([&] { result = bpm::Analyzer(kSampleRate, options).analyzeEnvelope(nrg); });
+      totalError += std::fabs(result.bpm - truth);
+      lookups += result.lookups;
+    }
+
+    std::printf("search: %-12s mean error %.2f BPM, %.1fM lookups and %.1fms per track\n",
+                mode == bpm::SearchMode::Exhaustive ? "exhaustive" : "hierarchical",
+                totalError / corpus.signals,
+                lookups / 1e6 / corpus.signals,
+                seconds / corpus.signals * 1000.0);
+  }
+}
+
+/// One exhaustive sweep through the dispatched kernel and through the scalar reference, single threaded.
+void benchmarkKernel(const Corpus &corpus) {
+  std::vector<float> nrg = bpm::Analyzer::envelope(signals::clickTrack(120.0, corpus.seconds, kSampleRate));
+  signals::Random random(1);
+  std::vector<double> mids(corpus.samples);
+  for (double &mid : mids) {
+    mid = (random.bipolar() * 0.5 + 0.5) * nrg.size();
+  }
+
+  auto sweep = [&](auto kernel) {
+    double sink = 0.0;
+    double seconds = timeSeconds([&] {
+      for (unsigned int step = 0; step < corpus.steps; step++) {
+        sink += kernel(nrg, 150.0 + step * 0.1, mids);
+      }
+    });
+    return std::make_pair(seconds, sink);
+  };
+
+  auto [scalarSeconds, scalarSum] = sweep(bpm::autodifferenceSumScalar);
+  auto [kernelSeconds, kernelSum] = sweep(bpm::autodifferenceSum);
+  double lookups = (double)corpus.steps * corpus.samples * bpm::kLookupsPerMidpoint;
+
+  std::printf("kernel: scalar %.1fM lookups/s, %s %.1fM lookups/s (%.1fx), results %s\n",
+              lookups / scalarSeconds / 1e6,
+              bpm::autodifferenceKernelName(),
+              lookups / kernelSeconds / 1e6,
+              scalarSeconds / kernelSeconds,
+              scalarSum == kernelSum ? "identical" : "DIFFER");
+}
+
+} // namespace
+
+/// Pass `--quick` for a short smoke run, as ctest does.
+int main(int argc, char **argv) {
+  Corpus corpus;
+  if (argc > 1 && std::strcmp(argv[1], "--quick") == 0) {
+    corpus.signals = 2;
+    // Spectral flux needs four periods of the slowest tempo twice over, about 8s at the default range
+    corpus.seconds = 10.0;
+    corpus.steps = 64;
+  }
+
+  benchmarkAnalyzer(corpus);
+  benchmarkKernel(corpus);
+  benchmarkEngines(corpus);
+  benchmarkSearch(corpus);
+  return 0;
+}
@@ -0,0 +1,104 @@
+//
+//  DirectoryWalkerBenchmark.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "DirectoryWalker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kTracksPerAlbum = 12;
+constexpr size_t kAlbumsPerArtist = 8;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void touch(const std::filesystem::path &path) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+/// Spreads `files` empty tracks over artist/album folders with a cover and a cue sheet each, alternating formats the
+/// way a real library mixes them.
+void buildTree(const std::filesystem::path &root, size_t files) {
+  static const char *const kExtensions[] = {"mp3", "flac", "m4a", "MP3"};
+
+  size_t track = 0;
+  for (size_t artist = 0; track < files; artist++) {
+    for (size_t album = 0; album < kAlbumsPerArtist && track < files; album++) {
+      std::filesystem::path folder = root / ("Artist " + std::to_string(artist)) / ("Album " + std::to_string(album));
+      std::filesystem::create_directories(folder);
+      touch(folder / "cover.jpg");
+      touch(folder / "album.cue");
+
+      for (size_t number = 1; number <= kTracksPerAlbum && track < files; number++, track++) {
+        touch(folder / (std::to_string(number) + " Track." + kExtensions[track % 4]));
+      }
+    }
+  }
+}
+
+/// Walks the tree the way DirectoryScanner does, with its extensions.
+double timeWalk(const std::filesystem::path &root, unsigned threads, library::WalkStats &stats) {
+  library::WalkOptions options;
+  options.extensions = {"mp3", "m4a", "wav", "aiff", "flac", "aac", "ogg", "wma"};
+  options.threads = threads;
+
+  uint64_t delivered = 0;
+  auto start = std::chrono::steady_clock::now();
+  stats = library::walkDirectories({root.string()}, options, [&](std::vector<std::string> &&paths) {
+    delivered += paths.size();
+  });
+  double seconds = secondsSince(start);
+  stats.matches = delivered;
+  return seconds;
+}
+
+} // namespace
+
+/// Walks a library-shaped tree on one thread and on every core. Both walks run against a warm cache, so this measures
+/// the walker, not the disk. Pass `--quick` for a short smoke run, as ctest does.
+int main(int argc, char **argv) {
+  size_t files = 100000;
+  if (argc > 1 && std::strcmp(argv[1], "--quick") == 0) {
+    files = 2000;
+  }
+  unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::filesystem::path root =
+      std::filesystem::temp_directory_path() / ("DirectoryWalkerBenchmark-" + std::to_string(getpid()));
+  std::error_code error;
+  std::filesystem::remove_all(root, error);
+
+  auto start = std::chrono::steady_clock::now();
+  buildTree(root, files);
+  double setupSeconds = secondsSince(start);
+
+  library::WalkStats stats;
+  double singleThreadSeconds = timeWalk(root, 1, stats);
+  double parallelSeconds = timeWalk(root, threads, stats);
+  std::filesystem::remove_all(root, error);
+
+  std::printf("walk: %llu files in %llu folders (built in %.1fs), 1 thread %.1fms, %u threads %.1fms\n",
+              (unsigned long long)stats.matches,
+              (unsigned long long)stats.directories,
+              setupSeconds,
+              singleThreadSeconds * 1000.0,
+              threads,
+              parallelSeconds * 1000.0);
+  return 0;
+}
@@ -0,0 +1,162 @@
+//
+//  WaveformBenchmark.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "PeakFile.h"
+#include "PeakKernel.h"
+#include "TestSignals.h"
+#include "WaveformRaster.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <span>
+
+namespace {
+
+/// Roughly what AVAssetReader hands out per sample buffer.
+constexpr size_t kChunkFrames = 8192;
+
+struct Corpus {
+  double seconds = 600.0;
+  double sampleRate = 44100.0;
+  uint32_t channels = 2;
+  /// Columns and rows of the waveform view.
+  size_t width = 1200;
+  uint32_t height = 64;
+  int rasterIterations = 200;
+};
+
+template <typename Body> double timeSeconds(Body body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// The per-sample loop WaveformGenerator used before peak files: normalize, square, branch on the pixel edge.
+void legacyRMS(std::span<const int16_t> samples, std::vector<float> &pixels) {
+  size_t samplesPerPixel = std::max<size_t>(samples.size() / pixels.size(), 1);
+  size_t pixel = 0;
+  size_t inPixel = 0;
+  double sumSquares = 0.0;
+
+  for (int16_t sample : samples) {
+    float normalized = sample / 32768.0f;
+    sumSquares += normalized * normalized;
+    inPixel++;
+
+    if (inPixel >= samplesPerPixel) {
+      if (pixel < pixels.size()) {
+        pixels[pixel] = std::sqrt((float)(sumSquares / inPixel));
+      }
+      pixel++;
+      sumSquares = 0.0;
+      inPixel = 0;
+      if (pixel >= pixels.size()) break;
+    }
+  }
+}
+
+/// One `measure` call per pixel, the way the peak writer hands whole blocks to the kernel.
+template <typename Measure>
+void blockRMS(std::span<const int16_t> samples, std::vector<float> &pixels, Measure measure) {
+  size_t samplesPerPixel = std::max<size_t>(samples.size() / pixels.size(), 1);
+  for (size_t pixel = 0; pixel < pixels.size() && pixel * samplesPerPixel < samples.size(); pixel++) {
+    std::span<const int16_t> run = samples.subspan(pixel * samplesPerPixel);
+    run = run.first(std::min(run.size(), samplesPerPixel));
+    pixels[pixel] = std::sqrt((float)(measure(run).sumSquares / run.size()));
+  }
+}
+
+/// Builds a peak file in decoder-sized chunks, all levels included, then renders it at the view's width.
+void benchmarkDownsample(const Corpus &corpus, std::span<const int16_t> samples) {
+  uint64_t frames = samples.size() / corpus.channels;
+  std::vector<uint8_t> file;
+
+  double seconds = timeSeconds([&] {
+    waveform::PeakWriter writer(corpus.sampleRate, corpus.channels, waveform::framesPerBlockFor(frames));
+    std::span<const int16_t> remaining = samples;
+    while (!remaining.empty()) {
+      size_t count = std::min(remaining.size(), kChunkFrames * corpus.channels);
+      writer.append(remaining.first(count));
+      remaining = remaining.subspan(count);
+    }
+    file = writer.finish();
+  });
+
+  waveform::PeakReader reader;
+  if (!reader.open(file.data(), file.size())) {
+    std::printf("downsample: could not read back the peak file\n");
+    return;
+  }
+  std::vector<waveform::Peak> columns(corpus.width);
+  double renderSeconds = timeSeconds([&] { reader.render(columns); });
+
+  std::printf("downsample: %.0fs of audio in %.1fms, %.1fM samples/s, %zu bytes, render %zu columns in %.3fms\n",
+              corpus.seconds,
+              seconds * 1000.0,
+              samples.size() / seconds / 1e6,
+              file.size(),
+              corpus.width,
+              renderSeconds * 1000.0);
+}
+
+/// Reduces the same samples to one RMS value per column three ways: the legacy loop, the scalar reference and the
+/// dispatched SIMD kernel.
+void benchmarkKernel(const Corpus &corpus, std::span<const int16_t> samples) {
+  std::vector<float> pixels(corpus.width);
+  auto scalar = [](std::span<const int16_t> run) { return waveform::measureScalar(run); };
+  auto kernel = [](std::span<const int16_t> run) { return waveform::measure(run); };
+
+  double legacySeconds = timeSeconds([&] { legacyRMS(samples, pixels); });
+  double scalarSeconds = timeSeconds([&] { blockRMS(samples, pixels, scalar); });
+  double kernelSeconds = timeSeconds([&] { blockRMS(samples, pixels, kernel); });
+
+  std::printf("kernel: legacy %.1fM samples/s, scalar %.1fM samples/s, %s %.1fM samples/s (%.1fx legacy)\n",
+              samples.size() / legacySeconds / 1e6,
+              samples.size() / scalarSeconds / 1e6,
+              waveform::peakKernelName(),
+              samples.size() / kernelSeconds / 1e6,
+              legacySeconds / kernelSeconds);
+}
+
+/// Two-tone rasterization of the signal's envelope at the view's size, averaged over a few hundred frames.
+void benchmarkRaster(const Corpus &corpus, std::span<const int16_t> samples) {
+  std::vector<float> amplitudes(corpus.width);
+  blockRMS(samples, amplitudes, [](std::span<const int16_t> run) { return waveform::measure(run); });
+
+  uint32_t width = (uint32_t)corpus.width;
+  std::vector<uint8_t> pixels((size_t)width * corpus.height * 4);
+  waveform::PixelBuffer buffer{pixels.data(), width, corpus.height, (size_t)width * 4};
+  waveform::RasterStyle style{{128, 128, 128, 128}, {10, 132, 255, 255}, width / 3.0};
+
+  double seconds = timeSeconds([&] {
+    for (int i = 0; i < corpus.rasterIterations; i++) {
+      waveform::rasterizeWaveform(amplitudes, buffer, style);
+    }
+  });
+
+  std::printf("raster: %ux%u in %.3fms\n", width, corpus.height, seconds / corpus.rasterIterations * 1000.0);
+}
+
+} // namespace
+
+/// Pass `--quick` for a short smoke run, as ctest does.
+int main(int argc, char **argv) {
+  Corpus corpus;
+  if (argc > 1 && std::strcmp(argv[1], "--quick") == 0) {
+    corpus.seconds = 10.0;
+    corpus.rasterIterations = 10;
+  }
+
+  std::vector<int16_t> samples = signals::swellingTone(corpus.seconds, corpus.sampleRate, corpus.channels);
+  benchmarkDownsample(corpus, samples);
+  benchmarkKernel(corpus, samples);
+  benchmarkRaster(corpus, samples);
+  return 0;
+}
@@ -0,0 +1,178 @@
+//
+//  CompressedEnvelopeTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "CompressedEnvelope.h"
+#include "PeakFile.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// The fixtures come from Tools/GenerateCompressedFixtures.cpp, these mirror the gains it writes
+uint32_t gainAt(size_t index) {
+  return 170 + (uint32_t)(index * 5 % 60);
+}
+
+bool silentAt(size_t index) {
+  return index % 7 == 6;
+}
+
+/// Level of granule or frame `index`, relative to unity gain at `offset`.
+float expectedLevel(size_t index, int offset) {
+  return silentAt(index) ? 0.0f : std::exp2f(((int)gainAt(index) - offset) * 0.25f);
+}
+
+std::optional<waveform::CompressedEnvelope> read(const std::vector<uint8_t> &bytes) {
+  return waveform::readCompressedEnvelope(bytes.data(), bytes.size());
+}
+
+/// Checks the first `count` levels against the fixture gains.
+void checkLevels(const waveform::CompressedEnvelope &envelope, size_t count, int gainOffset) {
+  REQUIRE(envelope.levels.size() >= count);
+  for (size_t i = 0; i < count; i++) {
+    CHECK_NEAR(envelope.levels[i], expectedLevel(i, gainOffset), expectedLevel(i, gainOffset) * 1e-6);
+  }
+}
+
+/// Every prefix of `bytes` up to `dense` bytes, then every `stride`th, so each cut point inside the first frames
+/// is covered without reading the whole file thousands of times.
+std::vector<size_t> cutPoints(size_t size, size_t dense, size_t stride) {
+  std::vector<size_t> sizes;
+  for (size_t cut = 0; cut < size; cut += cut < dense ? 1 : stride) {
+    sizes.push_back(cut);
+  }
+  return sizes;
+}
+
+} // namespace
+
+TEST(readsMPEG1StereoBehindTagAndXingFrame) {
+  std::vector<uint8_t> bytes = check::readFixture("Stereo44k.mp3");
+  REQUIRE(!bytes.empty());
+  std::optional<waveform::CompressedEnvelope> envelope = read(bytes);
+  REQUIRE(envelope);
+
+  CHECK(envelope->format == waveform::CompressedFormat::MP3);
+  CHECK_EQ(envelope->sampleRate, 44100u);
+  CHECK_EQ(envelope->channels, 2u);
+  CHECK_EQ(envelope->framesPerLevel, 576u);
+  // Two granules for each of the 40 frames, the Xing frame and the sync words in the tag add nothing
+  CHECK_EQ(envelope->levels.size(), (size_t)80);
+  checkLevels(*envelope, 80, 210);
+}
+
+TEST(readsMPEG2MonoWithCRC) {
+  std::optional<waveform::CompressedEnvelope> envelope = read(check::readFixture("Mono22k.mp3"));
+  REQUIRE(envelope);
+
+  CHECK_EQ(envelope->sampleRate, 22050u);
+  CHECK_EQ(envelope->channels, 1u);
+  CHECK_EQ(envelope->levels.size(), (size_t)30);
+  checkLevels(*envelope, 30, 210);
+}
+
+TEST(resyncsPastDamage) {
+  std::optional<waveform::CompressedEnvelope> envelope = read(check::readFixture("Resync.mp3"));
+  REQUIRE(envelope);
+  CHECK_EQ(envelope->levels.size(), (size_t)80);
+  checkLevels(*envelope, 80, 210);
+}
+
+TEST(readsADTS) {
+  std::optional<waveform::CompressedEnvelope> envelope = read(check::readFixture("Stereo44k.aac"));
+  REQUIRE(envelope);
+
+  CHECK(envelope->format == waveform::CompressedFormat::ADTS);
+  CHECK_EQ(envelope->sampleRate, 44100u);
+  CHECK_EQ(envelope->channels, 2u);
+  CHECK_EQ(envelope->framesPerLevel, 1024u);
+  // Frames with eight short windows and an M/S mask included
+  CHECK_EQ(envelope->levels.size(), (size_t)24);
+  checkLevels(*envelope, 24, 170);
+}
+
+TEST(truncatedStreamKeepsItsWholeFrames) {
+  // One 417-byte frame and 300 bytes of the next, which used to be read past the end while confirming sync
+  std::vector<uint8_t> bytes = check::readFixture("Truncated.mp3");
+  REQUIRE(bytes.size() == 717);
+
+  std::optional<waveform::CompressedEnvelope> envelope = read(bytes);
+  REQUIRE(envelope);
+  CHECK_EQ(envelope->levels.size(), (size_t)2);
+  checkLevels(*envelope, 2, 210);
+}
+
+TEST(everyTruncationReadsAPrefix) {
+  for (const char *name : {"Stereo44k.mp3", "Mono22k.mp3", "Stereo44k.aac"}) {
+    std::vector<uint8_t> bytes = check::readFixture(name);
+    REQUIRE(!bytes.empty());
+    std::optional<waveform::CompressedEnvelope> whole = read(bytes);
+    REQUIRE(whole);
+
+    // Copies, so the sanitizers see exactly where each cut ends
+    for (size_t size : cutPoints(bytes.size(), 2000, 97)) {
+      std::vector<uint8_t> cut(bytes.begin(), bytes.begin() + size);
+      std::optional<waveform::CompressedEnvelope> envelope = read(cut);
+      if (!envelope) continue;
+
+      CHECK(envelope->levels.size() <= whole->levels.size());
+      CHECK(std::equal(envelope->levels.begin(), envelope->levels.end(), whole->levels.begin()));
+    }
+  }
+}
+
+TEST(damagedStreamIsSafeToCut) {
+  // The junk header in front passes for a lone frame when a cut ends right after it, so only safety is checked
+  std::vector<uint8_t> bytes = check::readFixture("Resync.mp3");
+  REQUIRE(!bytes.empty());
+  for (size_t size : cutPoints(bytes.size(), 5000, 31)) {
+    std::vector<uint8_t> cut(bytes.begin(), bytes.begin() + size);
+    std::optional<waveform::CompressedEnvelope> envelope = read(cut);
+    CHECK(!envelope || envelope->levels.size() <= 80);
+  }
+}
+
+TEST(ignoresAnythingButAudio) {
+  CHECK(!waveform::readCompressedEnvelope(nullptr, 0));
+  CHECK(!read(std::vector<uint8_t>(4096, 0)));
+  CHECK(!read(std::vector<uint8_t>(4096, 0xFF)));
+
+  const char *text = "Not an MP3 at all, just some text that happens to be read as one.";
+  CHECK(!read(std::vector<uint8_t>(text, text + std::strlen(text))));
+
+  // Noise may hold the odd sync word, it must never be read past its end
+  signals::Random random(5);
+  for (size_t size : {3, 4, 7, 100, 10000}) {
+    std::vector<uint8_t> noise(size);
+    for (uint8_t &byte : noise) {
+      byte = (uint8_t)(random.next() >> 56);
+    }
+    read(noise);
+  }
+}
+
+TEST(encodesEnvelopeAsPeaks) {
+  std::optional<waveform::CompressedEnvelope> envelope = read(check::readFixture("Stereo44k.mp3"));
+  REQUIRE(envelope);
+  std::vector<uint8_t> file = waveform::encodeEnvelopePeaks(*envelope);
+
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+  CHECK_EQ(reader.sampleRate(), 44100u);
+  CHECK_EQ(reader.frames(), envelope->frames());
+
+  // The loudest granule becomes a full-scale sine
+  float loudest = 0.0f;
+  const waveform::PeakReader::Level &finest = reader.level(0);
+  for (size_t i = 0; i < finest.blockCount; i++) {
+    loudest = std::max(loudest, reader.peak(finest, i).max);
+  }
+  CHECK_NEAR(loudest, 1.0, 1.0 / 32767.0);
+}
@@ -0,0 +1,305 @@
+//
+//  ContentFingerprintTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "ContentFingerprint.h"
+#include "TestSignals.h"
+
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+using Bytes = std::vector<uint8_t>;
+
+namespace {
+
+/// A file under the system temp directory, removed at the end of the test.
+class ScratchFile {
+public:
+  explicit ScratchFile(const std::string &name)
+      : _path(fs::temp_directory_path() / ("ContentFingerprintTests-" + name + "-" + std::to_string(getpid()))) {}
+
+  ~ScratchFile() {
+    std::error_code error;
+    fs::remove(_path, error);
+  }
+
+  const fs::path &path() const {
+    return _path;
+  }
+
+  void write(const Bytes &bytes) {
+    std::ofstream(_path, std::ios::binary | std::ios::trunc).write((const char *)bytes.data(), bytes.size());
+  }
+
+  std::string fingerprint(size_t sampleBytes = fingerprint::kSampleBytes) const {
+    return fingerprint::fingerprintFile(_path.c_str(), sampleBytes);
+  }
+
+  fingerprint::Region region() const {
+    int fd = open(_path.c_str(), O_RDONLY);
+    fingerprint::Region region = fingerprint::audioRegion(fd, fs::file_size(_path));
+    close(fd);
+    return region;
+  }
+
+private:
+  fs::path _path;
+};
+
+/// Stands in for encoded audio, the fingerprint never looks inside it.
+Bytes payload(size_t length, uint32_t seed = 1) {
+  signals::Random random(seed);
+  Bytes bytes(length);
+  for (uint8_t &byte : bytes) {
+    byte = (uint8_t)(random.next() >> 24);
+  }
+  return bytes;
+}
+
+Bytes text(const std::string &string) {
+  return Bytes(string.begin(), string.end());
+}
+
+Bytes join(std::initializer_list<Bytes> parts) {
+  Bytes bytes;
+  for (const Bytes &part : parts) {
+    bytes.insert(bytes.end(), part.begin(), part.end());
+  }
+  return bytes;
+}
+
+Bytes bigEndian32(uint32_t value) {
+  return {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+}
+
+Bytes littleEndian32(uint32_t value) {
+  return {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+}
+
+/// A tag of `bodyLength` filler bytes, with the size as 7-bit syncsafe digits.
+Bytes id3v2(uint32_t bodyLength, bool footer = false) {
+  Bytes tag = {'I', 'D', '3', 4, 0, (uint8_t)(footer ? 0x10 : 0)};
+  for (int shift = 21; shift >= 0; shift -= 7) {
+    tag.push_back((uint8_t)((bodyLength >> shift) & 0x7F));
+  }
+  tag.resize(tag.size() + bodyLength, 'x');
+  if (footer) {
+    Bytes tail = {'3', 'D', 'I'};
+    tail.resize(10, 0);
+    tag.insert(tag.end(), tail.begin(), tail.end());
+  }
+  return tag;
+}
+
+Bytes id3v1(const std::string &title) {
+  Bytes tag = text("TAG" + title);
+  tag.resize(128, 0);
+  return tag;
+}
+
+/// An APEv2 tag with `itemsLength` bytes of items, optionally preceded by its header.
+Bytes apev2(uint32_t itemsLength, bool header) {
+  auto block = [&](bool isHeader) {
+    Bytes bytes = join({text("APETAGEX"), littleEndian32(2000), littleEndian32(itemsLength + 32), littleEndian32(1),
+                        littleEndian32((header ? 0x80000000u : 0) | (isHeader ? 0x20000000u : 0))});
+    bytes.resize(32, 0);
+    return bytes;
+  };
+  Bytes tag = header ? block(true) : Bytes();
+  tag.resize(tag.size() + itemsLength, 'i');
+  Bytes footer = block(false);
+  tag.insert(tag.end(), footer.begin(), footer.end());
+  return tag;
+}
+
+Bytes flacBlock(uint8_t type, uint32_t length, bool last) {
+  Bytes block(4 + length, type);
+  block[0] = (uint8_t)(type | (last ? 0x80 : 0));
+  block[1] = (uint8_t)(length >> 16);
+  block[2] = (uint8_t)(length >> 8);
+  block[3] = (uint8_t)length;
+  return block;
+}
+
+Bytes box(const std::string &type, const Bytes &body) {
+  return join({bigEndian32((uint32_t)(body.size() + 8)), text(type), body});
+}
+
+/// Both formats pad chunks to even sizes, only the byte order of the size differs.
+Bytes chunk(const std::string &id, const Bytes &body, bool littleEndian) {
+  uint32_t size = (uint32_t)body.size();
+  Bytes bytes = join({text(id), littleEndian ? littleEndian32(size) : bigEndian32(size), body});
+  if (size & 1) {
+    bytes.push_back(0);
+  }
+  return bytes;
+}
+
+} // namespace
+
+TEST(mp3TagsAreLeftOutOfTheRegion) {
+  Bytes audio = payload(5000);
+  ScratchFile file("mp3");
+
+  file.write(audio);
+  std::string bare = file.fingerprint();
+  CHECK_EQ(bare.size(), (size_t)32);
+  CHECK_EQ(file.region().offset, (uint64_t)0);
+  CHECK_EQ(file.region().length, (uint64_t)audio.size());
+
+  // Stacked ID3v2 tags in front, one of them with a footer
+  Bytes front = join({id3v2(300), id3v2(41, true)});
+  file.write(join({front, audio}));
+  CHECK_EQ(file.region().offset, (uint64_t)front.size());
+  CHECK_EQ(file.region().length, (uint64_t)audio.size());
+  CHECK_EQ(file.fingerprint(), bare);
+
+  // ID3v1 and APEv2 at the end, in either order
+  file.write(join({front, audio, apev2(77, true), id3v1("Title")}));
+  CHECK_EQ(file.region().length, (uint64_t)audio.size());
+  CHECK_EQ(file.fingerprint(), bare);
+
+  file.write(join({audio, id3v1("Title"), apev2(12, false)}));
+  CHECK_EQ(file.region().offset, (uint64_t)0);
+  CHECK_EQ(file.region().length, (uint64_t)audio.size());
+  CHECK_EQ(file.fingerprint(), bare);
+}
+
+TEST(retaggingKeepsTheKey) {
+  Bytes audio = payload(200000, 7);
+  ScratchFile file("retag");
+
+  file.write(join({id3v2(120), audio, id3v1("Before")}));
+  std::string before = file.fingerprint();
+
+  // A longer tag moves the audio, new titles change the bytes around it
+  file.write(join({id3v2(4096), audio, apev2(300, true), id3v1("After")}));
+  CHECK_EQ(file.fingerprint(), before);
+
+  // Different audio is a different key
+  Bytes edited = audio;
+  edited.back() ^= 1;
+  file.write(join({id3v2(4096), edited, id3v1("After")}));
+  CHECK(file.fingerprint() != before);
+}
+
+TEST(flacSkipsMetadataBlocks) {
+  Bytes frames = payload(3000, 3);
+  ScratchFile file("flac");
+
+  Bytes metadata = join({text("fLaC"), flacBlock(0, 34, false), flacBlock(4, 90, false), flacBlock(1, 500, true)});
+  file.write(join({metadata, frames}));
+  CHECK_EQ(file.region().offset, (uint64_t)metadata.size());
+  CHECK_EQ(file.region().length, (uint64_t)frames.size());
+  std::string tagged = file.fingerprint();
+
+  // Vorbis comments edited, padding shrunk to match
+  Bytes retagged = join({text("fLaC"), flacBlock(0, 34, false), flacBlock(4, 400, false), flacBlock(1, 10, true)});
+  file.write(join({retagged, frames}));
+  CHECK_EQ(file.fingerprint(), tagged);
+
+  // An ID3v2 tag some taggers put in front of FLAC is skipped too
+  file.write(join({id3v2(64), retagged, frames}));
+  CHECK_EQ(file.fingerprint(), tagged);
+}
+
+TEST(mp4HashesTheMdatBox) {
+  Bytes audio = payload(4000, 5);
+  Bytes ftyp = box("ftyp", join({text("M4A "), Bytes(4), text("M4A mp42")}));
+  ScratchFile file("mp4");
+
+  file.write(join({ftyp, box("moov", payload(700, 9)), box("mdat", audio)}));
+  CHECK_EQ(file.region().offset, (uint64_t)(ftyp.size() + 708 + 8));
+  CHECK_EQ(file.region().length, (uint64_t)audio.size());
+  std::string key = file.fingerprint();
+
+  // Rewritten metadata, now after the audio with a free box in between
+  file.write(join({ftyp, box("mdat", audio), box("free", Bytes(16)), box("moov", payload(900, 11))}));
+  CHECK_EQ(file.region().length, (uint64_t)audio.size());
+  CHECK_EQ(file.fingerprint(), key);
+
+  // A 64-bit box size
+  Bytes large = join({bigEndian32(1), text("mdat"), bigEndian32(0), bigEndian32((uint32_t)audio.size() + 16), audio});
+  file.write(join({ftyp, large}));
+  CHECK_EQ(file.region().offset, (uint64_t)(ftyp.size() + 16));
+  CHECK_EQ(file.fingerprint(), key);
+
+  // Size zero runs to the end of the file
+  file.write(join({ftyp, bigEndian32(0), text("mdat"), audio}));
+  CHECK_EQ(file.fingerprint(), key);
+}
+
+TEST(wavAndAiffHashTheirDataChunks) {
+  Bytes samples = payload(6001, 13);
+  ScratchFile file("pcm");
+
+  auto wav = [&](const Bytes &info) {
+    Bytes chunks = join({text("WAVE"), chunk("fmt ", Bytes(16, 1), true), chunk("LIST", info, true),
+                         chunk("data", samples, true), chunk("id3 ", id3v2(20), true)});
+    return join({text("RIFF"), littleEndian32((uint32_t)chunks.size()), chunks});
+  };
+  // Odd-sized chunks check the padding byte
+  file.write(wav(join({text("INFOINAM"), littleEndian32(5), text("Title")})));
+  CHECK_EQ(file.region().length, (uint64_t)samples.size());
+  std::string wavKey = file.fingerprint();
+  file.write(wav(join({text("INFOINAM"), littleEndian32(12), text("Longer Title")})));
+  CHECK_EQ(file.fingerprint(), wavKey);
+
+  auto aiff = [&](const Bytes &name) {
+    Bytes chunks = join({text("AIFF"), chunk("COMM", Bytes(18, 2), false), chunk("NAME", name, false),
+                         chunk("SSND", samples, false)});
+    return join({text("FORM"), bigEndian32((uint32_t)chunks.size()), chunks});
+  };
+  file.write(aiff(text("Title")));
+  CHECK_EQ(file.region().length, (uint64_t)samples.size());
+  std::string aiffKey = file.fingerprint();
+  file.write(aiff(text("Title Longer")));
+  CHECK_EQ(file.fingerprint(), aiffKey);
+}
+
+TEST(longPayloadsAreHashedByTheirEnds) {
+  Bytes audio = payload(10000, 17);
+  ScratchFile file("ends");
+
+  file.write(audio);
+  std::string key = file.fingerprint(1024);
+
+  Bytes middle = audio;
+  middle[5000] ^= 1;
+  file.write(middle);
+  CHECK_EQ(file.fingerprint(1024), key);
+
+  Bytes head = audio;
+  head[10] ^= 1;
+  file.write(head);
+  CHECK(file.fingerprint(1024) != key);
+
+  // The length is part of the key even when both ends match
+  Bytes longer = audio;
+  longer.insert(longer.begin() + 5000, 0);
+  file.write(longer);
+  CHECK(file.fingerprint(1024) != key);
+}
+
+TEST(emptyAndMissingFiles) {
+  ScratchFile file("empty");
+
+  // Nothing but a tag leaves an empty payload, which still has a key
+  file.write(id3v2(50));
+  CHECK_EQ(file.region().length, (uint64_t)0);
+  CHECK_EQ(file.fingerprint().size(), (size_t)32);
+
+  file.write(Bytes());
+  CHECK(file.fingerprint().empty());
+
+  ScratchFile missing("missing");
+  CHECK(missing.fingerprint().empty());
+}
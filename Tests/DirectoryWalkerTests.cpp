@@ -0,0 +1,219 @@
+//
+//  DirectoryWalkerTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "DirectoryWalker.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// A folder under the system temp directory, removed with everything in it at the end of the test.
+class ScratchTree {
+public:
+  explicit ScratchTree(const std::string &name)
+      : _root(fs::temp_directory_path() / ("DirectoryWalkerTests-" + name + "-" + std::to_string(getpid()))) {
+    fs::remove_all(_root);
+    fs::create_directories(_root);
+  }
+
+  ~ScratchTree() {
+    std::error_code error;
+    fs::remove_all(_root, error);
+  }
+
+  const fs::path &root() const {
+    return _root;
+  }
+
+  /// Creates `relativePath` with `bytes` in it, and any folders on the way.
+  fs::path file(const std::string &relativePath, const std::string &bytes = "") {
+    fs::path path = _root / relativePath;
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << bytes;
+    return path;
+  }
+
+private:
+  fs::path _root;
+};
+
+struct Walk {
+  library::WalkStats stats;
+  /// Relative to the walked tree, sorted.
+  std::vector<std::string> paths;
+  size_t largestBatch = 0;
+};
+
+library::WalkOptions audioOptions() {
+  library::WalkOptions options;
+  options.extensions = {"mp3", "flac", "m4a"};
+  return options;
+}
+
+Walk walk(const ScratchTree &tree,
+          const library::WalkOptions &options,
+          std::vector<std::string> roots = {},
+          const std::atomic<bool> *cancelled = nullptr) {
+  if (roots.empty()) {
+    roots.push_back(tree.root().string());
+  }
+
+  Walk result;
+  std::mutex mutex;
+  result.stats = library::walkDirectories(roots, options, [&](std::vector<std::string> &&paths) {
+    std::lock_guard<std::mutex> lock(mutex);
+    result.largestBatch = std::max(result.largestBatch, paths.size());
+    for (const std::string &path : paths) {
+      result.paths.push_back(fs::path(path).lexically_relative(tree.root()).string());
+    }
+  }, cancelled);
+  std::sort(result.paths.begin(), result.paths.end());
+  return result;
+}
+
+} // namespace
+
+TEST(matchesExtensionsCaseInsensitively) {
+  ScratchTree tree("extensions");
+  tree.file("Artist/Album/1 Track.mp3");
+  tree.file("Artist/Album/2 Track.FLAC");
+  tree.file("Artist/Album/3 Track.m4a");
+  tree.file("Artist/Album/cover.jpg");
+  tree.file("Artist/Album/album.cue");
+  tree.file("Artist/Album/noextension");
+  tree.file("Artist/Album/mp3");
+
+  Walk result = walk(tree, audioOptions());
+  std::vector<std::string> expected = {"Artist/Album/1 Track.mp3", "Artist/Album/2 Track.FLAC",
+                                       "Artist/Album/3 Track.m4a"};
+  CHECK(result.paths == expected);
+  CHECK_EQ(result.stats.matches, (uint64_t)3);
+  CHECK_EQ(result.stats.entries, (uint64_t)9);
+  CHECK_EQ(result.stats.directories, (uint64_t)3);
+  CHECK_EQ(result.stats.errors, (uint64_t)0);
+
+  // No extensions matches every file
+  CHECK_EQ(walk(tree, library::WalkOptions()).paths.size(), (size_t)7);
+}
+
+TEST(skipsHiddenFilesAndFolders) {
+  ScratchTree tree("hidden");
+  tree.file("Album/Track.mp3");
+  tree.file("Album/._Track.mp3");
+  tree.file(".Trashes/Deleted.mp3");
+
+  Walk hidden = walk(tree, audioOptions());
+  CHECK(hidden.paths == std::vector<std::string>{"Album/Track.mp3"});
+
+  library::WalkOptions options = audioOptions();
+  options.skipHidden = false;
+  CHECK_EQ(walk(tree, options).paths.size(), (size_t)3);
+}
+
+TEST(skipsSymlinksInsideTheTree) {
+  ScratchTree tree("symlinks");
+  fs::path track = tree.file("Album/Track.mp3");
+  fs::create_directories(tree.root() / "Playlists");
+  fs::create_symlink(track, tree.root() / "Playlists/Track.mp3");
+  fs::create_symlink("../Album/Track.mp3", tree.root() / "Playlists/Relative.mp3");
+  fs::create_symlink("Missing.mp3", tree.root() / "Playlists/Dangling.mp3");
+  // A folder linking back up would loop if it was followed
+  fs::create_directory_symlink(tree.root(), tree.root() / "Album/Loop");
+  fs::create_directory_symlink(tree.root() / "Album", tree.root() / "Linked Album");
+
+  Walk result = walk(tree, audioOptions());
+  CHECK(result.paths == std::vector<std::string>{"Album/Track.mp3"});
+  CHECK_EQ(result.stats.directories, (uint64_t)3);
+}
+
+TEST(followsSymlinkedRoots) {
+  ScratchTree tree("roots");
+  tree.file("Music/Album/Track.mp3");
+  fs::path single = tree.file("Single.flac");
+  fs::create_directory_symlink(tree.root() / "Music", tree.root() / "Linked Music");
+
+  Walk result = walk(tree, audioOptions(), {(tree.root() / "Linked Music").string(), single.string()});
+  std::vector<std::string> expected = {"Linked Music/Album/Track.mp3", "Single.flac"};
+  CHECK(result.paths == expected);
+
+  Walk missing = walk(tree, audioOptions(), {(tree.root() / "Nowhere").string()});
+  CHECK(missing.paths.empty());
+  CHECK_EQ(missing.stats.errors, (uint64_t)1);
+}
+
+TEST(walksDeepAndWideTreesOnManyThreads) {
+  ScratchTree tree("deep");
+  std::vector<std::string> expected;
+  std::string nested;
+  for (int depth = 0; depth < 40; depth++) {
+    nested += "Level " + std::to_string(depth) + "/";
+    expected.push_back(tree.file(nested + "Track.mp3").lexically_relative(tree.root()).string());
+  }
+  for (int artist = 0; artist < 20; artist++) {
+    for (int album = 0; album < 5; album++) {
+      std::string folder = "Artist " + std::to_string(artist) + "/Album " + std::to_string(album) + "/";
+      for (int number = 0; number < 4; number++) {
+        fs::path track = tree.file(folder + std::to_string(number) + ".m4a");
+        expected.push_back(track.lexically_relative(tree.root()).string());
+      }
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  library::WalkOptions options = audioOptions();
+  options.threads = 6;
+  options.batchSize = 7;
+  Walk result = walk(tree, options);
+  CHECK(result.paths == expected);
+  CHECK_EQ(result.stats.matches, (uint64_t)expected.size());
+  CHECK(result.largestBatch <= options.batchSize);
+}
+
+TEST(cancelledWalkTakesNoFolders) {
+  ScratchTree tree("cancelled");
+  tree.file("Album/Track.mp3");
+  fs::path single = tree.file("Single.mp3");
+
+  std::atomic<bool> cancelled{true};
+  Walk result = walk(tree, audioOptions(), {tree.root().string(), single.string()}, &cancelled);
+  // Plain file roots are matched before any folder is taken
+  CHECK(result.paths == std::vector<std::string>{"Single.mp3"});
+  CHECK_EQ(result.stats.directories, (uint64_t)0);
+}
+
+TEST(statsFilesForRescans) {
+  ScratchTree tree("stat");
+  fs::path track = tree.file("Track.mp3", "abc");
+
+  library::FileStatus status = library::statFile(track.string());
+  CHECK(status.state == library::FileState::Present);
+  CHECK_EQ(status.stamp.size, (uint64_t)3);
+  CHECK(status.stamp.inode != 0);
+
+  tree.file("Track.mp3", "abcdef");
+  library::FileStatus changed = library::statFile(track.string());
+  CHECK_EQ(changed.stamp.size, (uint64_t)6);
+  CHECK(!(changed.stamp == status.stamp));
+
+  CHECK(library::statFile((tree.root() / "Missing.mp3").string()).state == library::FileState::Missing);
+  CHECK(library::statFile((tree.root() / "Track.mp3/Below").string()).state == library::FileState::Missing);
+  CHECK(library::statFile(tree.root().string()).state == library::FileState::Missing);
+
+  std::vector<std::string> paths = {track.string(), (tree.root() / "Missing.mp3").string(), track.string()};
+  std::vector<library::FileStatus> statuses = library::statFiles(paths, 2);
+  REQUIRE(statuses.size() == 3);
+  CHECK(statuses[0].state == library::FileState::Present);
+  CHECK(statuses[1].state == library::FileState::Missing);
+  CHECK(statuses[2].stamp == statuses[0].stamp);
+}
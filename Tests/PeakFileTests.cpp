@@ -0,0 +1,237 @@
+//
+//  PeakFileTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "PeakFile.h"
+#include "TestSignals.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr double kSampleRate = 44100.0;
+constexpr uint32_t kChannels = 2;
+/// Small enough for a handful of levels on a few seconds of audio.
+constexpr uint32_t kFramesPerBlock = 1024;
+/// One quantization step of the stored min, max and RMS.
+constexpr double kStep = 1.0 / 32767.0;
+
+std::vector<uint8_t> writeInChunks(std::span<const int16_t> samples, size_t chunk) {
+  waveform::PeakWriter writer(kSampleRate, kChannels, kFramesPerBlock);
+  while (!samples.empty()) {
+    size_t count = std::min(samples.size(), chunk);
+    writer.append(samples.first(count));
+    samples = samples.subspan(count);
+  }
+  return writer.finish();
+}
+
+} // namespace
+
+TEST(levelsGetCoarserByTheLevelFactor) {
+  std::vector<int16_t> samples = signals::swellingTone(10.0, kSampleRate, kChannels);
+  std::vector<uint8_t> file = writeInChunks(samples, 8192);
+
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+  CHECK_EQ(reader.sampleRate(), (uint32_t)kSampleRate);
+  CHECK_EQ(reader.frames(), (uint64_t)(samples.size() / kChannels));
+  REQUIRE(reader.levelCount() > 1);
+
+  CHECK_EQ(reader.level(0).framesPerBlock, kFramesPerBlock);
+  CHECK_EQ(reader.level(0).blockCount, (uint32_t)((reader.frames() + kFramesPerBlock - 1) / kFramesPerBlock));
+  for (size_t i = 1; i < reader.levelCount(); i++) {
+    CHECK_EQ(reader.level(i).framesPerBlock, reader.level(i - 1).framesPerBlock * waveform::kLevelFactor);
+    CHECK_EQ(reader.level(i).blockCount,
+             (reader.level(i - 1).blockCount + waveform::kLevelFactor - 1) / waveform::kLevelFactor);
+  }
+  CHECK(reader.level(reader.levelCount() - 1).blockCount <= waveform::kMinLevelBlocks);
+  CHECK(reader.level(reader.levelCount() - 2).blockCount > waveform::kMinLevelBlocks);
+}
+
+TEST(blocksHoldTheirSamplesPeaks) {
+  std::vector<int16_t> samples = signals::swellingTone(3.0, kSampleRate, kChannels);
+  std::vector<uint8_t> file = writeInChunks(samples, samples.size());
+
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+  const waveform::PeakReader::Level &finest = reader.level(0);
+  std::span<const int16_t> all(samples);
+
+  for (size_t block = 0; block < finest.blockCount; block++) {
+    std::span<const int16_t> run = all.subspan(block * kFramesPerBlock * kChannels);
+    run = run.first(std::min<size_t>(run.size(), kFramesPerBlock * kChannels));
+    waveform::SampleStats expected = waveform::measureScalar(run);
+
+    waveform::Peak peak = reader.peak(finest, block);
+    CHECK_NEAR(peak.min, expected.min, kStep);
+    CHECK_NEAR(peak.max, expected.max, kStep);
+    CHECK_NEAR(peak.rms, std::sqrt(expected.sumSquares / run.size()), kStep);
+  }
+}
+
+TEST(chunkingDoesNotChangeTheFile) {
+  std::vector<int16_t> samples = signals::swellingTone(5.0, kSampleRate, kChannels);
+  std::vector<uint8_t> whole = writeInChunks(samples, samples.size());
+
+  // Odd chunk sizes split frames and straddle blocks
+  for (size_t chunk : {1, 7, 2047, 2048, 8193}) {
+    CHECK(writeInChunks(samples, chunk) == whole);
+  }
+}
+
+TEST(segmentsJoinLikeOneWriter) {
+  std::vector<int16_t> samples = signals::swellingTone(5.0, kSampleRate, kChannels);
+  std::span<const int16_t> all(samples);
+  std::vector<uint8_t> whole = writeInChunks(samples, samples.size());
+
+  // Segments decoded in parallel start on a block boundary
+  size_t split = 37 * kFramesPerBlock * kChannels;
+  waveform::PeakWriter first(kSampleRate, kChannels, kFramesPerBlock);
+  waveform::PeakWriter second(kSampleRate, kChannels, kFramesPerBlock);
+  first.append(all.first(split));
+  second.append(all.subspan(split));
+  first.appendSegment(std::move(second));
+  CHECK(first.finish() == whole);
+}
+
+TEST(segmentAfterAPartialBlockClosesIt) {
+  waveform::PeakWriter first(kSampleRate, 1, kFramesPerBlock);
+  waveform::PeakWriter second(kSampleRate, 1, kFramesPerBlock);
+  std::vector<int16_t> samples = signals::swellingTone(1.0, kSampleRate, 1);
+  first.append(std::span<const int16_t>(samples).first(kFramesPerBlock + 10));
+  second.append(std::span<const int16_t>(samples).first(kFramesPerBlock));
+  first.appendSegment(std::move(second));
+  CHECK_EQ(first.frames(), (uint64_t)(2 * kFramesPerBlock + 10));
+
+  std::vector<uint8_t> file = first.finish();
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+  CHECK_EQ(reader.level(0).blockCount, 3u);
+}
+
+TEST(snapshotCoversClosedBlocks) {
+  std::vector<int16_t> samples = signals::swellingTone(2.0, kSampleRate, kChannels);
+  waveform::PeakWriter writer(kSampleRate, kChannels, kFramesPerBlock);
+  writer.append(std::span<const int16_t>(samples).first((5 * kFramesPerBlock + 100) * kChannels));
+  CHECK_EQ(writer.completedFrames(), (uint64_t)(5 * kFramesPerBlock));
+
+  std::vector<uint8_t> snapshot = writer.snapshot();
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(snapshot.data(), snapshot.size()));
+  CHECK_EQ(reader.frames(), writer.completedFrames());
+  CHECK_EQ(reader.level(0).blockCount, 5u);
+
+  // Taking a snapshot leaves the writer as it was
+  writer.append(std::span<const int16_t>(samples).subspan((5 * kFramesPerBlock + 100) * kChannels));
+  CHECK(writer.finish() == writeInChunks(samples, samples.size()));
+}
+
+TEST(nothingAppendedEncodesNothing) {
+  waveform::PeakWriter writer(kSampleRate, kChannels, kFramesPerBlock);
+  CHECK(writer.snapshot().empty());
+  writer.append(std::span<const int16_t>());
+  writer.appendLevel(0.5f, 0);
+  CHECK(writer.finish().empty());
+
+  // A partial block is still a block
+  std::vector<int16_t> samples = signals::swellingTone(0.01, kSampleRate, kChannels);
+  waveform::PeakWriter partial(kSampleRate, kChannels, kFramesPerBlock);
+  partial.append(samples);
+  CHECK(partial.snapshot().empty());
+  std::vector<uint8_t> file = partial.finish();
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+  CHECK_EQ(reader.level(0).blockCount, 1u);
+}
+
+TEST(levelsStandInForASine) {
+  waveform::PeakWriter writer(kSampleRate, kChannels, kFramesPerBlock);
+  writer.appendLevel(0.5f, 10 * kFramesPerBlock);
+  writer.appendLevel(0.9f, 10 * kFramesPerBlock);
+  std::vector<uint8_t> file = writer.finish();
+
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+  waveform::Peak quiet = reader.peak(reader.level(0), 0);
+  CHECK_NEAR(quiet.rms, 0.5, kStep);
+  CHECK_NEAR(quiet.max, 0.5 * M_SQRT2, kStep);
+  CHECK_NEAR(quiet.min, -0.5 * M_SQRT2, kStep);
+
+  // Peaks clip at full scale, the level does not
+  waveform::Peak loud = reader.peak(reader.level(0), 15);
+  CHECK_NEAR(loud.rms, 0.9, kStep);
+  CHECK_NEAR(loud.max, 1.0, kStep);
+}
+
+TEST(renderMergesBlocksPerColumn) {
+  std::vector<int16_t> samples = signals::swellingTone(10.0, kSampleRate, kChannels);
+  std::vector<uint8_t> file = writeInChunks(samples, 8192);
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+
+  for (size_t width : {1, 13, 100, 431, 2000}) {
+    std::vector<waveform::Peak> columns(width);
+    reader.render(columns);
+
+    float loudest = 0.0f;
+    for (const waveform::Peak &column : columns) {
+      CHECK(column.min <= column.max);
+      CHECK(column.rms >= 0.0f && column.rms <= std::max(column.max, -column.min) + kStep);
+      loudest = std::max(loudest, column.max);
+    }
+
+    // Merging keeps the overall peak whatever the width
+    float expected = 0.0f;
+    for (int16_t sample : samples) {
+      expected = std::max(expected, sample / 32768.0f);
+    }
+    CHECK_NEAR(loudest, expected, kStep);
+  }
+}
+
+TEST(rejectsAnythingButAPeakFile) {
+  std::vector<uint8_t> file = writeInChunks(signals::swellingTone(3.0, kSampleRate, kChannels), 8192);
+  waveform::PeakReader reader;
+  REQUIRE(reader.open(file.data(), file.size()));
+
+  CHECK(!reader.open(nullptr, 0));
+  for (size_t size = 0; size < file.size(); size += std::max<size_t>(1, size / 8)) {
+    CHECK(!reader.open(file.data(), size));
+  }
+  CHECK(!reader.open(file.data(), file.size() - 1));
+
+  std::vector<uint8_t> badMagic = file;
+  badMagic[0] = 'X';
+  CHECK(!reader.open(badMagic.data(), badMagic.size()));
+
+  std::vector<uint8_t> newerVersion = file;
+  newerVersion[4] = waveform::kPeakFileVersion + 1;
+  CHECK(!reader.open(newerVersion.data(), newerVersion.size()));
+
+  std::vector<uint8_t> noLevels = file;
+  noLevels[6] = noLevels[7] = 0;
+  CHECK(!reader.open(noLevels.data(), noLevels.size()));
+}
+
+TEST(blockSizeKeepsFilesSmall) {
+  CHECK_EQ(waveform::framesPerBlockFor(0), 64u);
+  CHECK_EQ(waveform::framesPerBlockFor(64 * waveform::kMaxBaseBlocks), 64u);
+  CHECK_EQ(waveform::framesPerBlockFor(64 * waveform::kMaxBaseBlocks + 1), 128u);
+
+  // An hour at 44.1 kHz
+  uint64_t frames = 3600 * 44100;
+  uint32_t framesPerBlock = waveform::framesPerBlockFor(frames);
+  CHECK((frames + framesPerBlock - 1) / framesPerBlock <= waveform::kMaxBaseBlocks);
+  CHECK((frames + framesPerBlock / 2 - 1) / (framesPerBlock / 2) > waveform::kMaxBaseBlocks);
+}
+
+TEST(matchesGoldenFile) {
+  // Regenerate with ILLUMINATED_UPDATE_GOLDEN=1 after a deliberate format change, and bump kPeakFileVersion
+  std::vector<uint8_t> file = writeInChunks(signals::swellingTone(10.0, kSampleRate, kChannels), 8192);
+  CHECK(check::matchesGolden(file, "SwellingTone.ipkf"));
+}
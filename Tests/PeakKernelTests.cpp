@@ -0,0 +1,118 @@
+//
+//  PeakKernelTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "PeakKernel.h"
+#include "TestSignals.h"
+
+#include <cstdio>
+
+namespace {
+
+std::vector<int16_t> randomSamples(size_t count, uint64_t seed) {
+  signals::Random random(seed);
+  std::vector<int16_t> samples(count);
+  for (int16_t &sample : samples) {
+    sample = (int16_t)(random.next() >> 48);
+  }
+  return samples;
+}
+
+std::vector<float> toFloat(const std::vector<int16_t> &samples) {
+  std::vector<float> converted(samples.size());
+  for (size_t i = 0; i < samples.size(); i++) {
+    converted[i] = samples[i] / 32768.0f;
+  }
+  return converted;
+}
+
+/// Lengths around every lane width and the float kernels' 1024-sample stretch, so each tail path runs.
+const size_t kLengths[] = {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1023, 1024, 1025, 4100, 100000};
+
+} // namespace
+
+TEST(reportsKernel) {
+  std::printf("peak kernel: %s\n", waveform::peakKernelName());
+}
+
+TEST(int16MatchesScalarExactly) {
+  std::vector<int16_t> samples = randomSamples(100000 + 3, 11);
+  std::span<const int16_t> all(samples);
+
+  for (size_t length : kLengths) {
+    // Odd offsets keep the loads unaligned
+    for (size_t offset : {0, 1, 3}) {
+      std::span<const int16_t> run = all.subspan(offset, length);
+      waveform::SampleStats simd = waveform::measure(run);
+      waveform::SampleStats scalar = waveform::measureScalar(run);
+      CHECK_EQ(simd.min, scalar.min);
+      CHECK_EQ(simd.max, scalar.max);
+      CHECK_EQ(simd.sumSquares, scalar.sumSquares);
+    }
+  }
+}
+
+TEST(int16FullScaleDoesNotOverflow) {
+  // A pair of -32768 squares sums to exactly 2^31, one past INT32_MAX
+  for (int16_t value : {INT16_MIN, INT16_MAX}) {
+    std::vector<int16_t> samples(4099, value);
+    waveform::SampleStats stats = waveform::measure(samples);
+    CHECK_EQ(stats.min, value / 32768.0f);
+    CHECK_EQ(stats.max, value / 32768.0f);
+    CHECK_EQ(stats.sumSquares, waveform::measureScalar(samples).sumSquares);
+    CHECK_NEAR(stats.sumSquares, samples.size() * (value / 32768.0) * (value / 32768.0), 1e-9);
+  }
+}
+
+TEST(floatMatchesScalarUpToRounding) {
+  std::vector<float> samples = toFloat(randomSamples(100000 + 3, 12));
+  std::span<const float> all(samples);
+
+  for (size_t length : kLengths) {
+    for (size_t offset : {0, 1, 3}) {
+      std::span<const float> run = all.subspan(offset, length);
+      waveform::SampleStats simd = waveform::measure(run);
+      waveform::SampleStats scalar = waveform::measureScalar(run);
+      CHECK_EQ(simd.min, scalar.min);
+      CHECK_EQ(simd.max, scalar.max);
+      CHECK_NEAR(simd.sumSquares, scalar.sumSquares, scalar.sumSquares * 1e-5);
+    }
+  }
+}
+
+TEST(int16AndFloatAgree) {
+  std::vector<int16_t> samples = signals::swellingTone(1.0, 44100.0, 2);
+  waveform::SampleStats fromInt = waveform::measure(samples);
+  waveform::SampleStats fromFloat = waveform::measure(toFloat(samples));
+  CHECK_EQ(fromInt.min, fromFloat.min);
+  CHECK_EQ(fromInt.max, fromFloat.max);
+  CHECK_NEAR(fromInt.sumSquares, fromFloat.sumSquares, fromInt.sumSquares * 1e-5);
+}
+
+TEST(emptyRunMergesAsNothing) {
+  std::vector<int16_t> samples = randomSamples(100, 13);
+  waveform::SampleStats stats = waveform::measure(samples);
+  waveform::SampleStats merged = stats;
+  merged.merge(waveform::measure(std::span<const int16_t>()));
+  merged.merge(waveform::measure(std::span<const float>()));
+
+  CHECK_EQ(merged.min, stats.min);
+  CHECK_EQ(merged.max, stats.max);
+  CHECK_EQ(merged.sumSquares, stats.sumSquares);
+}
+
+TEST(mergedRunsMatchOneRun) {
+  std::vector<int16_t> samples = randomSamples(5000, 14);
+  std::span<const int16_t> all(samples);
+  waveform::SampleStats merged = waveform::measure(all.first(1234));
+  merged.merge(waveform::measure(all.subspan(1234)));
+
+  waveform::SampleStats whole = waveform::measure(all);
+  CHECK_EQ(merged.min, whole.min);
+  CHECK_EQ(merged.max, whole.max);
+  CHECK_NEAR(merged.sumSquares, whole.sumSquares, whole.sumSquares * 1e-12);
+}
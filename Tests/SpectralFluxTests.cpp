@@ -0,0 +1,156 @@
+//
+//  SpectralFluxTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "BPMConsensus.h"
+#include "Check.h"
+#include "FFT.h"
+#include "SpectralFlux.h"
+#include "TestSignals.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr double kSampleRate = 44100.0;
+constexpr double kSeconds = 20.0;
+
+/// Textbook O(n^2) DFT in double precision, the reference both transforms are held to.
+void naiveDFT(const std::vector<float> &inReal, const std::vector<float> &inImag, std::vector<double> &outReal,
+              std::vector<double> &outImag) {
+  size_t n = inReal.size();
+  outReal.assign(n, 0.0);
+  outImag.assign(n, 0.0);
+  for (size_t k = 0; k < n; k++) {
+    for (size_t t = 0; t < n; t++) {
+      double angle = -2.0 * M_PI * (double)(k * t % n) / n;
+      outReal[k] += inReal[t] * std::cos(angle) - inImag[t] * std::sin(angle);
+      outImag[k] += inReal[t] * std::sin(angle) + inImag[t] * std::cos(angle);
+    }
+  }
+}
+
+std::vector<float> randomSignal(size_t size, uint64_t seed) {
+  signals::Random random(seed);
+  std::vector<float> values(size);
+  for (float &value : values) {
+    value = (float)random.bipolar();
+  }
+  return values;
+}
+
+bpm::Result estimate(const std::vector<float> &samples, bpm::Options options = {}) {
+  bpm::SpectralFlux flux(kSampleRate, options);
+  flux.process(samples);
+  return flux.estimate();
+}
+
+bpm::Result window(double bpm, double confidence) {
+  bpm::Result result;
+  result.bpm = bpm;
+  result.confidence = confidence;
+  return result;
+}
+
+} // namespace
+
+TEST(fftMatchesNaiveDFT) {
+  for (size_t size : {1, 2, 4, 8, 64, 512}) {
+    std::vector<float> real = randomSignal(size, size);
+    std::vector<float> imag = randomSignal(size, size + 1);
+    std::vector<double> expectedReal, expectedImag;
+    naiveDFT(real, imag, expectedReal, expectedImag);
+
+    bpm::FFT(size).forward(real.data(), imag.data());
+    for (size_t k = 0; k < size; k++) {
+      CHECK_NEAR(real[k], expectedReal[k], 1e-3);
+      CHECK_NEAR(imag[k], expectedImag[k], 1e-3);
+    }
+  }
+}
+
+TEST(realFFTMatchesNaiveDFT) {
+  for (size_t size : {2, 8, 64, 512}) {
+    std::vector<float> input = randomSignal(size * 2, size);
+    std::vector<double> expectedReal, expectedImag;
+    naiveDFT(input, std::vector<float>(size * 2, 0.0f), expectedReal, expectedImag);
+
+    std::vector<float> real(size + 1), imag(size + 1);
+    bpm::FFT(size).forwardReal(input.data(), real.data(), imag.data());
+    for (size_t k = 0; k <= size; k++) {
+      CHECK_NEAR(real[k], expectedReal[k], 1e-3);
+      CHECK_NEAR(imag[k], expectedImag[k], 1e-3);
+    }
+  }
+}
+
+TEST(findsTempoOfDrumLoops) {
+  for (double truth : {84.0, 98.0, 120.0, 128.0, 146.0}) {
+    bpm::Result result = estimate(signals::drumLoop(truth, kSeconds, kSampleRate));
+    CHECK_NEAR(result.bpm, truth, 2.0);
+    CHECK(result.confidence > 0.0);
+  }
+}
+
+TEST(findsTempoOfClickTracks) {
+  for (double truth : {90.0, 110.0, 132.0}) {
+    CHECK_NEAR(estimate(signals::clickTrack(truth, kSeconds, kSampleRate)).bpm, truth, 2.0);
+  }
+}
+
+TEST(onsetsDoNotDependOnChunking) {
+  std::vector<float> samples = signals::drumLoop(120.0, 5.0, kSampleRate);
+  bpm::SpectralFlux whole(kSampleRate);
+  whole.process(samples);
+
+  bpm::SpectralFlux chunked(kSampleRate);
+  std::span<const float> rest(samples);
+  for (size_t chunk = 1; !rest.empty(); chunk = chunk * 3 + 7) {
+    size_t take = std::min(chunk, rest.size());
+    chunked.process(rest.first(take));
+    rest = rest.subspan(take);
+  }
+
+  REQUIRE(whole.onsets().size() == chunked.onsets().size());
+  CHECK_EQ(whole.onsets().size(), (samples.size() - bpm::SpectralFlux::kFrameSize) / bpm::SpectralFlux::kHopSize + 1);
+  for (size_t i = 0; i < whole.onsets().size(); i++) {
+    CHECK_EQ(whole.onsets()[i], chunked.onsets()[i]);
+  }
+}
+
+TEST(tooLittleAudioHasNoTempo) {
+  CHECK_EQ(estimate(signals::drumLoop(120.0, 1.0, kSampleRate)).bpm, 0.0);
+  CHECK_EQ(estimate({}).bpm, 0.0);
+
+  bpm::Options inverted;
+  inverted.minBPM = 150.0;
+  inverted.maxBPM = 90.0;
+  CHECK_EQ(estimate(signals::drumLoop(120.0, kSeconds, kSampleRate), inverted).bpm, 0.0);
+}
+
+TEST(consensusPicksTheBestBackedCluster) {
+  std::vector<bpm::Result> windows = {window(120.0, 0.6), window(60.0, 0.9), window(121.0, 0.5),
+                                      window(0.0, 0.0), window(119.5, 0.4)};
+  bpm::Consensus result = bpm::consensus(windows);
+
+  CHECK_EQ(result.agreeing, (size_t)3);
+  CHECK_NEAR(result.bpm, (120.0 * 0.6 + 121.0 * 0.5 + 119.5 * 0.4) / 1.5, 1e-9);
+  // Three of the four windows with an estimate, at their mean confidence
+  CHECK_NEAR(result.confidence, 0.75 * 0.5, 1e-9);
+}
+
+TEST(consensusTiesKeepTheEarliestWindow) {
+  std::vector<bpm::Result> windows = {window(100.0, 0.5), window(140.0, 0.5)};
+  CHECK_EQ(bpm::consensus(windows).bpm, 100.0);
+}
+
+TEST(consensusOfNothingIsEmpty) {
+  std::vector<bpm::Result> windows = {window(0.0, 0.0), window(-1.0, 1.0)};
+  bpm::Consensus result = bpm::consensus(windows);
+  CHECK_EQ(result.bpm, 0.0);
+  CHECK_EQ(result.agreeing, (size_t)0);
+  CHECK_EQ(bpm::consensus({}).bpm, 0.0);
+}
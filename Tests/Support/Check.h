@@ -0,0 +1,81 @@
+//
+//  Check.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Just enough of a test framework for the portable C++ under `Core/Audio`, so the tests build with nothing but a
+/// compiler. Each test file is its own executable, `CheckMain.cpp` runs whatever it registered with `TEST`.
+namespace check {
+
+using TestBody = void (*)();
+
+/// Adds a test at static initialization, see `TEST`.
+struct Registration {
+  Registration(const char *name, TestBody body);
+};
+
+/// Thrown by `REQUIRE` to end the current test, which is then reported as failed.
+struct Abort {};
+
+/// Marks the current test as failed and prints where, then carries on.
+void fail(const char *file, int line, const std::string &message);
+
+/// Absolute path of a checked-in file under `Tests/Fixtures`.
+std::string fixturePath(const std::string &name);
+
+/// Set through `ILLUMINATED_UPDATE_GOLDEN=1`, golden tests then rewrite their fixtures instead of comparing.
+bool updatingGoldenFiles();
+
+/// Contents of a checked-in fixture, empty when it cannot be read.
+std::vector<uint8_t> readFixture(const std::string &name);
+
+/// Compares `bytes` with the golden fixture `name`, or rewrites that fixture when updating golden files.
+bool matchesGolden(const std::vector<uint8_t> &bytes, const std::string &name);
+
+template <typename A, typename B> std::string describe(const char *expression, const A &a, const B &b) {
+  std::ostringstream stream;
+  stream << expression << " (" << a << " vs " << b << ")";
+  return stream.str();
+}
+
+} // namespace check
+
+#define TEST(name)                                                                                                     \
+  static void name();                                                                                                  \
+  static check::Registration name##Registration(#name, name);                                                          \
+  static void name()
+
+#define CHECK(condition)                                                                                               \
+  do {                                                                                                                 \
+    if (!(condition)) check::fail(__FILE__, __LINE__, #condition);                                                    \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                                                                 \
+  do {                                                                                                                 \
+    if (!((a) == (b))) check::fail(__FILE__, __LINE__, check::describe(#a " == " #b, (a), (b)));                       \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tolerance)                                                                                    \
+  do {                                                                                                                 \
+    if (!(std::fabs((double)(a) - (double)(b)) <= (tolerance)))                                                        \
+      check::fail(__FILE__, __LINE__, check::describe(#a " ~= " #b, (a), (b)));                                        \
+  } while (0)
+
+/// Like `CHECK`, but ends the test, for preconditions the rest of it depends on.
+#define REQUIRE(condition)                                                                                             \
+  do {                                                                                                                 \
+    if (!(condition)) {                                                                                                \
+      check::fail(__FILE__, __LINE__, #condition);                                                                     \
+      throw check::Abort();                                                                                            \
+    }                                                                                                                  \
+  } while (0)
@@ -0,0 +1,100 @@
+//
+//  CheckMain.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <vector>
+
+namespace check {
+
+namespace {
+
+struct TestCase {
+  const char *name;
+  TestBody body;
+};
+
+/// Function-local so registrations from other translation units never see it unconstructed.
+std::vector<TestCase> &registry() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+int failures = 0;
+
+} // namespace
+
+Registration::Registration(const char *name, TestBody body) {
+  registry().push_back({name, body});
+}
+
+void fail(const char *file, int line, const std::string &message) {
+  std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, message.c_str());
+  failures++;
+}
+
+std::string fixturePath(const std::string &name) {
+  return std::string(ILLUMINATED_FIXTURES_DIR) + "/" + name;
+}
+
+bool updatingGoldenFiles() {
+  const char *value = std::getenv("ILLUMINATED_UPDATE_GOLDEN");
+  return value && std::strcmp(value, "1") == 0;
+}
+
+std::vector<uint8_t> readFixture(const std::string &name) {
+  // Sized up front, so the sanitizers flag any read past the end of the fixture
+  std::ifstream file(fixturePath(name), std::ios::binary | std::ios::ate);
+  std::vector<uint8_t> bytes(file ? (size_t)file.tellg() : 0);
+  file.seekg(0);
+  file.read((char *)bytes.data(), (std::streamsize)bytes.size());
+  return file ? bytes : std::vector<uint8_t>();
+}
+
+bool matchesGolden(const std::vector<uint8_t> &bytes, const std::string &name) {
+  if (updatingGoldenFiles()) {
+    std::ofstream file(fixturePath(name), std::ios::binary | std::ios::trunc);
+    file.write((const char *)bytes.data(), (std::streamsize)bytes.size());
+    std::printf("updated %s\n", name.c_str());
+    return file.good();
+  }
+  return readFixture(name) == bytes;
+}
+
+} // namespace check
+
+/// Runs every registered test, or only those whose name contains the first argument.
+int main(int argc, char **argv) {
+  const char *filter = argc > 1 ? argv[1] : nullptr;
+  int failedTests = 0;
+  int ran = 0;
+
+  for (const check::TestCase &test : check::registry()) {
+    if (filter && !std::strstr(test.name, filter)) continue;
+
+    int failuresBefore = check::failures;
+    try {
+      test.body();
+    } catch (const check::Abort &) {
+    } catch (const std::exception &exception) {
+      check::fail(test.name, 0, std::string("uncaught exception: ") + exception.what());
+    }
+
+    bool passed = check::failures == failuresBefore;
+    std::printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.name);
+    failedTests += passed ? 0 : 1;
+    ran++;
+  }
+
+  std::printf("%d of %d tests passed\n", ran - failedTests, ran);
+  return failedTests == 0 && ran > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,86 @@
+//
+//  TestSignals.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "TestSignals.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace signals {
+
+uint64_t Random::next() {
+  uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+double Random::bipolar() {
+  return (next() >> 11) * 0x1.0p-53 * 2.0 - 1.0;
+}
+
+std::vector<float> clickTrack(double bpm, double seconds, double sampleRate, uint64_t seed) {
+  std::vector<float> samples((size_t)(seconds * sampleRate));
+  double period = sampleRate * 60.0 / bpm;
+  double clickLength = 0.010 * sampleRate;
+  Random random(seed);
+
+  for (size_t i = 0; i < samples.size(); i++) {
+    double sinceBeat = std::fmod((double)i, period);
+    double click = sinceBeat < clickLength ? 0.9 * std::exp(-sinceBeat / (clickLength / 4.0)) : 0.0;
+    samples[i] = (float)((click + 0.02) * random.bipolar());
+  }
+
+  return samples;
+}
+
+std::vector<float> drumLoop(double bpm, double seconds, double sampleRate, uint64_t seed) {
+  std::vector<float> samples((size_t)(seconds * sampleRate));
+  double period = sampleRate * 60.0 / bpm;
+  Random random(seed);
+
+  for (size_t i = 0; i < samples.size(); i++) {
+    double t = (double)i;
+    double beat = std::fmod(t, period);
+    double offbeat = std::fmod(t + period / 2.0, period);
+
+    double kick = 0.8 * std::sin(2.0 * M_PI * 70.0 * t / sampleRate) * std::exp(-beat / (0.045 * sampleRate));
+    double hat = 0.3 * std::sin(2.0 * M_PI * 3500.0 * t / sampleRate) * std::exp(-offbeat / (0.007 * sampleRate));
+    double pad =
+        0.2 * std::sin(2.0 * M_PI * 220.0 * t / sampleRate) + 0.15 * std::sin(2.0 * M_PI * 330.0 * t / sampleRate);
+
+    samples[i] = (float)(kick + hat + pad + 0.1 * random.bipolar());
+  }
+
+  return samples;
+}
+
+std::vector<int16_t> swellingTone(double seconds, double sampleRate, uint32_t channels, uint64_t seed) {
+  size_t frames = (size_t)(seconds * sampleRate);
+  int64_t tonePeriod = std::max<int64_t>((int64_t)(sampleRate / 110.0), 1);
+  int64_t swellPeriod = std::max<int64_t>((int64_t)(sampleRate * 7.0), 1);
+  std::vector<int16_t> samples(frames * channels);
+  Random random(seed);
+
+  for (size_t i = 0; i < frames; i++) {
+    int64_t phase = (int64_t)(i % tonePeriod) * 4 * 32767 / tonePeriod;
+    int64_t tone = phase < 2 * 32767 ? phase - 32767 : 3 * 32767 - phase;
+
+    // Loudness in 1/1024ths, from about 0.05 up to 0.9 and back
+    int64_t swell = (int64_t)(i % swellPeriod);
+    int64_t loudness = 51 + std::min(swell, swellPeriod - swell) * 2 * 870 / swellPeriod;
+
+    for (uint32_t channel = 0; channel < channels; channel++) {
+      int64_t noise = (int64_t)(random.next() >> 53) - 1024;
+      samples[i * channels + channel] = (int16_t)std::clamp<int64_t>(tone * loudness / 1024 + noise, -32768, 32767);
+    }
+  }
+
+  return samples;
+}
+
+} // namespace signals
@@ -0,0 +1,43 @@
+//
+//  TestSignals.h
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// Deterministic synthetic audio shared by the tests and benchmarks. Generated rather than checked in, so a corpus
+/// of any length costs nothing in the repository and every run sees exactly the same samples.
+namespace signals {
+
+/// SplitMix64, the same generator the BPM engine seeds its midpoints with.
+class Random {
+public:
+  explicit Random(uint64_t seed) : _state(seed) {
+  }
+
+  uint64_t next();
+
+  /// Uniform in [-1, 1)
+  double bipolar();
+
+private:
+  uint64_t _state;
+};
+
+/// Mono metronome at `bpm`: a 10 ms burst of decaying noise on every beat over a faint noise floor.
+std::vector<float> clickTrack(double bpm, double seconds, double sampleRate, uint64_t seed = 1);
+
+/// Mono drum loop at `bpm`: a decaying 70 Hz kick on the beat, a short hat on the off-beat, a sustained pad and noise.
+/// Closer to music than `clickTrack`, the pad and the off-beat hat are what trip up an onset detector.
+std::vector<float> drumLoop(double bpm, double seconds, double sampleRate, uint64_t seed = 1);
+
+/// Interleaved 16-bit PCM: a 110 Hz triangle whose loudness swells and fades every 7 seconds, plus noise. Integer
+/// arithmetic only, so golden waveforms built from it come out the same with any libm.
+std::vector<int16_t> swellingTone(double seconds, double sampleRate, uint32_t channels, uint64_t seed = 1);
+
+} // namespace signals
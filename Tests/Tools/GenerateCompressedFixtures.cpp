@@ -0,0 +1,249 @@
+//
+//  GenerateCompressedFixtures.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+// Writes the MP3 and ADTS fixtures under Tests/Fixtures that CompressedEnvelopeTests reads. The envelope reader only
+// looks at frame headers and side information, so the frames carry real headers and gains over silent main data
+// instead of encoded audio, and no encoder is needed:
+//
+//   ./build/GenerateCompressedFixtures Tests/Fixtures
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+class BitWriter {
+public:
+  explicit BitWriter(Bytes &bytes) : _bytes(bytes) {}
+
+  void write(uint32_t value, int bits) {
+    for (int i = bits - 1; i >= 0; i--) {
+      if (_position % 8 == 0) _bytes.push_back(0);
+      _bytes.back() |= ((value >> i) & 1) << (7 - _position % 8);
+      _position++;
+    }
+  }
+
+private:
+  Bytes &_bytes;
+  size_t _position = 0;
+};
+
+/// Global gain of granule or frame `index`: a slow swell with every seventh one silent. Kept in sync with the
+/// expectations in CompressedEnvelopeTests.
+uint32_t gainAt(size_t index) {
+  return 170 + (uint32_t)(index * 5 % 60);
+}
+
+bool silentAt(size_t index) {
+  return index % 7 == 6;
+}
+
+struct MP3Stream {
+  bool mpeg1 = true;
+  bool mono = false;
+  bool crc = false;
+  /// Index into the bitrate table of the MPEG version, 9 is 128 kbps for MPEG-1 and 8 is 64 kbps for MPEG-2.
+  uint32_t bitrateIndex = 9;
+};
+
+/// One Layer III frame at 44.1 kHz (MPEG-1) or 22.05 kHz (MPEG-2). `granule` counts granules across the stream.
+Bytes mp3Frame(const MP3Stream &stream, bool padding, size_t &granule) {
+  uint32_t bitrate = (stream.mpeg1 ? 128 : 64) * 1000;
+  uint32_t sampleRate = stream.mpeg1 ? 44100 : 22050;
+  size_t length = (stream.mpeg1 ? 144 : 72) * bitrate / sampleRate + (padding ? 1 : 0);
+  uint32_t channels = stream.mono ? 1 : 2;
+
+  Bytes frame;
+  BitWriter bits(frame);
+  bits.write(0x7FF, 11);
+  bits.write(stream.mpeg1 ? 3 : 2, 2);
+  bits.write(1, 2); // Layer III
+  bits.write(stream.crc ? 0 : 1, 1);
+  bits.write(stream.bitrateIndex, 4);
+  bits.write(0, 2); // 44.1 kHz, halved for MPEG-2
+  bits.write(padding ? 1 : 0, 1);
+  bits.write(0, 1);
+  bits.write(stream.mono ? 3 : 1, 2); // single channel or joint stereo
+  bits.write(0, 6);
+  if (stream.crc) bits.write(0xBEEF, 16);
+
+  // Side information
+  if (stream.mpeg1) {
+    bits.write(0, 9);
+    bits.write(0, stream.mono ? 5 : 3);
+    bits.write(0, 4 * channels);
+  } else {
+    bits.write(0, 8);
+    bits.write(0, stream.mono ? 1 : 2);
+  }
+  for (int g = 0; g < (stream.mpeg1 ? 2 : 1); g++, granule++) {
+    for (uint32_t channel = 0; channel < channels; channel++) {
+      bits.write(silentAt(granule) ? 0 : 800, 12);      // part2_3_length
+      bits.write(100, 9);                                // big_values
+      bits.write(gainAt(granule) - channel * 10, 8);     // global_gain, the second channel quieter
+      bits.write(0, stream.mpeg1 ? 4 : 9);               // scalefac_compress
+      bits.write(0, 1);                                  // window_switching_flag
+      bits.write(0, 15 + 4 + 3);                         // table_select, region counts
+      bits.write(0, stream.mpeg1 ? 3 : 2);               // preflag, scalefac_scale, count1table_select
+    }
+  }
+
+  frame.resize(length, 0);
+  return frame;
+}
+
+/// The Xing/Info frame LAME puts first: empty side information followed by the tag.
+Bytes xingFrame() {
+  MP3Stream stream;
+  size_t unused = 0;
+  Bytes frame = mp3Frame(stream, false, unused);
+  std::fill(frame.begin() + 4, frame.end(), 0);
+  const char tag[] = "Xing";
+  std::copy(tag, tag + 4, frame.begin() + 4 + 32);
+  return frame;
+}
+
+/// An ID3v2.4 tag whose payload contains MP3 sync words, which must not be mistaken for audio.
+Bytes id3Tag() {
+  Bytes payload(300, 0);
+  for (size_t i = 0; i + 4 < payload.size(); i += 37) {
+    payload[i] = 0xFF;
+    payload[i + 1] = 0xFB;
+    payload[i + 2] = 0x90;
+    payload[i + 3] = 0x64;
+  }
+
+  uint32_t size = (uint32_t)payload.size();
+  Bytes tag = {'I', 'D', '3', 4, 0, 0};
+  tag.push_back((size >> 21) & 0x7F);
+  tag.push_back((size >> 14) & 0x7F);
+  tag.push_back((size >> 7) & 0x7F);
+  tag.push_back(size & 0x7F);
+  tag.insert(tag.end(), payload.begin(), payload.end());
+  return tag;
+}
+
+Bytes mp3Stream(const MP3Stream &stream, size_t frames) {
+  Bytes bytes;
+  size_t granule = 0;
+  for (size_t i = 0; i < frames; i++) {
+    Bytes frame = mp3Frame(stream, i % 3 == 2, granule);
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+  }
+  return bytes;
+}
+
+/// One AAC-LC ADTS frame at 44.1 kHz stereo, opening with a channel pair element that shares its ics_info. Every
+/// fourth frame uses eight short windows with an M/S mask, so the reader has to skip the grouping and mask bits.
+Bytes adtsFrame(size_t index) {
+  bool shortWindows = index % 4 == 3;
+
+  Bytes payload;
+  BitWriter bits(payload);
+  bits.write(1, 3); // ID_CPE
+  bits.write(0, 4); // element_instance_tag
+  bits.write(1, 1); // common_window
+  bits.write(0, 1); // ics_reserved_bit
+  if (shortWindows) {
+    bits.write(2, 2);    // EIGHT_SHORT_SEQUENCE
+    bits.write(0, 1);    // window_shape
+    bits.write(12, 4);   // max_sfb
+    bits.write(0x55, 7); // scale_factor_grouping, four groups
+    bits.write(1, 2);    // ms_mask_present
+    for (int i = 0; i < 4 * 12; i++) bits.write(i & 1, 1);
+  } else {
+    bits.write(0, 2);  // ONLY_LONG_SEQUENCE
+    bits.write(0, 1);  // window_shape
+    bits.write(40, 6); // max_sfb
+    bits.write(0, 1);  // predictor_data_present
+    bits.write(0, 2);  // ms_mask_present
+  }
+  bits.write(silentAt(index) ? 0 : gainAt(index) - 70, 8); // global_gain
+  payload.resize(180 + index % 5, 0);
+
+  size_t length = 7 + payload.size();
+  Bytes frame;
+  BitWriter header(frame);
+  header.write(0xFFF, 12);
+  header.write(0, 1); // MPEG-4
+  header.write(0, 2);
+  header.write(1, 1); // no CRC
+  header.write(1, 2); // AAC LC
+  header.write(4, 4); // 44.1 kHz
+  header.write(0, 1);
+  header.write(2, 3); // stereo
+  header.write(0, 4);
+  header.write((uint32_t)length, 13);
+  header.write(0x7FF, 11);
+  header.write(0, 2); // one raw data block
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  return frame;
+}
+
+bool save(const std::string &directory, const char *name, const Bytes &bytes) {
+  std::string path = directory + "/" + name;
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write((const char *)bytes.data(), (std::streamsize)bytes.size());
+  std::printf("%s: %zu bytes\n", path.c_str(), bytes.size());
+  return file.good();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    std::fprintf(stderr, "usage: %s <fixtures directory>\n", argv[0]);
+    return 1;
+  }
+  std::string directory = argv[1];
+  bool saved = true;
+
+  // MPEG-1 joint stereo at 128 kbps behind an ID3v2 tag and a Xing frame, 40 frames of two granules
+  MP3Stream stereo;
+  Bytes tagged = id3Tag();
+  Bytes xing = xingFrame();
+  Bytes frames = mp3Stream(stereo, 40);
+  tagged.insert(tagged.end(), xing.begin(), xing.end());
+  tagged.insert(tagged.end(), frames.begin(), frames.end());
+  saved &= save(directory, "Stereo44k.mp3", tagged);
+
+  // MPEG-2 mono at 64 kbps with CRCs, 30 frames of one granule
+  MP3Stream mono;
+  mono.mpeg1 = false;
+  mono.mono = true;
+  mono.crc = true;
+  mono.bitrateIndex = 8;
+  saved &= save(directory, "Mono22k.mp3", mp3Stream(mono, 30));
+
+  // The stereo stream with junk in front and a damaged stretch after the tenth frame, sync words included
+  Bytes damaged = {0xFF, 0xFB, 0x90, 0x00, 0x12, 0x34};
+  Bytes junk = {0x00, 0xFF, 0xFB, 0xFF, 0xFF, 0xFA, 0x01, 0x02, 0x03, 0xFF};
+  size_t tenth = 417 * 10 + 3; // every third frame is padded
+  damaged.insert(damaged.end(), frames.begin(), frames.begin() + tenth);
+  damaged.insert(damaged.end(), junk.begin(), junk.end());
+  damaged.insert(damaged.end(), frames.begin() + tenth, frames.end());
+  saved &= save(directory, "Resync.mp3", damaged);
+
+  // Cut off 300 bytes into the second 417-byte frame, like an interrupted download
+  Bytes truncated(frames.begin(), frames.begin() + 717);
+  saved &= save(directory, "Truncated.mp3", truncated);
+
+  Bytes adts;
+  for (size_t i = 0; i < 24; i++) {
+    Bytes frame = adtsFrame(i);
+    adts.insert(adts.end(), frame.begin(), frame.end());
+  }
+  saved &= save(directory, "Stereo44k.aac", adts);
+
+  return saved ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+//
+//  WaveformRasterTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "PeakFile.h"
+#include "TestSignals.h"
+#include "WaveformRaster.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const waveform::Color kGray = {128, 128, 128, 128};
+const waveform::Color kBlue = {10, 132, 255, 255};
+
+struct Image {
+  uint32_t width;
+  uint32_t height;
+  size_t bytesPerRow;
+  std::vector<uint8_t> pixels;
+
+  Image(uint32_t width, uint32_t height, size_t padding = 0)
+      : width(width), height(height), bytesPerRow(width * 4 + padding), pixels(bytesPerRow * height, 0xAB) {}
+
+  waveform::PixelBuffer buffer() {
+    return {pixels.data(), width, height, bytesPerRow};
+  }
+
+  const uint8_t *at(uint32_t x, uint32_t y) const {
+    return pixels.data() + y * bytesPerRow + x * 4;
+  }
+
+  bool isClear(uint32_t x, uint32_t y) const {
+    const uint8_t *pixel = at(x, y);
+    return pixel[0] == 0 && pixel[1] == 0 && pixel[2] == 0 && pixel[3] == 0;
+  }
+
+  bool is(uint32_t x, uint32_t y, waveform::Color color) const {
+    const uint8_t *pixel = at(x, y);
+    return pixel[0] == color.r && pixel[1] == color.g && pixel[2] == color.b && pixel[3] == color.a;
+  }
+
+  /// As a PAM file, which any image viewer that knows Netpbm opens. The samples stay premultiplied.
+  std::vector<uint8_t> pam() const {
+    std::string header = "P7\nWIDTH " + std::to_string(width) + "\nHEIGHT " + std::to_string(height) +
+                         "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    std::vector<uint8_t> file(header.begin(), header.end());
+    for (uint32_t y = 0; y < height; y++) {
+      file.insert(file.end(), at(0, y), at(0, y) + width * 4);
+    }
+    return file;
+  }
+};
+
+/// Premultiplied, as the rasterizer writes it.
+waveform::Color premultiplied(waveform::Color color) {
+  auto scale = [&](uint8_t value) { return (uint8_t)((value * color.a + 127) / 255); };
+  return {scale(color.r), scale(color.g), scale(color.b), color.a};
+}
+
+waveform::RasterStyle style(double playedWidth = 0.0) {
+  return {kGray, kBlue, playedWidth};
+}
+
+/// Column loudness of the swelling tone, normalized like WaveformGenerator does before rasterizing.
+std::vector<float> toneAmplitudes(size_t columns) {
+  std::vector<int16_t> samples = signals::swellingTone(14.0, 44100.0, 1);
+  waveform::PeakWriter writer(44100.0, 1, 256);
+  writer.append(samples);
+  std::vector<uint8_t> file = writer.finish();
+
+  waveform::PeakReader reader;
+  reader.open(file.data(), file.size());
+  std::vector<waveform::Peak> peaks(columns);
+  reader.render(peaks);
+
+  std::vector<float> amplitudes(columns);
+  float loudest = 0.0f;
+  for (size_t i = 0; i < columns; i++) {
+    amplitudes[i] = peaks[i].rms;
+    loudest = std::max(loudest, amplitudes[i]);
+  }
+  for (float &amplitude : amplitudes) {
+    amplitude /= loudest;
+  }
+  return amplitudes;
+}
+
+} // namespace
+
+TEST(fullAndSilentColumns) {
+  Image image(4, 10);
+  std::vector<float> amplitudes = {1.0f, 0.0f, 1.5f, -1.0f};
+  waveform::rasterizeWaveform(amplitudes, image.buffer(), style());
+
+  for (uint32_t y = 0; y < image.height; y++) {
+    CHECK(image.is(0, y, premultiplied(kGray)));
+    CHECK(image.isClear(1, y));
+    // Out of range amplitudes are clamped
+    CHECK(image.is(2, y, premultiplied(kGray)));
+    CHECK(image.isClear(3, y));
+  }
+}
+
+TEST(barsAreCenteredWithAntialiasedEnds) {
+  // Half of 10 rows is 5, 0.5 of that covers rows 2.5 to 7.5
+  Image image(1, 10);
+  std::vector<float> amplitudes = {0.5f};
+  waveform::rasterizeWaveform(amplitudes, image.buffer(), style());
+
+  waveform::Color full = premultiplied(kGray);
+  for (uint32_t y : {0u, 1u, 8u, 9u}) {
+    CHECK(image.isClear(0, y));
+  }
+  for (uint32_t y : {3u, 4u, 5u, 6u}) {
+    CHECK(image.is(0, y, full));
+  }
+  for (uint32_t y : {2u, 7u}) {
+    CHECK_EQ((int)image.at(0, y)[3], (full.a * 128 + 127) / 255);
+  }
+}
+
+TEST(playedColumnsAndTheBlendedOne) {
+  Image image(6, 4);
+  std::vector<float> amplitudes(6, 1.0f);
+  waveform::rasterizeWaveform(amplitudes, image.buffer(), style(2.5));
+
+  CHECK(image.is(0, 0, premultiplied(kBlue)));
+  CHECK(image.is(1, 3, premultiplied(kBlue)));
+  CHECK(image.is(3, 0, premultiplied(kGray)));
+  CHECK(image.is(5, 3, premultiplied(kGray)));
+
+  // Half played: somewhere between the two, more opaque than the gray alone
+  const uint8_t *blended = image.at(2, 1);
+  CHECK(blended[2] > premultiplied(kGray).b && blended[2] < premultiplied(kBlue).b);
+  CHECK(blended[3] > kGray.a);
+}
+
+TEST(fewAmplitudesAreSpreadAcrossTheWidth) {
+  Image image(9, 8);
+  std::vector<float> amplitudes = {0.25f, 1.0f, 0.5f};
+  waveform::rasterizeWaveform(amplitudes, image.buffer(), style());
+
+  for (uint32_t x = 0; x < image.width; x++) {
+    for (uint32_t y = 0; y < image.height; y++) {
+      CHECK(std::memcmp(image.at(x, y), image.at(x / 3 * 3, y), 4) == 0);
+    }
+  }
+}
+
+TEST(clearsOnlyItsOwnPixels) {
+  // Row padding belongs to the caller and must survive, everything else starts cleared
+  Image image(5, 6, 12);
+  std::vector<float> amplitudes = {0.0f};
+  waveform::rasterizeWaveform(amplitudes, image.buffer(), style());
+
+  for (uint32_t y = 0; y < image.height; y++) {
+    for (uint32_t x = 0; x < image.width; x++) {
+      CHECK(image.isClear(x, y));
+    }
+    const uint8_t *padding = image.at(image.width, y);
+    CHECK(std::all_of(padding, padding + 12, [](uint8_t byte) { return byte == 0xAB; }));
+  }
+}
+
+TEST(emptyInputsAreSafe) {
+  Image image(3, 3);
+  waveform::rasterizeWaveform({}, image.buffer(), style());
+  for (uint32_t y = 0; y < image.height; y++) {
+    for (uint32_t x = 0; x < image.width; x++) {
+      CHECK(image.isClear(x, y));
+    }
+  }
+
+  std::vector<float> amplitudes = {1.0f};
+  waveform::rasterizeWaveform(amplitudes, {nullptr, 3, 3, 12}, style());
+  waveform::rasterizeWaveform(amplitudes, {image.pixels.data(), 0, 3, 12}, style());
+  waveform::rasterizeWaveform(amplitudes, {image.pixels.data(), 3, 0, 12}, style());
+}
+
+TEST(matchesGoldenImages) {
+  // Regenerate with ILLUMINATED_UPDATE_GOLDEN=1 after a deliberate change to the drawing, then look at them
+  Image twoTone(240, 48);
+  std::vector<float> amplitudes = toneAmplitudes(twoTone.width);
+  waveform::rasterizeWaveform(amplitudes, twoTone.buffer(), style(96.4));
+  CHECK(check::matchesGolden(twoTone.pam(), "WaveformTwoTone.pam"));
+
+  // Fewer amplitudes than columns, at an odd height so the center falls inside a row
+  Image stretched(240, 31);
+  amplitudes = toneAmplitudes(70);
+  waveform::rasterizeWaveform(amplitudes, stretched.buffer(), style());
+  CHECK(check::matchesGolden(stretched.pam(), "WaveformStretched.pam"));
+}
@@ -0,0 +1,358 @@
+//
+//  WaveformStoreTests.cpp
+//  Illuminated
+//
+//  Created by Alexandru Solomon on 16.10.2026.
+//
+
+#include "Check.h"
+#include "TestSignals.h"
+#include "WaveformStore.h"
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+using Bytes = std::vector<uint8_t>;
+
+namespace {
+
+/// A store directory under the system temp directory, removed with everything in it at the end of the test.
+class ScratchStore {
+public:
+  explicit ScratchStore(const std::string &name)
+      : _root(fs::temp_directory_path() / ("WaveformStoreTests-" + name + "-" + std::to_string(getpid()))) {
+    fs::remove_all(_root);
+    fs::create_directories(_root);
+  }
+
+  ~ScratchStore() {
+    std::error_code error;
+    fs::remove_all(_root, error);
+  }
+
+  const fs::path &root() const {
+    return _root;
+  }
+
+  std::string directory(const std::string &name = "Store") const {
+    return (_root / name).string();
+  }
+
+  /// What a crash would leave on disk right now: the files as they are, without the commit a clean close makes.
+  std::string crashCopy(const std::string &name = "Crashed") const {
+    fs::path copy = _root / name;
+    fs::remove_all(copy);
+    fs::copy(_root / "Store", copy);
+    return copy.string();
+  }
+
+private:
+  fs::path _root;
+};
+
+Bytes payload(size_t length, uint32_t seed) {
+  signals::Random random(seed);
+  Bytes bytes(length);
+  for (uint8_t &byte : bytes) {
+    byte = (uint8_t)(random.next() >> 24);
+  }
+  return bytes;
+}
+
+std::string key(int number) {
+  return "key-" + std::to_string(number);
+}
+
+/// The payload of `key(number)` in these tests, a different length for each.
+Bytes payloadFor(int number) {
+  return payload(100 + number * 37, (uint32_t)number + 1);
+}
+
+Bytes found(waveform::WaveformStore &store, const std::string &key) {
+  waveform::WaveformStore::Blob blob = store.find(key);
+  return blob ? Bytes(blob.bytes.begin(), blob.bytes.end()) : Bytes();
+}
+
+fs::path dataFile(const std::string &directory, uint64_t generation) {
+  return fs::path(directory) / ("waveforms-" + std::to_string(generation) + ".data");
+}
+
+/// Flips one byte of a file in place.
+void corrupt(const fs::path &path, uint64_t offset) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekg((std::streamoff)offset);
+  char byte = 0;
+  file.read(&byte, 1);
+  file.seekp((std::streamoff)offset);
+  byte ^= 0x5A;
+  file.write(&byte, 1);
+}
+
+} // namespace
+
+TEST(putFindAndReopen) {
+  ScratchStore scratch("reopen");
+  {
+    waveform::WaveformStore store(scratch.directory());
+    REQUIRE(store.open());
+    for (int number = 0; number < 10; number++) {
+      CHECK(store.put(key(number), payloadFor(number)));
+    }
+    CHECK(store.put(key(3), payloadFor(30)));
+    CHECK(store.contains(key(3)));
+    CHECK(!store.find("missing"));
+    CHECK(!store.put("", payloadFor(1)));
+    CHECK(!store.put(std::string(waveform::WaveformStore::kMaxKeyLength + 1, 'k'), payloadFor(1)));
+    CHECK_EQ(store.stats().entries, (size_t)10);
+  }
+
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  CHECK_EQ(store.stats().entries, (size_t)10);
+  CHECK(found(store, key(3)) == payloadFor(30));
+  CHECK(found(store, key(9)) == payloadFor(9));
+}
+
+TEST(replaysRecordsAfterTheLastCommit) {
+  ScratchStore scratch("replay");
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  for (int number = 0; number < 5; number++) {
+    store.put(key(number), payloadFor(number));
+  }
+  REQUIRE(store.flush());
+  for (int number = 5; number < 8; number++) {
+    store.put(key(number), payloadFor(number));
+  }
+  store.put(key(0), payloadFor(20));
+
+  waveform::WaveformStore crashed(scratch.crashCopy());
+  REQUIRE(crashed.open());
+  CHECK_EQ(crashed.stats().entries, (size_t)8);
+  CHECK(found(crashed, key(0)) == payloadFor(20));
+  CHECK(found(crashed, key(7)) == payloadFor(7));
+  CHECK_EQ(crashed.stats().liveBytes, store.stats().liveBytes);
+}
+
+TEST(dropsATornTail) {
+  ScratchStore scratch("torn");
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  store.put(key(0), payloadFor(0));
+  REQUIRE(store.flush());
+  store.put(key(1), payloadFor(1));
+  uint64_t completeLength = fs::file_size(dataFile(scratch.directory(), 1));
+  store.put(key(2), payloadFor(2));
+
+  // The last record lost its end, as if the write was cut short
+  std::string directory = scratch.crashCopy();
+  fs::resize_file(dataFile(directory, 1), fs::file_size(dataFile(directory, 1)) - 20);
+  {
+    waveform::WaveformStore crashed(directory);
+    REQUIRE(crashed.open());
+    CHECK(found(crashed, key(1)) == payloadFor(1));
+    CHECK(!crashed.contains(key(2)));
+    CHECK_EQ(fs::file_size(dataFile(directory, 1)), completeLength);
+
+    // Writing goes on from the last complete record
+    CHECK(crashed.put(key(3), payloadFor(3)));
+  }
+
+  waveform::WaveformStore reopened(directory);
+  REQUIRE(reopened.open());
+  CHECK(found(reopened, key(3)) == payloadFor(3));
+  CHECK(!reopened.contains(key(2)));
+
+  // Garbage past the last record goes too
+  directory = scratch.crashCopy("Garbage");
+  std::ofstream(dataFile(directory, 1), std::ios::binary | std::ios::app) << "IWFR partial header";
+  waveform::WaveformStore garbage(directory);
+  REQUIRE(garbage.open());
+  CHECK(found(garbage, key(2)) == payloadFor(2));
+}
+
+TEST(rejectsRecordsFailingTheirChecksum) {
+  ScratchStore scratch("checksum");
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  store.put(key(0), payloadFor(0));
+  REQUIRE(store.flush());
+  uint64_t damagedRecord = fs::file_size(dataFile(scratch.directory(), 1));
+  store.put(key(1), payloadFor(1));
+  store.put(key(2), payloadFor(2));
+
+  // A flipped payload byte in the first uncommitted record ends the replay there
+  std::string directory = scratch.crashCopy();
+  corrupt(dataFile(directory, 1), damagedRecord + 40);
+  waveform::WaveformStore crashed(directory);
+  REQUIRE(crashed.open());
+  CHECK(found(crashed, key(0)) == payloadFor(0));
+  CHECK(!crashed.contains(key(1)));
+  CHECK(!crashed.contains(key(2)));
+  CHECK_EQ(fs::file_size(dataFile(directory, 1)), damagedRecord);
+}
+
+TEST(removedKeysStayRemoved) {
+  ScratchStore scratch("tombstones");
+  {
+    waveform::WaveformStore store(scratch.directory());
+    REQUIRE(store.open());
+    store.put(key(0), payloadFor(0));
+    store.put(key(1), payloadFor(1));
+    REQUIRE(store.flush());
+    CHECK(store.remove(key(0)));
+    CHECK(!store.remove(key(0)));
+    CHECK(!store.contains(key(0)));
+
+    // The tombstone is all a crash leaves of the removal
+    waveform::WaveformStore crashed(scratch.crashCopy());
+    REQUIRE(crashed.open());
+    CHECK(!crashed.contains(key(0)));
+    CHECK(found(crashed, key(1)) == payloadFor(1));
+
+    // A key put again after its removal comes back
+    store.put(key(1), payloadFor(10));
+    store.remove(key(1));
+    store.put(key(1), payloadFor(11));
+  }
+
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  CHECK(!store.contains(key(0)));
+  CHECK(found(store, key(1)) == payloadFor(11));
+  CHECK_EQ(store.stats().entries, (size_t)1);
+}
+
+TEST(compactionSwitchesGenerations) {
+  ScratchStore scratch("compact");
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  for (int number = 0; number < 20; number++) {
+    store.put(key(number), payloadFor(number));
+  }
+  for (int number = 0; number < 20; number += 2) {
+    store.remove(key(number));
+  }
+  store.flush();
+
+  // Not enough dead bytes for the default threshold
+  CHECK(!store.compactIfNeeded());
+  REQUIRE(store.compactIfNeeded(0.4, 1));
+  CHECK_EQ(store.stats().dataBytes, store.stats().liveBytes);
+  CHECK(!fs::exists(dataFile(scratch.directory(), 1)));
+  CHECK(fs::exists(dataFile(scratch.directory(), 2)));
+  CHECK(found(store, key(5)) == payloadFor(5));
+  CHECK(!store.contains(key(4)));
+
+  // Until the new index is renamed into place, the old generation is the store
+  std::string beforeSwitch = scratch.crashCopy();
+  store.put(key(30), payloadFor(30));
+  fs::copy_file(dataFile(scratch.directory(), 2), dataFile(beforeSwitch, 3));
+  std::ofstream(fs::path(beforeSwitch) / "waveforms.index.tmp") << "half written";
+  {
+    waveform::WaveformStore crashed(beforeSwitch);
+    REQUIRE(crashed.open());
+    CHECK(found(crashed, key(19)) == payloadFor(19));
+    CHECK(!fs::exists(dataFile(beforeSwitch, 3)));
+    CHECK(!fs::exists(fs::path(beforeSwitch) / "waveforms.index.tmp"));
+  }
+
+  // Writes after compaction land in the new generation and survive a crash
+  waveform::WaveformStore crashed(scratch.crashCopy("AfterSwitch"));
+  REQUIRE(crashed.open());
+  CHECK(found(crashed, key(30)) == payloadFor(30));
+  CHECK_EQ(crashed.stats().entries, (size_t)11);
+}
+
+TEST(failedCompactionRollsBack) {
+  ScratchStore scratch("rollback");
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  for (int number = 0; number < 6; number++) {
+    store.put(key(number), payloadFor(number));
+  }
+  store.remove(key(0));
+  waveform::WaveformStore::Stats before = store.stats();
+
+  // Directories where compaction writes its files make it fail, first on the data file, then on the index
+  for (const char *blocked : {"waveforms-2.data", "waveforms.index.tmp"}) {
+    fs::create_directory(fs::path(scratch.directory()) / blocked);
+    CHECK(!store.compact());
+    fs::remove(fs::path(scratch.directory()) / blocked);
+
+    CHECK_EQ(store.stats().dataBytes, before.dataBytes);
+    CHECK(found(store, key(3)) == payloadFor(3));
+    CHECK(!fs::exists(dataFile(scratch.directory(), 2)));
+    CHECK(fs::exists(dataFile(scratch.directory(), 1)));
+  }
+
+  // The store carries on in the old generation and can still compact later
+  CHECK(store.put(key(10), payloadFor(10)));
+  CHECK(store.flush());
+  REQUIRE(store.compact());
+  CHECK(found(store, key(10)) == payloadFor(10));
+  CHECK_EQ(store.stats().entries, (size_t)6);
+}
+
+TEST(blobsOutliveCompactionAndTheStore) {
+  ScratchStore scratch("blobs");
+  waveform::WaveformStore::Blob blob;
+  {
+    waveform::WaveformStore store(scratch.directory());
+    REQUIRE(store.open());
+    store.put(key(0), payloadFor(0));
+    store.put(key(1), payloadFor(1));
+    blob = store.find(key(1));
+    REQUIRE(blob);
+
+    store.remove(key(1));
+    store.put(key(2), payloadFor(2));
+    REQUIRE(store.compact());
+    CHECK(Bytes(blob.bytes.begin(), blob.bytes.end()) == payloadFor(1));
+    CHECK(found(store, key(2)) == payloadFor(2));
+  }
+  CHECK(Bytes(blob.bytes.begin(), blob.bytes.end()) == payloadFor(1));
+}
+
+TEST(writesCarryOnDuringCompaction) {
+  ScratchStore scratch("concurrent");
+  waveform::WaveformStore store(scratch.directory());
+  REQUIRE(store.open());
+  for (int number = 0; number < 400; number++) {
+    store.put(key(number), payload(4096, (uint32_t)number));
+  }
+  for (int number = 0; number < 400; number += 2) {
+    store.remove(key(number));
+  }
+
+  // Whichever way the writes fall around the copy, none of them may be lost
+  bool compacted = false;
+  std::thread compaction([&] { compacted = store.compact(); });
+  for (int number = 0; number < 100; number++) {
+    store.put(key(1000 + number), payloadFor(number));
+    store.remove(key(number * 2 + 1));
+    store.put(key(number * 4), payloadFor(number));
+    CHECK(found(store, key(number * 2 + 101)) == payload(4096, (uint32_t)(number * 2 + 101)));
+  }
+  compaction.join();
+  CHECK(compacted);
+
+  auto verify = [](waveform::WaveformStore &store) {
+    for (int number = 0; number < 100; number++) {
+      CHECK(found(store, key(1000 + number)) == payloadFor(number));
+      CHECK(found(store, key(number * 4)) == payloadFor(number));
+      CHECK(!store.contains(key(number * 2 + 1)));
+    }
+    CHECK(found(store, key(399)) == payload(4096, 399));
+    CHECK_EQ(store.stats().entries, (size_t)(100 + 100 + 100));
+  };
+  verify(store);
+
+  waveform::WaveformStore crashed(scratch.crashCopy());
+  REQUIRE(crashed.open());
+  verify(crashed);
+}